@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vjc {
+class FdBackend;
+class VirtualJoystick;
+} // namespace vjc
+
+namespace vjc::bench {
+
+/// Options shared by every suite.
+struct Options {
+    std::uint64_t duration_ms = 500; ///< run time of one configuration
+    bool quick = false;              ///< smaller matrices for smoke runs
+};
+
+/// Latency distribution in nanoseconds.
+struct Percentiles {
+    std::uint64_t p50 = 0;
+    std::uint64_t p99 = 0;
+    std::uint64_t p999 = 0;
+    std::uint64_t max = 0;
+    std::size_t count = 0;
+};
+
+/// Sorts `samples` in place and extracts the reported percentiles.
+Percentiles percentiles(std::vector<std::uint64_t>& samples);
+
+/// One machine-readable result line: a flat JSON object per line.
+class Record {
+public:
+    Record(const char* suite, const char* name);
+
+    Record& field(const char* key, std::int64_t value);
+    Record& field(const char* key, std::uint64_t value);
+    Record& field(const char* key, int value) { return field(key, static_cast<std::int64_t>(value)); }
+    Record& field(const char* key, unsigned value) { return field(key, static_cast<std::uint64_t>(value)); }
+    Record& field(const char* key, double value);
+    Record& field(const char* key, const char* value);
+    Record& latency(const Percentiles& p); ///< adds p50_ns, p99_ns, p999_ns, max_ns
+
+    [[nodiscard]] std::string json() const;
+    [[nodiscard]] const std::vector<std::pair<std::string, std::string>>& fields() const { return fields_; }
+
+private:
+    std::vector<std::pair<std::string, std::string>> fields_;
+};
+
+/// Collects records, echoes them to stdout and writes them to the output file.
+class Reporter {
+public:
+    explicit Reporter(const std::string& path);
+    ~Reporter();
+
+    Reporter(const Reporter&) = delete;
+    Reporter& operator=(const Reporter&) = delete;
+
+    void add(const Record& record);
+
+private:
+    std::FILE* out_;
+};
+
+using SuiteFn = void (*)(const Options&, Reporter&);
+
+struct Suite {
+    const char* name;
+    const char* description;
+    SuiteFn run;
+};
+
+/// Registers a suite at static-initialisation time; see VJC_BENCH_SUITE.
+struct SuiteRegistrar {
+    SuiteRegistrar(const char* name, const char* description, SuiteFn run);
+};
+
+std::vector<Suite>& suites();
+
+/// A backend writing to /dev/null, so every frame still costs its write()
+/// but no /dev/uinput is needed. Throws std::system_error.
+std::unique_ptr<FdBackend> null_backend();
+
+/// A gamepad on null_backend().
+std::unique_ptr<VirtualJoystick> null_device();
+
+/// Keeps the optimiser from discarding a computed value.
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace vjc::bench
+
+#define VJC_BENCH_SUITE(id, description)                                                       \
+    static void vjc_bench_##id(const ::vjc::bench::Options&, ::vjc::bench::Reporter&);         \
+    static const ::vjc::bench::SuiteRegistrar vjc_bench_registrar_##id{#id, description,       \
+                                                                       &vjc_bench_##id};       \
+    static void vjc_bench_##id(const ::vjc::bench::Options& options, ::vjc::bench::Reporter& reporter)
@@ -0,0 +1,167 @@
+// Steady-state heap use: a warmed-up pipeline with every hot-path feature on
+// (UDP and shared-memory input, a mapping profile with a macro, curves,
+// adaptive pacing, turbo and sequences) runs under an AllocationGuard, and
+// the suite fails if anything calls operator new. Also the cost of a pool
+// acquire/release and an arena carve against new/delete.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/alloc_guard.hpp"
+#include "vjc/arena.hpp"
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/object_pool.hpp"
+#include "vjc/profile_store.hpp"
+#include "vjc/shm_client.hpp"
+#include "vjc/shm_server.hpp"
+#include "vjc/udp_client.hpp"
+#include "vjc/udp_server.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+constexpr std::size_t kDevices = 4; // 0-1 over UDP, 2-3 over shared memory
+constexpr std::uint64_t kPeriod = 250'000;
+
+constexpr const char* kProfile = "b0+b1 -> b10\n"
+                                 "b2 -> macro b3:2 -:1 b4:2\n"
+                                 "toggle b5 -> b12\n"
+                                 "a2 a3 -> hat1 deadzone 8000\n"
+                                 "curve a0 expo50\n"
+                                 "curve a1 gamma 1.8\n";
+
+struct CountingObserver final : FrameObserver {
+    std::atomic<std::uint64_t> frames{0};
+
+    void on_frame(unsigned, std::size_t, const JoystickState&, std::size_t) noexcept override
+    {
+        frames.store(frames.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+template <typename F>
+double ns_per_op(std::size_t ops, F f)
+{
+    const std::uint64_t t0 = monotonic_ns();
+    for (std::size_t i = 0; i < ops; ++i)
+        f(i);
+    return static_cast<double>(monotonic_ns() - t0) / static_cast<double>(ops);
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(alloc, "heap allocations of a warmed-up pipeline, pool and arena cost")
+{
+    {
+        ManagerConfig config;
+        config.schedule.policy = SchedulePolicy::Adaptive;
+        config.schedule.period_ns = 500'000;
+        config.sequence_capacity = 64;
+        ControllerManager manager(config);
+        for (std::size_t d = 0; d < kDevices; ++d)
+            manager.add_device(bench::null_device());
+        ProfileStore profiles(kDevices, manager.writer_count());
+        profiles.load(kProfile);
+        for (std::size_t d = 0; d < kDevices; ++d)
+            manager.attach_profile(d, &profiles);
+        const std::uint32_t combo = manager.add_sequence({{{1u << 6, 2'000'000}, {0, 1'000'000}, {1u << 7, 2'000'000}}});
+        CountingObserver observer;
+        manager.set_observer(&observer);
+
+        UdpServerConfig udp_config;
+        udp_config.address = "127.0.0.1";
+        UdpServer udp(manager, udp_config);
+        UdpClient udp_client("127.0.0.1", udp.port());
+        ShmServer shm(manager);
+        ShmClient shm_client(shm.fd());
+        manager.start();
+        udp.start();
+        shm.start();
+
+        const bench::SyntheticInput input;
+        JoystickState state;
+        std::uint64_t frame = 0;
+        std::uint64_t deadline = monotonic_ns();
+        const auto run = [&](std::uint64_t duration_ns) {
+            const std::uint64_t end = deadline + duration_ns;
+            while (deadline < end) {
+                deadline += kPeriod;
+                sleep_until_ns(deadline);
+                input.fill(frame, state);
+                state.timestamp_ns = monotonic_ns();
+                for (std::uint16_t d = 0; d < kDevices; ++d)
+                    d < 2 ? udp_client.send(d, state) : shm_client.send(d, state);
+                if (frame % 400 == 0)
+                    manager.turbo(frame / 400 % kDevices, 1u << 8, frame % 800 ? 0 : 20'000'000);
+                if (frame % 300 == 0)
+                    manager.play(frame / 300 % kDevices, combo);
+                ++frame;
+            }
+        };
+
+        // Warm-up touches every path once: thread-local stats, first
+        // turbo and sequence, the scheduler and the macro state.
+        run(200'000'000);
+        const std::uint64_t frames_before = observer.frames.load(std::memory_order_relaxed);
+        {
+            AllocationGuard guard;
+            run(options.duration_ms * 1'000'000);
+            guard.check("alloc");
+        }
+        const std::uint64_t frames = observer.frames.load(std::memory_order_relaxed) - frames_before;
+        shm.stop();
+        udp.stop();
+        manager.stop();
+
+        if (frames == 0)
+            throw std::runtime_error("alloc: no frames emitted");
+        reporter.add(bench::Record("alloc", "steady_state")
+                         .field("frames", frames)
+                         .field("udp_packets", udp.stats().packets)
+                         .field("shm_updates", shm.stats().updates));
+    }
+
+    const std::size_t ops = options.quick ? 1'000'000 : 10'000'000;
+    {
+        struct Packet {
+            std::byte data[128];
+        };
+        ObjectPool<Packet> pool(64);
+        std::vector<std::uint32_t> held(8);
+        const double pooled = ns_per_op(ops, [&](std::size_t i) {
+            std::uint32_t& slot = held[i & 7];
+            if (i >= 8)
+                pool.release(slot);
+            slot = pool.acquire();
+            bench::do_not_optimize(pool[slot]);
+        });
+        std::vector<Packet*> heap(8, nullptr);
+        const double allocated = ns_per_op(ops, [&](std::size_t i) {
+            Packet*& p = heap[i & 7];
+            delete p;
+            p = new Packet;
+            bench::do_not_optimize(*p);
+        });
+        for (Packet* p : heap)
+            delete p;
+        reporter.add(bench::Record("alloc", "pool_vs_new")
+                         .field("pool_ns", pooled)
+                         .field("new_delete_ns", allocated));
+    }
+    {
+        Arena arena(64 * 1024);
+        const double carved = ns_per_op(ops, [&](std::size_t i) {
+            if ((i & 63) == 0)
+                arena.reset();
+            bench::do_not_optimize(arena.allocate(32 + (i & 7) * 64, 16));
+        });
+        reporter.add(bench::Record("alloc", "arena").field("ns_per_allocate", carved));
+    }
+}
@@ -0,0 +1,84 @@
+// Cost of the fused axis shaping kernel per tier and device count, and a
+// check that every tier matches the scalar reference bit for bit.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/axis_processor.hpp"
+#include "vjc/clock.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+void configure(AxisProcessor& processor)
+{
+    for (std::size_t d = 0; d < processor.devices(); ++d) {
+        for (std::size_t s = 0; s < AxisProcessor::kSticks; ++s) {
+            StickCurve curve;
+            curve.radial_deadzone = 0.05f + 0.01f * static_cast<float>(d % 8);
+            curve.x = {0.02f, 0.3f, 1.1f, false};
+            curve.y = {0.02f, 0.6f, 1.0f, (d & 1) != 0};
+            processor.configure(d, s, curve);
+        }
+    }
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(axes, "fused deadzone/curve/inversion/clamp kernel per SIMD tier")
+{
+    const std::vector<std::size_t> device_counts = options.quick ? std::vector<std::size_t>{16, 256}
+                                                                 : std::vector<std::size_t>{1, 16, 64, 256};
+    const std::size_t iterations = options.quick ? 2'000 : 20'000;
+
+    for (std::size_t devices : device_counts) {
+        std::vector<JoystickState> input(devices);
+        for (std::size_t d = 0; d < devices; ++d) {
+            bench::SyntheticInput(static_cast<unsigned>(d)).fill(d * 13, input[d]);
+            input[d].axes[4] = static_cast<std::int16_t>(-input[d].axes[0]);
+            input[d].axes[7] = -32768;
+        }
+
+        std::vector<JoystickState> reference = input;
+        AxisProcessor scalar(devices, SimdLevel::Scalar);
+        configure(scalar);
+        scalar.process(reference.data(), devices);
+
+        double scalar_ns = 0;
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2}) {
+            AxisProcessor processor(devices, level);
+            if (processor.level() != level)
+                continue;
+            configure(processor);
+
+            std::vector<JoystickState> out = input;
+            processor.process(out.data(), devices);
+            if (out != reference)
+                throw std::runtime_error(std::string("axes: ") + to_string(level) + " differs from scalar");
+
+            for (std::size_t d = 0; d < devices; ++d)
+                processor.load(d, input[d]);
+            const std::uint64_t t0 = monotonic_ns();
+            for (std::size_t i = 0; i < iterations; ++i)
+                processor.run();
+            const std::uint64_t t1 = monotonic_ns();
+
+            const double axes = static_cast<double>(devices * kMaxAxes);
+            const double ns_per_axis = static_cast<double>(t1 - t0) / static_cast<double>(iterations) / axes;
+            if (level == SimdLevel::Scalar)
+                scalar_ns = ns_per_axis;
+            const std::string name = std::string(to_string(level)) + "_x" + std::to_string(devices);
+            reporter.add(bench::Record("axes", name.c_str())
+                             .field("simd", to_string(level))
+                             .field("devices", static_cast<std::uint64_t>(devices))
+                             .field("ns_per_axis", ns_per_axis)
+                             .field("ns_per_frame", ns_per_axis * axes)
+                             .field("speedup_vs_scalar", scalar_ns > 0 ? scalar_ns / ns_per_axis : 1.0));
+        }
+    }
+}
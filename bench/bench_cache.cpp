@@ -0,0 +1,188 @@
+// Profile cache: parse-and-compile time of a large profile against loading
+// the same profile from its cache file, and cold start to the first emitted
+// event through ProfileStore and ControllerManager with and without the
+// cache. Fails if the cached profile maps any frame differently from the
+// parsed one, or if an edited source or a damaged file is not rejected.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/profile_cache.hpp"
+#include "vjc/profile_store.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+template <typename... Parts>
+void append(std::string& text, const Parts&... parts)
+{
+    (text += ... += parts);
+}
+
+/// Several hundred rules of every kind and a custom curve on each stick axis.
+std::string make_profile()
+{
+    using std::to_string;
+    std::string text = "# generated\n";
+    for (unsigned i = 0; i < 64; ++i)
+        append(text, "b", to_string(i), " -> b", to_string((i * 7 + 3) % 64), "\n");
+    for (unsigned i = 0; i < 300; ++i)
+        append(text, "b", to_string(i % 64), "+b", to_string((i * 13 + 1) % 64), " -> b", to_string(i * 5 % 64), " b",
+               to_string(i * 11 % 64), "\n");
+    for (unsigned i = 0; i < 40; ++i)
+        append(text, "b", to_string(i), "+b", to_string(63 - i), " -> macro b", to_string(i), ":2 -:1 b",
+               to_string(i + 1), "+b", to_string(i + 2), ":3\n");
+    text += "toggle b40 -> b41\nturbo b42 -> b43 every 3\n";
+    for (unsigned a = 0; a < 4; ++a) {
+        append(text, "a", to_string(a), " -> b", to_string(44 + a), " when > ", to_string(8000 + a * 3000), "\n");
+        append(text, "a", to_string(a), " -> b", to_string(48 + a), " when < -", to_string(9000 + a * 2000), "\n");
+    }
+    text += "a4 a5 -> hat1 deadzone 6000\na6 -> a7 invert\n";
+    for (unsigned a = 0; a < 4; ++a)
+        append(text, "curve a", to_string(a), " gamma 1.", to_string(2 + 3 * a), "\n");
+    text += "curve a4 expo50\ncurve a5 cubic\n";
+    return text;
+}
+
+struct FirstFrame final : FrameObserver {
+    std::atomic<std::uint64_t> at{0};
+
+    void on_frame(unsigned, std::size_t, const JoystickState&, std::size_t) noexcept override
+    {
+        if (at.load(std::memory_order_relaxed) == 0)
+            at.store(monotonic_ns(), std::memory_order_release);
+    }
+};
+
+/// ns from nothing to the first event written: store, profile, manager,
+/// device and one state.
+std::uint64_t cold_start(const std::string& text, ProfileCache* cache)
+{
+    const std::uint64_t t0 = monotonic_ns();
+    ProfileStore profiles(1, 1);
+    if (cache)
+        profiles.load(text, *cache);
+    else
+        profiles.load(text);
+    ControllerManager manager;
+    manager.add_device(bench::null_device());
+    manager.attach_profile(0, &profiles);
+    FirstFrame observer;
+    manager.set_observer(&observer);
+    manager.start();
+    JoystickState state;
+    state.triggers[0] = 12000;
+    manager.publish(0, state);
+    while (observer.at.load(std::memory_order_acquire) == 0)
+        sleep_until_ns(monotonic_ns() + 20'000);
+    const std::uint64_t elapsed = observer.at.load(std::memory_order_relaxed) - t0;
+    manager.stop();
+    return elapsed;
+}
+
+std::uint64_t median(std::vector<std::uint64_t> v)
+{
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(cache, "profile cache load vs parse, cold start to first event, invalidation")
+{
+    const std::string path
+        = (std::filesystem::temp_directory_path() / ("vjc_bench_" + std::to_string(::getpid()) + ".cache")).string();
+    const std::string text = make_profile();
+    const unsigned reps = options.quick ? 5 : 21;
+    const std::vector<DeviceDescriptor> descriptors{DeviceDescriptor::gamepad(), DeviceDescriptor::rumble_gamepad(),
+                                                    DeviceDescriptor::motion_sensor()};
+    ProfileCache cache(path);
+
+    std::vector<std::uint64_t> parse_ns, store_ns, load_ns;
+    for (unsigned i = 0; i < reps; ++i) {
+        std::uint64_t t0 = monotonic_ns();
+        const Profile parsed = Profile::parse(text, 1, 1);
+        parse_ns.push_back(monotonic_ns() - t0);
+        t0 = monotonic_ns();
+        cache.store(text, parsed, descriptors);
+        store_ns.push_back(monotonic_ns() - t0);
+        t0 = monotonic_ns();
+        std::vector<DeviceDescriptor> loaded_descriptors;
+        const std::unique_ptr<Profile> loaded = cache.load(text, 1, 1, &loaded_descriptors);
+        load_ns.push_back(monotonic_ns() - t0);
+        if (!loaded)
+            throw std::runtime_error(std::string("cache: fresh cache rejected as ") + to_string(cache.status()));
+
+        if (i == 0) {
+            if (loaded_descriptors.size() != descriptors.size() || loaded_descriptors[1].name != descriptors[1].name
+                || loaded_descriptors[1].buttons != descriptors[1].buttons
+                || loaded_descriptors[1].ff_features != descriptors[1].ff_features
+                || loaded_descriptors[1].ff_effects != descriptors[1].ff_effects
+                || loaded_descriptors[2].properties != descriptors[2].properties
+                || loaded_descriptors[2].misc != descriptors[2].misc
+                || loaded_descriptors[2].axes[3].resolution != descriptors[2].axes[3].resolution)
+                throw std::runtime_error("cache: descriptors did not round-trip");
+            const bench::SyntheticInput input;
+            JoystickState in, a, b;
+            for (std::uint64_t f = 0; f < 100'000; ++f) {
+                input.fill(f, in);
+                in.buttons |= (f * 0x9e3779b97f4a7c15ull) >> 20;
+                in.axes[4] = static_cast<std::int16_t>(f * 37);
+                parsed.apply(0, in, a);
+                loaded->apply(0, in, b);
+                if (std::memcmp(&a, &b, sizeof a) != 0)
+                    throw std::runtime_error("cache: frame " + std::to_string(f) + " differs from the parsed profile");
+            }
+        }
+    }
+    const std::uint64_t file_bytes = std::filesystem::file_size(path);
+    reporter.add(bench::Record("cache", "load")
+                     .field("rules", static_cast<std::uint64_t>(Profile::parse(text, 1, 1).mapping.rule_count()))
+                     .field("file_bytes", file_bytes)
+                     .field("parse_us", static_cast<double>(median(parse_ns)) / 1e3)
+                     .field("store_us", static_cast<double>(median(store_ns)) / 1e3)
+                     .field("load_us", static_cast<double>(median(load_ns)) / 1e3));
+
+    std::vector<std::uint64_t> cold_parse, cold_cached;
+    for (unsigned i = 0; i < reps; ++i) {
+        cold_parse.push_back(cold_start(text, nullptr));
+        cold_cached.push_back(cold_start(text, &cache));
+        if (cache.status() != ProfileCache::Status::Hit)
+            throw std::runtime_error(std::string("cache: cold start missed the cache: ") + to_string(cache.status()));
+    }
+    reporter.add(bench::Record("cache", "first_event")
+                     .field("parse_ms", static_cast<double>(median(cold_parse)) / 1e6)
+                     .field("cached_ms", static_cast<double>(median(cold_cached)) / 1e6));
+
+    // An edited profile must miss, and so must any damaged byte.
+    if (cache.load(text + "b0 -> b1\n", 1, 1) || cache.status() != ProfileCache::Status::Stale)
+        throw std::runtime_error("cache: edited source was not detected");
+    {
+        const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        char byte = 0;
+        const off_t at = static_cast<off_t>(file_bytes / 2);
+        if (fd < 0 || ::pread(fd, &byte, 1, at) != 1)
+            throw std::system_error(errno, std::system_category(), "open " + path);
+        byte = static_cast<char>(byte ^ 0x10);
+        const bool written = ::pwrite(fd, &byte, 1, at) == 1;
+        ::close(fd);
+        if (!written || cache.load(text, 1, 1) || cache.status() != ProfileCache::Status::Corrupt)
+            throw std::runtime_error("cache: damaged file was not detected");
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,119 @@
+// Accuracy of baked response curves against their analytic definition and
+// the per-sample speedup of a table load over evaluating the curve.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/response_curve.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+struct Case {
+    const char* name;
+    ResponseCurve curve;
+    std::function<double(double)> analytic;
+};
+
+/// Reference Bezier evaluation by bisection, independent of the baking code.
+double bezier_reference(double x, double x1, double y1, double x2, double y2)
+{
+    const auto coord = [](double t, double p1, double p2) {
+        const double u = 1.0 - t;
+        return 3.0 * u * u * t * p1 + 3.0 * u * t * t * p2 + t * t * t;
+    };
+    double lo = 0.0;
+    double hi = 1.0;
+    for (int i = 0; i < 60; ++i) {
+        const double t = 0.5 * (lo + hi);
+        (coord(t, x1, x2) < x ? lo : hi) = t;
+    }
+    return std::clamp(coord(0.5 * (lo + hi), y1, y2), 0.0, 1.0);
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(curves, "lookup-table response curves: accuracy and speedup")
+{
+    const CurvePoint points[] = {{0.2f, 0.05f}, {0.6f, 0.4f}, {0.9f, 0.95f}};
+    std::vector<Case> cases;
+    cases.push_back({"preset_gamma15", ResponseCurve::preset(CurvePreset::Gamma15),
+                     [](double x) { return std::pow(x, 1.5); }});
+    cases.push_back({"preset_cubic", ResponseCurve::preset(CurvePreset::Cubic),
+                     [](double x) { return x * x * x; }});
+    cases.push_back({"preset_expo50", ResponseCurve::preset(CurvePreset::Expo50),
+                     [](double x) { return 0.5 * x + 0.5 * x * x * x; }});
+    cases.push_back({"gamma_2.2", ResponseCurve::gamma(2.2f), [](double x) { return std::pow(x, 2.2); }});
+    cases.push_back({"bezier", ResponseCurve::bezier(0.6f, 0.0f, 0.8f, 1.0f),
+                     [](double x) { return bezier_reference(x, 0.6f, 0.0f, 0.8f, 1.0f); }});
+    cases.push_back({"piecewise", ResponseCurve::piecewise_linear(points), [&points](double x) {
+                         double px = 0, py = 0;
+                         for (const auto& p : points) {
+                             if (x <= p.x)
+                                 return py + (x - px) / (p.x - px) * (p.y - py);
+                             px = p.x;
+                             py = p.y;
+                         }
+                         return py + (x - px) / (1.0 - px) * (1.0 - py);
+                     }});
+
+    std::vector<std::int16_t> samples(4096);
+    bench::SyntheticInput input;
+    JoystickState s;
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        input.fill(i * 7, s);
+        samples[i] = s.axes[i % 4];
+    }
+    const std::size_t rounds = options.quick ? 50 : 500;
+
+    // Odd symmetry puts the centre at 0, even for a curve with f(0) != 0.
+    if (ResponseCurve::from_function([](double x) { return 0.2 + 0.8 * x; }).apply(0) != 0)
+        throw std::runtime_error("curves: a centred stick does not map to 0");
+
+    for (const Case& c : cases) {
+        double max_error = 0;
+        for (std::int32_t v = -32767; v <= 32767; ++v) {
+            const double magnitude = std::fabs(static_cast<double>(v)) / 32767.0;
+            const double expected = std::copysign(c.analytic(magnitude) * 32767.0, static_cast<double>(v));
+            max_error = std::max(max_error, std::fabs(c.curve.apply(static_cast<std::int16_t>(v)) - expected));
+        }
+        if (max_error > 1.0)
+            throw std::runtime_error(std::string("curves: ") + c.name + " deviates from its analytic curve");
+
+        std::vector<std::int16_t> buf = samples;
+        const std::uint64_t t0 = monotonic_ns();
+        for (std::size_t r = 0; r < rounds; ++r) {
+            for (auto& v : buf) {
+                const double x = static_cast<double>(v) / 32767.0;
+                v = static_cast<std::int16_t>(std::copysign(c.analytic(std::fabs(x)), x) * 32767.0);
+            }
+            bench::do_not_optimize(buf.data());
+            buf = samples;
+        }
+        const std::uint64_t t1 = monotonic_ns();
+        for (std::size_t r = 0; r < rounds; ++r) {
+            c.curve.apply(buf.data(), buf.size());
+            bench::do_not_optimize(buf.data());
+            buf = samples;
+        }
+        const std::uint64_t t2 = monotonic_ns();
+
+        const double n = static_cast<double>(rounds * samples.size());
+        const double analytic_ns = static_cast<double>(t1 - t0) / n;
+        const double lut_ns = static_cast<double>(t2 - t1) / n;
+        reporter.add(bench::Record("curves", c.name)
+                         .field("max_error_lsb", max_error)
+                         .field("analytic_ns_per_sample", analytic_ns)
+                         .field("lut_ns_per_sample", lut_ns)
+                         .field("speedup", analytic_ns / lut_ns));
+    }
+}
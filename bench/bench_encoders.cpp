@@ -0,0 +1,112 @@
+// Encode cost per frame of the compile-time specialized encoder against the
+// descriptor-driven EventEncoder, for each built-in layout, on frames where
+// a few sticks move and buttons toggle now and then. Fails if the two ever
+// emit different events.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/device_layout.hpp"
+#include "vjc/static_encoder.hpp"
+
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+constexpr std::size_t kFrames = 4096;
+
+std::vector<JoystickState> make_frames()
+{
+    std::vector<JoystickState> frames(kFrames);
+    for (std::size_t f = 0; f < kFrames; ++f) {
+        bench::SyntheticInput(7).fill(f, frames[f]);
+        // Sticks 4-6 move every other frame; buttons beyond the first 11
+        // toggle now and then.
+        for (std::size_t a = 4; a < 7; ++a)
+            frames[f].axes[a] = static_cast<std::int16_t>((f / 2) * (a * 977));
+        frames[f].buttons |= ((f * 0x9e3779b97f4a7c15ull) >> 60 == 0) ? (std::uint64_t{1} << (11 + f % 21)) : 0;
+    }
+    return frames;
+}
+
+template <typename Encode>
+double time_encoder(const std::vector<JoystickState>& frames, std::size_t iterations, Encode encode)
+{
+    EventBuffer buffer{};
+    std::size_t events = 0;
+    const std::uint64_t t0 = monotonic_ns();
+    for (std::size_t i = 0; i < iterations; ++i)
+        for (std::size_t f = 1; f < frames.size(); ++f)
+            events += encode(frames[f - 1], frames[f], buffer.data());
+    const std::uint64_t t1 = monotonic_ns();
+    if (events == 0)
+        throw std::runtime_error("encoders: nothing encoded");
+    return static_cast<double>(t1 - t0) / static_cast<double>(iterations * (frames.size() - 1));
+}
+
+template <const auto& Layout>
+void run_layout(const char* name, const std::vector<JoystickState>& frames, const bench::Options& options,
+                bench::Reporter& reporter)
+{
+    using Static = StaticEncoder<Layout>;
+    const EventEncoder generic(Layout.descriptor());
+
+    EventBuffer a{}, b{};
+    std::size_t events = 0;
+    std::size_t diff_events = 0;
+    for (std::size_t f = 0; f < frames.size(); ++f) {
+        const std::size_t n = f == 0 ? generic.encode_full(frames[0], a.data())
+                                     : generic.encode(frames[f - 1], frames[f], a.data());
+        const std::size_t m = f == 0 ? Static::encode_full(frames[0], b.data())
+                                     : Static::encode(frames[f - 1], frames[f], b.data());
+        if (n != m || std::memcmp(a.data(), b.data(), n * sizeof(input_event)) != 0)
+            throw std::runtime_error(std::string("encoders: ") + name + " differs from EventEncoder at frame "
+                                     + std::to_string(f));
+        events += n;
+        diff_events += f == 0 ? 0 : n;
+    }
+
+    // The same frames through a VirtualJoystick built on the specialized path.
+    const std::unique_ptr<VirtualJoystick> joystick = make_joystick<Layout>(bench::null_backend());
+    const bool first = joystick->submit(frames[0]) == generic.encode(JoystickState{}, frames[0], a.data());
+    std::size_t written = 0;
+    for (std::size_t f = 1; f < frames.size(); ++f)
+        written += joystick->submit(frames[f]);
+    if (!first || written != diff_events || joystick->stats().failed_frames != 0)
+        throw std::runtime_error(std::string("encoders: ") + name + " joystick wrote a different stream");
+
+    const std::size_t iterations = options.quick ? 50 : 500;
+    const double generic_ns = time_encoder(frames, iterations, [&](const auto& prev, const auto& next, auto* out) {
+        return generic.encode(prev, next, out);
+    });
+    const double static_ns = time_encoder(frames, iterations, [](const auto& prev, const auto& next, auto* out) {
+        return Static::encode(prev, next, out);
+    });
+    reporter.add(bench::Record("encoders", name)
+                     .field("axes", static_cast<std::uint64_t>(Layout.axes.size()))
+                     .field("buttons", static_cast<std::uint64_t>(Layout.buttons.size()))
+                     .field("events_per_frame", static_cast<double>(events) / static_cast<double>(frames.size()))
+                     .field("generic_ns_per_frame", generic_ns)
+                     .field("static_ns_per_frame", static_ns)
+                     .field("speedup", generic_ns / static_ns));
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(encoders, "compile-time specialized encoder vs descriptor-driven EventEncoder per layout")
+{
+    const std::vector<JoystickState> frames = make_frames();
+    run_layout<layouts::kXboxPad>("xbox_pad", frames, options, reporter);
+    run_layout<layouts::kArcadeStick>("arcade_stick", frames, options, reporter);
+    run_layout<layouts::kFlightHotas>("flight_hotas", frames, options, reporter);
+    run_layout<layouts::kWheel>("wheel", frames, options, reporter);
+}
@@ -0,0 +1,123 @@
+// Evdev passthrough fed by a pipe standing in for a physical device: drain
+// cost per event with one event per read() versus large reads, and the
+// latency from writing a frame into the source to its device write at 1 kHz.
+
+#include "bench.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/evdev_passthrough.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+constexpr std::size_t kFrameEvents = 6; // four sticks, a button, SYN_REPORT
+
+/// Writes one frame whose ABS_X carries `id`, so the far end can match it.
+void write_frame(int fd, std::uint64_t id)
+{
+    const auto v = static_cast<std::int32_t>(id % 65536) - 32768;
+    const input_event frame[kFrameEvents] = {
+        {{}, EV_ABS, ABS_X, v},
+        {{}, EV_ABS, ABS_Y, -v},
+        {{}, EV_ABS, ABS_RX, v / 2},
+        {{}, EV_ABS, ABS_RY, -v / 2},
+        {{}, EV_KEY, BTN_SOUTH, static_cast<std::int32_t>(id & 1)},
+        {{}, EV_SYN, SYN_REPORT, 0},
+    };
+    if (::write(fd, frame, sizeof frame) != static_cast<ssize_t>(sizeof frame))
+        throw std::runtime_error("evdev: short write to fake source");
+}
+
+struct LatencyObserver final : FrameObserver {
+    const std::vector<std::uint64_t>* sent = nullptr;
+    std::vector<std::uint64_t> samples;
+
+    void on_frame(unsigned, std::size_t, const JoystickState& state, std::size_t) noexcept override
+    {
+        const std::size_t id = static_cast<std::size_t>(state.axes[0] + 32768);
+        if (id < sent->size() && samples.size() < samples.capacity())
+            samples.push_back(monotonic_ns() - (*sent)[id]);
+    }
+};
+
+} // namespace
+
+VJC_BENCH_SUITE(evdev, "evdev passthrough drain cost and source-to-device latency")
+{
+    for (unsigned read_events : {1u, 256u}) {
+        int fds[2];
+        if (::pipe2(fds, O_CLOEXEC) < 0)
+            throw std::system_error(errno, std::system_category(), "pipe2");
+        ::fcntl(fds[1], F_SETPIPE_SZ, 1 << 20);
+
+        ControllerManager manager;
+        manager.add_device(bench::null_device());
+        EvdevSource source;
+        source.fd = fds[0];
+        source.bindings = EvdevSource::gamepad_bindings();
+        std::vector<EvdevSource> sources;
+        sources.push_back(std::move(source));
+        EvdevPassthrough passthrough(manager, std::move(sources), {read_events});
+        manager.start();
+
+        // Throughput: bursts of frames queued in the pipe, then drained.
+        const std::size_t rounds = options.quick ? 20 : 200;
+        constexpr std::size_t kBurst = 1024;
+        std::uint64_t busy_ns = 0;
+        std::uint64_t events = 0;
+        std::uint64_t id = 0;
+        for (std::size_t r = 0; r < rounds; ++r) {
+            for (std::size_t i = 0; i < kBurst; ++i)
+                write_frame(fds[1], id++);
+            const std::uint64_t t0 = monotonic_ns();
+            while (events < id * kFrameEvents)
+                events += passthrough.poll(0);
+            busy_ns += monotonic_ns() - t0;
+        }
+        const auto stats = passthrough.stats();
+        if (stats.frames != id || stats.unmapped != 0)
+            throw std::runtime_error("evdev: frames lost in passthrough");
+
+        // Latency: one frame per millisecond with the passthrough on its own thread.
+        LatencyObserver observer;
+        std::vector<std::uint64_t> sent(options.duration_ms);
+        observer.sent = &sent;
+        observer.samples.reserve(sent.size());
+        manager.stop();
+        manager.set_observer(&observer);
+        manager.start();
+        passthrough.start();
+        std::uint64_t deadline = monotonic_ns();
+        for (std::size_t i = 0; i < sent.size(); ++i) {
+            sleep_until_ns(deadline);
+            sent[i] = monotonic_ns();
+            write_frame(fds[1], i);
+            deadline += 1'000'000;
+        }
+        sleep_until_ns(deadline + 10'000'000);
+        passthrough.stop();
+        manager.stop();
+        ::close(fds[1]);
+
+        const std::string name = "read" + std::to_string(read_events);
+        reporter.add(bench::Record("evdev", name.c_str())
+                         .field("read_events", read_events)
+                         .field("events", events)
+                         .field("events_per_read", static_cast<double>(stats.events) / static_cast<double>(stats.reads))
+                         .field("ns_per_event", static_cast<double>(busy_ns) / static_cast<double>(events))
+                         .latency(bench::percentiles(observer.samples)));
+    }
+}
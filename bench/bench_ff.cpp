@@ -0,0 +1,210 @@
+// Force feedback through a fake uinput fd: how long a game stays blocked in
+// its upload ioctl, and the latency from the game starting an effect to the
+// play command reaching the UDP client that drives the device, with the
+// matching stop and erase each round. Fails if a command is lost, names the
+// wrong effect or carries the wrong parameters.
+
+#include "bench.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/force_feedback.hpp"
+#include "vjc/udp_client.hpp"
+#include "vjc/udp_server.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+/// Stands in for /dev/uinput. The device end of a socket pair carries the
+/// frames out and the game's requests in; the upload and erase handshakes,
+/// which the kernel does with ioctls, go through the fields below.
+class FakeUinput final : public FdBackend {
+public:
+    explicit FakeUinput(int fds[2]) noexcept
+        : FdBackend(fds[0])
+        , game_(fds[1])
+    {
+    }
+    ~FakeUinput() override { ::close(game_); }
+
+    [[nodiscard]] int game() const noexcept { return game_; }
+
+    /// Game side: what the ioctl would do, blocking until answered.
+    int upload(const ff_effect& effect, std::uint32_t request)
+    {
+        upload_.effect = effect;
+        requested_.store(request, std::memory_order_release);
+        send(EV_UINPUT, UI_FF_UPLOAD, static_cast<std::int32_t>(request));
+        wait(request);
+        return upload_.retval;
+    }
+
+    int erase(std::uint32_t effect, std::uint32_t request)
+    {
+        erase_.effect_id = effect;
+        requested_.store(request, std::memory_order_release);
+        send(EV_UINPUT, UI_FF_ERASE, static_cast<std::int32_t>(request));
+        wait(request);
+        return erase_.retval;
+    }
+
+    void send(std::uint16_t type, std::uint16_t code, std::int32_t value)
+    {
+        const input_event event{{}, type, code, value};
+        if (::write(game_, &event, sizeof event) != static_cast<ssize_t>(sizeof event))
+            throw std::runtime_error("ff: short write to fake uinput");
+    }
+
+    bool ff_begin_upload(uinput_ff_upload& upload) noexcept override
+    {
+        if (upload.request_id != requested_.load(std::memory_order_acquire))
+            return false;
+        upload.effect = upload_.effect;
+        return true;
+    }
+
+    bool ff_end_upload(const uinput_ff_upload& upload) noexcept override
+    {
+        upload_.retval = upload.retval;
+        answered_.store(upload.request_id, std::memory_order_release);
+        return true;
+    }
+
+    bool ff_begin_erase(uinput_ff_erase& erase) noexcept override
+    {
+        if (erase.request_id != requested_.load(std::memory_order_acquire))
+            return false;
+        erase.effect_id = erase_.effect_id;
+        return true;
+    }
+
+    bool ff_end_erase(const uinput_ff_erase& erase) noexcept override
+    {
+        erase_.retval = erase.retval;
+        answered_.store(erase.request_id, std::memory_order_release);
+        return true;
+    }
+
+private:
+    void wait(std::uint32_t request)
+    {
+        const std::uint64_t give_up = monotonic_ns() + 1'000'000'000;
+        while (answered_.load(std::memory_order_acquire) != request) {
+            if (monotonic_ns() > give_up)
+                throw std::runtime_error("ff: request never answered");
+            std::this_thread::yield();
+        }
+    }
+
+    int game_;
+    uinput_ff_upload upload_{};
+    uinput_ff_erase erase_{};
+    std::atomic<std::uint32_t> requested_{0};
+    std::atomic<std::uint32_t> answered_{0};
+};
+
+FfPacket expect(UdpClient& client)
+{
+    pollfd pfd{client.fd(), POLLIN, 0};
+    FfPacket packet;
+    while (!client.receive_ff(packet))
+        if (::poll(&pfd, 1, 1000) <= 0)
+            throw std::runtime_error("ff: command never reached the client");
+    return packet;
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(ff, "force-feedback upload blocking time and play round trip to the client")
+{
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0)
+        throw std::system_error(errno, std::system_category(), "socketpair");
+    auto backend = std::make_unique<FakeUinput>(fds);
+    FakeUinput& uinput = *backend;
+    ControllerManager manager;
+    manager.add_device(std::make_unique<VirtualJoystick>(std::move(backend), DeviceDescriptor::rumble_gamepad()));
+
+    UdpServerConfig config;
+    config.address = "127.0.0.1";
+    UdpServer server(manager, config);
+    UdpClient client("127.0.0.1", server.port());
+    ForceFeedback ff(manager, server);
+    manager.start();
+    server.start();
+    ff.start();
+
+    // The server answers the client it last heard from.
+    JoystickState state;
+    client.send(0, state);
+    while (server.send_ff({kFfGain, 0, 0, 0, 0xffff}) == false)
+        std::this_thread::yield();
+    if (expect(client).command != kFfGain)
+        throw std::runtime_error("ff: gain not forwarded");
+
+    const std::size_t rounds = options.quick ? 2'000 : 20'000;
+    std::vector<std::uint64_t> upload_ns, play_ns;
+    upload_ns.reserve(rounds);
+    play_ns.reserve(rounds);
+    std::uint32_t request = 0;
+    for (std::size_t r = 0; r < rounds; ++r) {
+        const auto id = static_cast<std::int16_t>(r % 16);
+        ff_effect effect{};
+        effect.id = id;
+        effect.replay.length = 200;
+        if (r % 2 == 0) {
+            effect.type = FF_RUMBLE;
+            effect.u.rumble.strong_magnitude = static_cast<std::uint16_t>(r);
+            effect.u.rumble.weak_magnitude = static_cast<std::uint16_t>(~r);
+        } else {
+            effect.type = FF_PERIODIC;
+            effect.u.periodic.waveform = FF_SINE;
+            effect.u.periodic.period = 20;
+            effect.u.periodic.magnitude = static_cast<std::int16_t>(r);
+        }
+
+        std::uint64_t t0 = monotonic_ns();
+        if (uinput.upload(effect, ++request) != 0)
+            throw std::runtime_error("ff: upload rejected");
+        upload_ns.push_back(monotonic_ns() - t0);
+
+        t0 = monotonic_ns();
+        uinput.send(EV_FF, static_cast<std::uint16_t>(id), 1);
+        const FfPacket play = expect(client);
+        play_ns.push_back(monotonic_ns() - t0);
+        const std::uint16_t level = effect.type == FF_RUMBLE ? effect.u.rumble.strong_magnitude
+                                                             : static_cast<std::uint16_t>(effect.u.periodic.magnitude);
+        if (play.command != kFfPlay || play.effect != static_cast<std::uint16_t>(id) || play.type != effect.type
+            || play.strong != level || play.length_ms != 200)
+            throw std::runtime_error("ff: play " + std::to_string(r) + " forwarded wrongly");
+
+        uinput.send(EV_FF, static_cast<std::uint16_t>(id), 0);
+        const FfPacket stop = expect(client);
+        if (stop.command != kFfStop || stop.effect != static_cast<std::uint16_t>(id))
+            throw std::runtime_error("ff: stop " + std::to_string(r) + " forwarded wrongly");
+        if (uinput.erase(static_cast<std::uint32_t>(id), ++request) != 0)
+            throw std::runtime_error("ff: erase rejected");
+    }
+    ff.stop();
+    server.stop();
+    manager.stop();
+
+    const ForceFeedback::Stats& stats = ff.stats();
+    if (stats.uploads != rounds || stats.erases != rounds || stats.plays != rounds || stats.stops != rounds
+        || stats.rejected + stats.unknown + stats.failed + stats.undelivered != 0)
+        throw std::runtime_error("ff: request counts do not add up");
+    reporter.add(bench::Record("ff", "upload").field("rounds", rounds).latency(bench::percentiles(upload_ns)));
+    reporter.add(bench::Record("ff", "play_to_client").field("rounds", rounds).latency(bench::percentiles(play_ns)));
+}
@@ -0,0 +1,220 @@
+// Coroutine I/O loop, io_uring against epoll on the same tasks: throughput
+// of 32 pipes standing in for evdev sources, each event read and written on
+// to /dev/null as a uinput write would be, and the latency from a paced
+// producer thread to the write completing, with a UDP socket received
+// alongside. Fails if either backend loses or reorders an event.
+
+#include "bench.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/io_loop.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+constexpr std::size_t kPipes = 32;
+
+/// What a source delivers, sized like an input_event.
+struct Message {
+    std::uint64_t stamp;
+    std::uint64_t sequence;
+    std::uint64_t padding;
+};
+static_assert(sizeof(Message) == sizeof(input_event));
+
+struct Counters {
+    std::uint64_t received = 0;
+    std::uint64_t lost = 0;
+    std::vector<std::uint64_t>* samples = nullptr; // latency, when timed
+};
+
+void check(int result, const char* what)
+{
+    if (result < 0)
+        throw std::system_error(errno, std::system_category(), what);
+}
+
+void record(Counters& counters, const Message& message, std::uint64_t& next) noexcept
+{
+    if (message.sequence != next)
+        ++counters.lost;
+    next = message.sequence + 1;
+    ++counters.received;
+    if (counters.samples && counters.samples->size() < counters.samples->capacity())
+        counters.samples->push_back(monotonic_ns() - message.stamp);
+}
+
+/// Reads events from `in` one at a time and forwards each to `out`.
+IoTask relay(IoLoop& loop, int in, int out, Counters& counters)
+{
+    Message message;
+    std::uint64_t next = 0;
+    for (;;) {
+        if (co_await loop.read(in, &message, sizeof message) != sizeof message)
+            co_return;
+        if (co_await loop.write(out, &message, sizeof message) != sizeof message)
+            co_return;
+        record(counters, message, next);
+    }
+}
+
+/// Receives datagrams from `socket` and forwards each to `out`.
+IoTask receive(IoLoop& loop, int socket, int out, Counters& counters)
+{
+    Message message;
+    iovec iov{&message, sizeof message};
+    msghdr hdr{};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    std::uint64_t next = 0;
+    for (;;) {
+        if (co_await loop.recvmsg(socket, &hdr) != sizeof message)
+            co_return;
+        if (co_await loop.write(out, &message, sizeof message) != sizeof message)
+            co_return;
+        record(counters, message, next);
+    }
+}
+
+/// Fds shared by both backends' runs.
+struct Endpoints {
+    int pipes[kPipes][2];
+    int null = -1;
+    int socket = -1; // bound, non-blocking
+    int sender = -1; // connected to `socket`
+
+    Endpoints()
+    {
+        for (auto& p : pipes) {
+            check(::pipe2(p, O_CLOEXEC), "pipe2");
+            ::fcntl(p[0], F_SETFL, O_NONBLOCK);
+        }
+        null = ::open("/dev/null", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        check(null, "open /dev/null");
+        socket = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        check(socket, "socket");
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof addr;
+        check(::bind(socket, reinterpret_cast<sockaddr*>(&addr), length), "bind");
+        check(::getsockname(socket, reinterpret_cast<sockaddr*>(&addr), &length), "getsockname");
+        sender = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        check(sender, "socket");
+        check(::connect(sender, reinterpret_cast<sockaddr*>(&addr), length), "connect");
+    }
+
+    ~Endpoints()
+    {
+        for (auto& p : pipes) {
+            ::close(p[0]);
+            ::close(p[1]);
+        }
+        ::close(null);
+        ::close(socket);
+        ::close(sender);
+    }
+};
+
+void send_all(int fd, const Message& message)
+{
+    if (::write(fd, &message, sizeof message) != static_cast<ssize_t>(sizeof message))
+        throw std::runtime_error("io: short write to source");
+}
+
+void run_backend(IoBackend backend, Endpoints& fds, const bench::Options& options, bench::Reporter& reporter)
+{
+    std::unique_ptr<IoLoop> loop = IoLoop::create(backend);
+    Counters counters;
+    for (auto& p : fds.pipes)
+        loop->spawn(relay(*loop, p[0], fds.null, counters));
+    loop->spawn(receive(*loop, fds.socket, fds.null, counters));
+    const char* name = to_string(backend);
+
+    // Throughput: a burst queued in every pipe, then relayed.
+    const std::size_t rounds = options.quick ? 20 : 200;
+    constexpr std::size_t kBurst = 256;
+    std::uint64_t sequence[kPipes]{};
+    std::uint64_t busy_ns = 0;
+    std::size_t turns = 0;
+    for (std::size_t r = 0; r < rounds; ++r) {
+        for (std::size_t p = 0; p < kPipes; ++p)
+            for (std::size_t i = 0; i < kBurst; ++i)
+                send_all(fds.pipes[p][1], {0, sequence[p]++, 0});
+        const std::uint64_t target = counters.received + kPipes * kBurst;
+        const std::uint64_t t0 = monotonic_ns();
+        while (counters.received < target) {
+            loop->run_once(100);
+            ++turns;
+        }
+        busy_ns += monotonic_ns() - t0;
+    }
+    const std::uint64_t events = counters.received;
+
+    // Latency: one event every 100 us from another thread, round-robin
+    // over the pipes and the socket.
+    std::vector<std::uint64_t> samples;
+    samples.reserve(options.duration_ms * 10);
+    counters.samples = &samples;
+    const std::size_t total = samples.capacity();
+    std::thread producer([&] {
+        std::uint64_t udp_sequence = 0;
+        std::uint64_t deadline = monotonic_ns();
+        for (std::size_t i = 0; i < total; ++i) {
+            deadline += 100'000;
+            sleep_until_ns(deadline);
+            const std::size_t p = i % (kPipes + 1);
+            if (p == kPipes)
+                send_all(fds.sender, {monotonic_ns(), udp_sequence++, 0});
+            else
+                send_all(fds.pipes[p][1], {monotonic_ns(), sequence[p]++, 0});
+        }
+    });
+    const std::uint64_t end = counters.received + total;
+    const std::uint64_t give_up = monotonic_ns() + options.duration_ms * 1'000'000 + 2'000'000'000;
+    while (counters.received < end && monotonic_ns() < give_up)
+        loop->run_once(10);
+    producer.join();
+
+    if (counters.received != end || counters.lost != 0 || loop->tasks() != kPipes + 1)
+        throw std::runtime_error(std::string("io: ") + name + " lost or reordered events");
+    reporter.add(bench::Record("io", name)
+                     .field("tasks", static_cast<std::uint64_t>(loop->tasks()))
+                     .field("events", events)
+                     .field("events_per_turn", static_cast<double>(events) / static_cast<double>(turns))
+                     .field("ns_per_event", static_cast<double>(busy_ns) / static_cast<double>(events))
+                     .field("events_per_sec", static_cast<double>(events) * 1e9 / static_cast<double>(busy_ns))
+                     .latency(bench::percentiles(samples)));
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(io, "coroutine I/O loop: io_uring vs epoll throughput and latency")
+{
+    for (const IoBackend backend : {IoBackend::Uring, IoBackend::Epoll}) {
+        // Fresh fds per backend, so neither inherits the other's registrations.
+        Endpoints fds;
+        try {
+            run_backend(backend, fds, options, reporter);
+        } catch (const std::system_error& e) {
+            if (backend != IoBackend::Uring)
+                throw;
+            reporter.add(bench::Record("io", to_string(backend)).field("unavailable", e.what()));
+        }
+    }
+}
@@ -0,0 +1,207 @@
+#include "bench.hpp"
+
+#include "vjc/virtual_joystick.hpp"
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <string_view>
+
+namespace vjc::bench {
+
+Percentiles percentiles(std::vector<std::uint64_t>& samples)
+{
+    Percentiles p;
+    p.count = samples.size();
+    if (samples.empty())
+        return p;
+    std::sort(samples.begin(), samples.end());
+    const auto at = [&](double q) {
+        const auto index = static_cast<std::size_t>(q * static_cast<double>(samples.size() - 1) + 0.5);
+        return samples[std::min(index, samples.size() - 1)];
+    };
+    p.p50 = at(0.50);
+    p.p99 = at(0.99);
+    p.p999 = at(0.999);
+    p.max = samples.back();
+    return p;
+}
+
+Record::Record(const char* suite, const char* name)
+{
+    field("suite", suite);
+    field("name", name);
+}
+
+Record& Record::field(const char* key, std::int64_t value)
+{
+    fields_.emplace_back(key, std::to_string(value));
+    return *this;
+}
+
+Record& Record::field(const char* key, std::uint64_t value)
+{
+    fields_.emplace_back(key, std::to_string(value));
+    return *this;
+}
+
+Record& Record::field(const char* key, double value)
+{
+    char buf[64];
+    std::snprintf(buf, sizeof buf, "%.3f", value);
+    fields_.emplace_back(key, buf);
+    return *this;
+}
+
+Record& Record::field(const char* key, const char* value)
+{
+    std::string quoted = "\"";
+    for (const char* c = value; *c; ++c) {
+        if (*c == '"' || *c == '\\')
+            quoted += '\\';
+        quoted += *c;
+    }
+    quoted += '"';
+    fields_.emplace_back(key, std::move(quoted));
+    return *this;
+}
+
+Record& Record::latency(const Percentiles& p)
+{
+    return field("samples", static_cast<std::uint64_t>(p.count))
+        .field("p50_ns", p.p50)
+        .field("p99_ns", p.p99)
+        .field("p999_ns", p.p999)
+        .field("max_ns", p.max);
+}
+
+std::string Record::json() const
+{
+    std::string line = "{";
+    for (std::size_t i = 0; i < fields_.size(); ++i) {
+        if (i)
+            line += ',';
+        line += '"' + fields_[i].first + "\":" + fields_[i].second;
+    }
+    line += '}';
+    return line;
+}
+
+Reporter::Reporter(const std::string& path)
+    : out_(std::fopen(path.c_str(), "w"))
+{
+    if (!out_)
+        throw std::runtime_error("cannot open " + path);
+}
+
+Reporter::~Reporter()
+{
+    std::fclose(out_);
+}
+
+void Reporter::add(const Record& record)
+{
+    const std::string line = record.json();
+    std::fprintf(out_, "%s\n", line.c_str());
+    std::fflush(out_);
+
+    for (const auto& [key, value] : record.fields())
+        std::printf("%s=%s ", key.c_str(), value.c_str());
+    std::printf("\n");
+}
+
+std::unique_ptr<FdBackend> null_backend()
+{
+    const int fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::system_error(errno, std::system_category(), "open /dev/null");
+    return std::make_unique<FdBackend>(fd);
+}
+
+std::unique_ptr<VirtualJoystick> null_device()
+{
+    return std::make_unique<VirtualJoystick>(null_backend(), DeviceDescriptor::gamepad());
+}
+
+SuiteRegistrar::SuiteRegistrar(const char* name, const char* description, SuiteFn run)
+{
+    suites().push_back({name, description, run});
+}
+
+std::vector<Suite>& suites()
+{
+    static std::vector<Suite> registry;
+    return registry;
+}
+
+} // namespace vjc::bench
+
+namespace {
+
+void usage(const char* argv0)
+{
+    std::printf("usage: %s [--quick] [--duration-ms N] [--output FILE] [--list] [SUITE...]\n\n"
+                "Runs the selected suites (all by default) and writes one JSON object per\n"
+                "result to FILE (default: bench_output.txt).\n",
+                argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    using namespace vjc::bench;
+
+    Options options;
+    std::string output = "bench_output.txt";
+    std::vector<std::string_view> selected;
+    bool duration_set = false;
+
+    std::sort(suites().begin(), suites().end(),
+              [](const Suite& a, const Suite& b) { return std::strcmp(a.name, b.name) < 0; });
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--duration-ms" && i + 1 < argc) {
+            options.duration_ms = std::strtoull(argv[++i], nullptr, 10);
+            duration_set = true;
+        } else if (arg == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "--list") {
+            for (const auto& suite : suites())
+                std::printf("%-12s %s\n", suite.name, suite.description);
+            return 0;
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            selected.push_back(arg);
+        }
+    }
+    if (options.quick && !duration_set)
+        options.duration_ms = 100;
+
+    try {
+        Reporter reporter(output);
+        for (const auto& suite : suites()) {
+            if (!selected.empty() && std::find(selected.begin(), selected.end(), suite.name) == selected.end())
+                continue;
+            std::printf("== %s: %s\n", suite.name, suite.description);
+            suite.run(options, reporter);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "vjc_bench: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
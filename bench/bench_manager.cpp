@@ -0,0 +1,92 @@
+// ControllerManager scaling: frames/sec as writer threads are added, with
+// every device driven flat out, and a starvation check on the least-served
+// device. Devices write to /dev/null so the syscall cost stays in the loop.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+VJC_BENCH_SUITE(manager, "multi-device throughput scaling and per-device fairness")
+{
+    using namespace vjc;
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> writer_counts;
+    for (unsigned w = 1; w <= cores && w <= 16; w *= 2)
+        writer_counts.push_back(w);
+    const std::vector<std::size_t> device_counts = options.quick ? std::vector<std::size_t>{256}
+                                                                 : std::vector<std::size_t>{16, 64, 256};
+
+    for (std::size_t devices : device_counts) {
+        double base_rate = 0;
+        for (unsigned writers : writer_counts) {
+            ManagerConfig config;
+            config.writer_threads = writers;
+            for (unsigned c = 0; c < writers; ++c)
+                config.cpus.push_back(static_cast<int>(c % cores));
+            ControllerManager manager(config);
+            for (std::size_t d = 0; d < devices; ++d)
+                manager.add_device(bench::null_device());
+            manager.start();
+
+            // One producer per writer, each owning a disjoint set of devices.
+            std::atomic<bool> producing{true};
+            std::vector<std::thread> producers;
+            for (unsigned p = 0; p < writers; ++p) {
+                producers.emplace_back([&, p] {
+                    const bench::SyntheticInput input(p);
+                    JoystickState state;
+                    for (std::uint64_t frame = 0; producing.load(std::memory_order_relaxed); ++frame)
+                        for (std::size_t d = p; d < devices; d += writers) {
+                            input.fill(frame + d, state);
+                            manager.publish(d, state);
+                        }
+                });
+            }
+
+            const std::uint64_t t0 = monotonic_ns();
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.duration_ms));
+            producing.store(false, std::memory_order_relaxed);
+            for (auto& t : producers)
+                t.join();
+            manager.stop();
+            const double seconds = static_cast<double>(monotonic_ns() - t0) / 1e9;
+
+            std::uint64_t total = 0;
+            std::uint64_t least = ~std::uint64_t{0};
+            std::uint64_t most = 0;
+            for (std::size_t d = 0; d < devices; ++d) {
+                const std::uint64_t frames = manager.stats(d).frames;
+                total += frames;
+                least = std::min(least, frames);
+                most = std::max(most, frames);
+            }
+            if (least == 0)
+                throw std::runtime_error("manager: a device was starved");
+
+            const double rate = static_cast<double>(total) / seconds;
+            if (writers == 1)
+                base_rate = rate;
+            const double mean = static_cast<double>(total) / static_cast<double>(devices);
+            const std::string name = std::to_string(devices) + "dev_" + std::to_string(writers) + "w";
+            reporter.add(bench::Record("manager", name.c_str())
+                             .field("devices", static_cast<std::uint64_t>(devices))
+                             .field("writers", writers)
+                             .field("pinned", manager.pinned())
+                             .field("frames_per_sec", rate)
+                             .field("scaling", base_rate > 0 ? rate / base_rate : 1.0)
+                             .field("min_device_frames", least)
+                             .field("max_device_frames", most)
+                             .field("fairness", static_cast<double>(least) / mean));
+        }
+    }
+}
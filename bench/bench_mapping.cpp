@@ -0,0 +1,317 @@
+// Mapping engine: ns per frame of the compiled dispatch tables against a
+// naive interpreter that walks every rule, as profiles grow from 16 to 512
+// rules. Both are driven with the same input and must agree on every frame.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/mapping.hpp"
+
+#include <bit>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+/// Reference semantics: every rule is visited on every frame.
+class NaiveMapper {
+public:
+    explicit NaiveMapper(const MappingProfile& profile)
+        : rules_(profile.rules)
+        , state_(rules_.size())
+    {
+    }
+
+    void apply(const JoystickState& in, JoystickState& out) noexcept
+    {
+        const std::uint64_t pressed = in.buttons;
+        std::uint64_t held = 0;
+        std::uint64_t consumed = 0;
+        std::uint64_t remapped = 0;
+        std::uint64_t emitted = 0;
+
+        for (std::size_t i = 0; i < rules_.size(); ++i) {
+            const MappingRule& rule = rules_[i];
+            RuleState& st = state_[i];
+            const bool down = (pressed & rule.inputs) == rule.inputs;
+            switch (rule.kind) {
+            case RuleKind::Chord:
+            case RuleKind::Macro:
+                if (down) {
+                    held |= rule.inputs;
+                    if (rule.kind == RuleKind::Chord)
+                        emitted |= rule.outputs;
+                    else if (!st.held) {
+                        st.step = 0;
+                        st.left = rule.steps[0].frames;
+                    }
+                }
+                st.held = down;
+                break;
+            case RuleKind::Toggle:
+                consumed |= rule.inputs;
+                if (down && !(previous_ & rule.inputs))
+                    st.latched = !st.latched;
+                if (st.latched)
+                    emitted |= rule.outputs;
+                break;
+            case RuleKind::Turbo:
+                consumed |= rule.inputs;
+                if (down) {
+                    if (((st.counter++ / rule.period) & 1) == 0)
+                        emitted |= rule.outputs;
+                } else {
+                    st.counter = 0;
+                }
+                break;
+            case RuleKind::Button:
+                remapped |= rule.inputs;
+                break;
+            default:
+                break;
+            }
+        }
+
+        const std::uint64_t rest = pressed & ~(held | consumed);
+        for (unsigned b = 0; b < kMaxButtons; ++b) {
+            const std::uint64_t bit = std::uint64_t{1} << b;
+            if (!(rest & bit))
+                continue;
+            if (!(remapped & bit)) {
+                emitted |= bit;
+                continue;
+            }
+            for (const MappingRule& rule : rules_)
+                if (rule.kind == RuleKind::Button && (rule.inputs & bit))
+                    emitted |= rule.outputs;
+        }
+
+        for (std::size_t i = 0; i < rules_.size(); ++i) {
+            RuleState& st = state_[i];
+            if (rules_[i].kind != RuleKind::Macro || st.step < 0)
+                continue;
+            emitted |= rules_[i].steps[static_cast<std::size_t>(st.step)].buttons;
+            if (--st.left == 0) {
+                if (static_cast<std::size_t>(++st.step) == rules_[i].steps.size())
+                    st.step = -1;
+                else
+                    st.left = rules_[i].steps[static_cast<std::size_t>(st.step)].frames;
+            }
+        }
+
+        out = in;
+        out.buttons = emitted;
+        std::uint8_t sources = 0;
+        std::uint8_t targets = 0;
+        for (const MappingRule& rule : rules_) {
+            if (rule.kind == RuleKind::Axis || rule.kind == RuleKind::AxisToButton || rule.kind == RuleKind::AxisToHat)
+                sources |= static_cast<std::uint8_t>(1u << rule.axis);
+            if (rule.kind == RuleKind::AxisToHat)
+                sources |= static_cast<std::uint8_t>(1u << rule.axis_y);
+            if (rule.kind == RuleKind::Axis)
+                targets |= static_cast<std::uint8_t>(1u << rule.target);
+        }
+        for (unsigned a = 0; a < kMaxAxes; ++a)
+            if ((sources & ~targets) & (1u << a))
+                out.axes[a] = 0;
+        for (const MappingRule& rule : rules_) {
+            const std::int32_t x = in.axes[rule.axis];
+            if (rule.kind == RuleKind::Axis) {
+                out.axes[rule.target] = static_cast<std::int16_t>(rule.invert ? (x == -32768 ? 32767 : -x) : x);
+            } else if (rule.kind == RuleKind::AxisToButton) {
+                if (rule.below ? x < rule.threshold : x > rule.threshold)
+                    out.buttons |= rule.outputs;
+            } else if (rule.kind == RuleKind::AxisToHat) {
+                const std::int32_t y = in.axes[rule.axis_y];
+                const std::int64_t ax = x < 0 ? -x : x;
+                const std::int64_t ay = y < 0 ? -y : y;
+                std::int8_t hx = 0;
+                std::int8_t hy = 0;
+                if (ax * ax + ay * ay > std::int64_t{rule.threshold} * rule.threshold) {
+                    if (ax * 10000 > ay * 4142)
+                        hx = x < 0 ? -1 : 1;
+                    if (ay * 10000 > ax * 4142)
+                        hy = y < 0 ? -1 : 1;
+                }
+                out.hats[2 * rule.target] = hx;
+                out.hats[2 * rule.target + 1] = hy;
+            }
+        }
+        previous_ = pressed;
+    }
+
+private:
+    struct RuleState {
+        bool held = false;
+        bool latched = false;
+        std::uint32_t counter = 0;
+        int step = -1;
+        std::uint16_t left = 0;
+    };
+
+    std::vector<MappingRule> rules_;
+    std::vector<RuleState> state_;
+    std::uint64_t previous_ = 0;
+};
+
+class Random {
+public:
+    std::uint32_t next() noexcept
+    {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+    unsigned below(unsigned n) noexcept { return next() % n; }
+
+private:
+    std::uint32_t state_ = 0x2545f491u;
+};
+
+/// A profile of `count` rules in the text format, mostly remaps and chords.
+/// Buttons 0..7 are reserved for toggle and turbo sources.
+std::string make_profile(std::size_t count, Random& rng)
+{
+    std::string text;
+    unsigned toggles = 0;
+    unsigned turbos = 0;
+    const auto number = [&](unsigned n) { text += std::to_string(n); };
+    const auto button = [&] {
+        text += 'b';
+        number(8 + rng.below(56));
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+        const unsigned kind = rng.below(20);
+        if (kind < 11) {
+            button();
+            text += " -> ";
+            button();
+        } else if (kind < 14) {
+            button();
+            text += '+';
+            button();
+            text += " -> ";
+            button();
+        } else if (kind < 15) {
+            button();
+            text += '+';
+            button();
+            text += " -> macro ";
+            button();
+            text += ":2 -:1 ";
+            button();
+            text += '+';
+            button();
+            text += ":3";
+        } else if (kind < 16 && toggles < 4) {
+            text += "toggle b";
+            number(toggles);
+            text += " -> b";
+            number(56 + toggles++);
+        } else if (kind < 17 && turbos < 4) {
+            text += "turbo b";
+            number(4 + turbos++);
+            text += " -> ";
+            button();
+            text += " every 3";
+        } else if (kind < 19) {
+            text += 'a';
+            number(rng.below(8));
+            text += " -> ";
+            button();
+            text += rng.below(2) ? " when > " : " when < -";
+            number(1 + rng.below(30000));
+        } else {
+            text += "a4 a5 -> hat1 deadzone 4000";
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+/// `when > N` and `when < N` compare strictly against the signed N.
+void check_thresholds()
+{
+    const CompiledMapping compiled(MappingProfile::parse("a0 -> b1 when > 16000\n"
+                                                         "a0 -> b2 when < -8000\n"
+                                                         "a1 -> b3 when < 100\n"));
+    MappingState state(compiled);
+    const auto fires = [&](std::int16_t a0, std::int16_t a1) {
+        JoystickState in;
+        JoystickState out;
+        in.axes[0] = a0;
+        in.axes[1] = a1;
+        compiled.apply(in, state, out);
+        return out.buttons;
+    };
+    if (fires(16000, 100) != 0 || fires(-8000, 100) != 0)
+        throw std::runtime_error("mapping: threshold fires at its own value");
+    if (fires(16001, 99) != (1u << 1 | 1u << 3) || fires(-8001, 0) != (1u << 2 | 1u << 3))
+        throw std::runtime_error("mapping: threshold does not fire past its value");
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(mapping, "compiled mapping tables vs a naive rule interpreter")
+{
+    const std::uint64_t frames = options.quick ? 100'000 : 1'000'000;
+    const bench::SyntheticInput input;
+    check_thresholds();
+
+    for (std::size_t rules : {16u, 128u, 512u}) {
+        Random rng;
+        const MappingProfile profile = MappingProfile::parse(make_profile(rules, rng));
+        const CompiledMapping compiled(profile);
+        MappingState state(compiled);
+        NaiveMapper naive(profile);
+
+        // Inputs generated up front so both runs time only the mapping.
+        std::vector<JoystickState> inputs(4096);
+        // Like a player: up to four buttons held, one change every few frames.
+        std::uint64_t buttons = 0;
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            input.fill(i, inputs[i]);
+            if (rng.below(3) == 0) {
+                const std::uint64_t bit = std::uint64_t{1} << rng.below(64);
+                if ((buttons & bit) || std::popcount(buttons) < 4)
+                    buttons ^= bit;
+            }
+            inputs[i].buttons = buttons;
+        }
+
+        JoystickState a;
+        JoystickState b;
+        for (std::size_t f = 0; f < 20'000; ++f) {
+            compiled.apply(inputs[f % inputs.size()], state, a);
+            naive.apply(inputs[f % inputs.size()], b);
+            if (!(a == b))
+                throw std::runtime_error("mapping: compiled table disagrees with the interpreter at frame "
+                                         + std::to_string(f));
+        }
+
+        std::uint64_t t0 = monotonic_ns();
+        for (std::uint64_t f = 0; f < frames; ++f) {
+            compiled.apply(inputs[f % inputs.size()], state, a);
+            bench::do_not_optimize(a);
+        }
+        const std::uint64_t compiled_ns = monotonic_ns() - t0;
+        t0 = monotonic_ns();
+        for (std::uint64_t f = 0; f < frames; ++f) {
+            naive.apply(inputs[f % inputs.size()], b);
+            bench::do_not_optimize(b);
+        }
+        const std::uint64_t naive_ns = monotonic_ns() - t0;
+
+        const std::string name = std::to_string(rules) + "_rules";
+        reporter.add(bench::Record("mapping", name.c_str())
+                         .field("rules", static_cast<std::uint64_t>(rules))
+                         .field("compiled_ns_per_frame", static_cast<double>(compiled_ns) / static_cast<double>(frames))
+                         .field("naive_ns_per_frame", static_cast<double>(naive_ns) / static_cast<double>(frames))
+                         .field("speedup", static_cast<double>(naive_ns) / static_cast<double>(compiled_ns)));
+    }
+}
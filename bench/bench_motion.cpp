@@ -0,0 +1,181 @@
+// Motion-sensor companion device: cost of the fixed-point calibration kernel
+// per SIMD tier, with a check that every tier matches the scalar reference
+// bit for bit, and report throughput to /dev/null for batches of 1 to 64
+// samples per write. Fails if the encoded report stream is malformed.
+
+#include "bench.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/motion_sensor.hpp"
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+std::unique_ptr<MotionSensor> null_sensor(SimdLevel level)
+{
+    return std::make_unique<MotionSensor>(bench::null_backend(), DeviceDescriptor::motion_sensor(), level);
+}
+
+/// A mounting rotated 30 degrees about z with a 2% accelerometer gain, and a
+/// gyroscope matrix at the edges of the fixed-point range.
+MotionCalibration calibration()
+{
+    const float c = 1.02f * std::cos(0.5235988f);
+    const float s = 1.02f * std::sin(0.5235988f);
+    MotionCalibration cal;
+    cal.accel.bias = {120, -80, 40};
+    cal.accel.matrix = {c, -s, 0, s, c, 0, 0, 0, 1.02f};
+    cal.gyro.bias = {-20000, 3, 20000};
+    cal.gyro.matrix = {4, -4, 0.5f, 0, -1, 3.999f, -4, 0.25f, 4};
+    return cal;
+}
+
+/// Pseudo-random samples, with full-scale values mixed in so the bias
+/// subtraction saturates.
+std::vector<MotionSample> make_samples(std::size_t count)
+{
+    std::vector<MotionSample> samples(count);
+    std::uint64_t x = 0x9e3779b97f4a7c15ull;
+    for (std::size_t i = 0; i < count; ++i) {
+        for (std::size_t a = 0; a < 3; ++a) {
+            x = x * 6364136223846793005ull + 1442695040888963407ull;
+            samples[i].accel[a] = static_cast<std::int16_t>(x >> 48);
+            samples[i].gyro[a] = static_cast<std::int16_t>(x >> 32);
+            if (i % 7 == a)
+                samples[i].gyro[a] = (i & 1) ? 32767 : -32768;
+        }
+        samples[i].timestamp_ns = 1'000'000'000 + i * 1'000'000;
+    }
+    return samples;
+}
+
+bool same(const MotionReading& a, const MotionReading& b)
+{
+    return a.accel == b.accel && a.gyro == b.gyro && a.timestamp_ns == b.timestamp_ns;
+}
+
+/// Three reports through a pipe: six axes, MSC_TIMESTAMP, SYN_REPORT each.
+void check_stream()
+{
+    int fds[2];
+    if (::pipe2(fds, O_CLOEXEC) < 0)
+        throw std::system_error(errno, std::system_category(), "pipe2");
+    MotionSensor sensor(std::make_unique<FdBackend>(fds[1]));
+    sensor.calibrate(calibration());
+    const std::vector<MotionSample> samples = make_samples(3);
+    std::vector<MotionReading> expected(samples.size());
+    MotionCalibrator calibrator(SimdLevel::Scalar);
+    calibrator.configure(calibration());
+    calibrator.apply(samples.data(), samples.size(), expected.data());
+
+    constexpr std::size_t kEvents = 3 * kMotionReportEvents;
+    input_event events[kEvents];
+    const bool written = sensor.submit(samples) == kEvents && sensor.stats().writes == 1;
+    const bool read = ::read(fds[0], events, sizeof events) == static_cast<ssize_t>(sizeof events);
+    ::close(fds[0]);
+    if (!written || !read)
+        throw std::runtime_error("motion: batch not written in one write");
+
+    const DeviceDescriptor& d = sensor.descriptor();
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        const input_event* e = events + i * kMotionReportEvents;
+        bool ok = true;
+        for (std::size_t a = 0; a < 3; ++a) {
+            ok &= e[a].type == EV_ABS && e[a].code == d.axes[a].code && e[a].value == expected[i].accel[a];
+            ok &= e[3 + a].type == EV_ABS && e[3 + a].code == d.axes[3 + a].code
+                && e[3 + a].value == expected[i].gyro[a];
+        }
+        ok &= e[6].type == EV_MSC && e[6].code == MSC_TIMESTAMP
+            && static_cast<std::uint32_t>(e[6].value) == static_cast<std::uint32_t>(samples[i].timestamp_ns / 1000);
+        ok &= e[7].type == EV_SYN && e[7].code == SYN_REPORT;
+        if (!ok)
+            throw std::runtime_error("motion: malformed report " + std::to_string(i));
+    }
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(motion, "IMU companion device: calibration kernel per SIMD tier and batched report throughput")
+{
+    check_stream();
+
+    // Calibration kernel alone.
+    const std::size_t kernel_samples = 4096;
+    const std::size_t iterations = options.quick ? 200 : 2'000;
+    const std::vector<MotionSample> samples = make_samples(kernel_samples);
+    std::vector<MotionReading> reference(kernel_samples);
+    {
+        MotionCalibrator scalar(SimdLevel::Scalar);
+        scalar.configure(calibration());
+        scalar.apply(samples.data(), kernel_samples, reference.data());
+    }
+    double scalar_ns = 0;
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2}) {
+        MotionCalibrator calibrator(level);
+        if (calibrator.level() != level)
+            continue;
+        calibrator.configure(calibration());
+        std::vector<MotionReading> out(kernel_samples);
+        calibrator.apply(samples.data(), kernel_samples, out.data());
+        for (std::size_t i = 0; i < kernel_samples; ++i)
+            if (!same(out[i], reference[i]))
+                throw std::runtime_error(std::string("motion: ") + to_string(level) + " differs from scalar");
+
+        const std::uint64_t t0 = monotonic_ns();
+        for (std::size_t i = 0; i < iterations; ++i)
+            calibrator.apply(samples.data(), kernel_samples, out.data());
+        const double ns_per_sample
+            = static_cast<double>(monotonic_ns() - t0) / static_cast<double>(iterations * kernel_samples);
+        if (level == SimdLevel::Scalar)
+            scalar_ns = ns_per_sample;
+        const std::string name = std::string("calibrate_") + to_string(level);
+        reporter.add(bench::Record("motion", name.c_str())
+                         .field("simd", to_string(level))
+                         .field("ns_per_sample", ns_per_sample)
+                         .field("speedup_vs_scalar", scalar_ns > 0 ? scalar_ns / ns_per_sample : 1.0));
+    }
+
+    // Whole device: calibrate, encode and write, per batch size.
+    const std::size_t total = options.quick ? 100'000 : 1'000'000;
+    const std::vector<MotionSample> stream = make_samples(MotionSensor::kMaxBatch * 16);
+    for (const std::size_t batch : {std::size_t{1}, std::size_t{8}, MotionSensor::kMaxBatch}) {
+        const std::unique_ptr<MotionSensor> sensor = null_sensor(detect_simd_level());
+        sensor->calibrate(calibration());
+        std::vector<std::uint64_t> submit_ns;
+        submit_ns.reserve(total / batch + 1);
+        std::size_t offset = 0;
+        const std::uint64_t t0 = monotonic_ns();
+        for (std::size_t done = 0; done < total; done += batch) {
+            const std::uint64_t s0 = monotonic_ns();
+            sensor->submit({stream.data() + offset, batch});
+            submit_ns.push_back(monotonic_ns() - s0);
+            offset = (offset + batch) % stream.size();
+        }
+        const double elapsed = static_cast<double>(monotonic_ns() - t0);
+        const auto& stats = sensor->stats();
+        if (stats.failed_writes != 0 || stats.events != stats.samples * kMotionReportEvents)
+            throw std::runtime_error("motion: reports lost");
+        const std::string name = "batch_" + std::to_string(batch);
+        reporter.add(bench::Record("motion", name.c_str())
+                         .field("simd", to_string(sensor->level()))
+                         .field("batch", static_cast<std::uint64_t>(batch))
+                         .field("reports", stats.samples)
+                         .field("writes", stats.writes)
+                         .field("ns_per_sample", elapsed / static_cast<double>(stats.samples))
+                         .field("samples_per_sec", static_cast<double>(stats.samples) * 1e9 / elapsed)
+                         .field("events_per_sec", static_cast<double>(stats.events) * 1e9 / elapsed)
+                         .latency(bench::percentiles(submit_ns)));
+    }
+}
@@ -0,0 +1,146 @@
+// Producer -> ControllerManager (StateRing, writer thread, VirtualJoystick)
+// -> pipe, with a drain thread standing in for the kernel. Latency is
+// measured from the time a state is produced to the return of the frame's
+// write().
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+struct LatencyObserver final : FrameObserver {
+    std::vector<std::uint64_t> samples;
+
+    void on_frame(unsigned, std::size_t, const JoystickState& state, std::size_t) noexcept override
+    {
+        if (samples.size() < samples.capacity())
+            samples.push_back(monotonic_ns() - state.timestamp_ns);
+    }
+};
+
+struct Result {
+    std::uint64_t produced = 0;
+    ControllerManager::DeviceStats totals;
+    std::vector<std::uint64_t> latencies;
+};
+
+Result run_pipeline(unsigned rate_hz, unsigned device_count, std::uint64_t duration_ms)
+{
+    ControllerManager manager;
+    std::vector<int> read_fds;
+    for (unsigned i = 0; i < device_count; ++i) {
+        int fds[2];
+        if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0)
+            throw std::system_error(errno, std::system_category(), "pipe2");
+        ::fcntl(fds[1], F_SETPIPE_SZ, 1 << 20);
+        read_fds.push_back(fds[0]);
+        manager.add_device(std::make_unique<VirtualJoystick>(std::make_unique<FdBackend>(fds[1]),
+                                                             DeviceDescriptor::gamepad()));
+    }
+
+    LatencyObserver observer;
+    observer.samples.reserve(static_cast<std::size_t>(rate_hz) * device_count * duration_ms / 1000 * 5 / 4 + 1024);
+    manager.set_observer(&observer);
+
+    std::atomic<bool> draining{true};
+    std::thread drain([&] {
+        const int ep = ::epoll_create1(EPOLL_CLOEXEC);
+        for (int fd : read_fds) {
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            ::epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+        }
+        std::vector<char> buf(1 << 16);
+        epoll_event ready[64];
+        while (draining.load(std::memory_order_relaxed)) {
+            const int n = ::epoll_wait(ep, ready, 64, 10);
+            for (int i = 0; i < n; ++i)
+                while (::read(ready[i].data.fd, buf.data(), buf.size()) > 0) {
+                }
+        }
+        ::close(ep);
+    });
+
+    manager.start();
+
+    Result result;
+    std::vector<bench::SyntheticInput> inputs;
+    for (unsigned i = 0; i < device_count; ++i)
+        inputs.emplace_back(i);
+    const std::uint64_t period = 1'000'000'000ull / rate_hz;
+    const std::uint64_t start = monotonic_ns();
+    const std::uint64_t end = start + duration_ms * 1'000'000ull;
+    std::uint64_t deadline = start;
+    for (std::uint64_t frame = 0; deadline < end; ++frame) {
+        sleep_until_ns(deadline);
+        for (unsigned i = 0; i < device_count; ++i) {
+            JoystickState* s = manager.claim(i);
+            inputs[i].fill(frame, *s);
+            s->timestamp_ns = monotonic_ns();
+            manager.commit(i);
+            ++result.produced;
+        }
+        deadline += period;
+    }
+
+    manager.stop();
+    draining.store(false, std::memory_order_relaxed);
+    drain.join();
+    for (int fd : read_fds)
+        ::close(fd);
+
+    for (unsigned i = 0; i < device_count; ++i) {
+        const auto s = manager.stats(i);
+        result.totals.frames += s.frames;
+        result.totals.events += s.events;
+        result.totals.failed_frames += s.failed_frames;
+        result.totals.coalesced += s.coalesced;
+    }
+    result.latencies = std::move(observer.samples);
+    return result;
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(pipeline, "input-to-event latency through the controller pipeline")
+{
+    const std::vector<unsigned> rates = options.quick ? std::vector<unsigned>{125, 1000, 8000}
+                                                      : std::vector<unsigned>{125, 250, 500, 1000, 2000, 4000, 8000};
+    const std::vector<unsigned> device_counts = options.quick ? std::vector<unsigned>{1, 16}
+                                                              : std::vector<unsigned>{1, 4, 16};
+
+    for (unsigned devices : device_counts) {
+        for (unsigned rate : rates) {
+            Result r = run_pipeline(rate, devices, options.duration_ms);
+            const double seconds = static_cast<double>(options.duration_ms) / 1000.0;
+            const std::string name = std::to_string(rate) + "hz_x" + std::to_string(devices);
+            reporter.add(bench::Record("pipeline", name.c_str())
+                             .field("rate_hz", rate)
+                             .field("devices", devices)
+                             .field("produced", r.produced)
+                             .field("frames", r.totals.frames)
+                             .field("coalesced", r.totals.coalesced)
+                             .field("failed_frames", r.totals.failed_frames)
+                             .field("events", r.totals.events)
+                             .field("events_per_sec", static_cast<double>(r.totals.events) / seconds)
+                             .latency(bench::percentiles(r.latencies)));
+        }
+    }
+}
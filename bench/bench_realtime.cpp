@@ -0,0 +1,84 @@
+// Real-time writer mode: producer-to-emit latency at 2 kHz through
+// ControllerManager with the default blocking wait, with spin-then-park, and
+// with everything on (pinning, SCHED_FIFO, mlockall and spinning). Reports
+// which real-time settings were actually granted, since without privileges
+// the manager quietly runs without them.
+
+#include "bench.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+constexpr std::uint64_t kPeriod = 500'000;
+
+struct LatencyObserver final : FrameObserver {
+    std::vector<std::uint64_t> samples;
+
+    void on_frame(unsigned, std::size_t, const JoystickState& state, std::size_t) noexcept override
+    {
+        if (samples.size() < samples.capacity())
+            samples.push_back(monotonic_ns() - state.timestamp_ns);
+    }
+};
+
+struct Mode {
+    const char* name;
+    RealtimeConfig realtime;
+    bool pin;
+};
+
+} // namespace
+
+VJC_BENCH_SUITE(realtime, "writer latency with blocking waits, spin-then-park and full real-time mode")
+{
+    const Mode modes[] = {
+        {"blocking", {}, false},
+        {"spin", {0, false, 2 * kPeriod}, false},
+        {"realtime", {50, true, 2 * kPeriod}, true},
+    };
+    const std::size_t frames = options.duration_ms * 1'000'000 / kPeriod;
+    for (const Mode& mode : modes) {
+        ManagerConfig config;
+        config.realtime = mode.realtime;
+        if (mode.pin)
+            config.cpus.push_back(static_cast<int>(std::thread::hardware_concurrency() - 1));
+        ControllerManager manager(config);
+        manager.add_device(bench::null_device());
+        LatencyObserver observer;
+        observer.samples.reserve(frames);
+        manager.set_observer(&observer);
+        manager.start();
+
+        JoystickState state;
+        std::uint64_t deadline = monotonic_ns();
+        for (std::size_t i = 0; i < frames; ++i) {
+            deadline += kPeriod;
+            sleep_until_ns(deadline);
+            state.axes[0] = static_cast<std::int16_t>(i);
+            state.timestamp_ns = monotonic_ns();
+            manager.publish(0, state);
+        }
+        sleep_until_ns(deadline + 10'000'000);
+        manager.stop();
+
+        if (observer.samples.size() < frames * 9 / 10)
+            throw std::runtime_error(std::string("realtime: frames missing in ") + mode.name);
+        reporter.add(bench::Record("realtime", mode.name)
+                         .field("spin_us", static_cast<double>(mode.realtime.spin_ns) / 1e3)
+                         .field("pinned", manager.pinned())
+                         .field("fifo", manager.fifo())
+                         .field("memory_locked", manager.memory_locked() ? 1 : 0)
+                         .latency(bench::percentiles(observer.samples)));
+    }
+}
@@ -0,0 +1,197 @@
+// Profile hot reload: emit-path latency through ControllerManager while the
+// profile is swapped every millisecond, against the same load with no
+// reloads, and the per-frame cost of pinning the profile. Every emitted frame
+// must come entirely from one profile: its buttons and its curved axis are
+// checked against the version they identify.
+
+#include "bench.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/profile_store.hpp"
+
+#include <atomic>
+#include <bit>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+constexpr const char* kPresetNames[] = {"linear", "gamma15", "quadratic", "cubic", "expo50"};
+constexpr CurvePreset kPresets[] = {CurvePreset::Linear, CurvePreset::Gamma15, CurvePreset::Quadratic,
+                                    CurvePreset::Cubic, CurvePreset::Expo50};
+constexpr unsigned kShift = 31;       // b0 -> b(1 + k % 31), b1 -> b(32 + k % 31)
+constexpr unsigned kVariants = 31 * 5; // distinct (button, curve) pairs
+constexpr std::int16_t kAxis = 20000;
+
+/// Profile `k`: two tagged remaps, a curve on a0 and enough filler rules for
+/// the compile to be real work.
+std::string make_profile(unsigned k)
+{
+    const unsigned j = k % kShift;
+    std::string text;
+    text += "b0 -> b";
+    text += std::to_string(1 + j);
+    text += "\nb1 -> b";
+    text += std::to_string(1 + kShift + j);
+    text += "\ncurve a0 ";
+    text += kPresetNames[k % 5];
+    text += '\n';
+    for (unsigned i = 2; i < 62; ++i) {
+        text += 'b';
+        text += std::to_string(i);
+        text += "+b63 -> b";
+        text += std::to_string(i);
+        text += '\n';
+    }
+    return text;
+}
+
+/// Records emit latency and checks that each frame matches one profile.
+struct ReloadObserver final : FrameObserver {
+    std::vector<std::uint64_t> samples;
+    std::uint64_t mixed = 0;
+    std::uint64_t switches = 0;
+    int last = -1;
+
+    void on_frame(unsigned, std::size_t, const JoystickState& state, std::size_t) noexcept override
+    {
+        if (samples.size() < samples.capacity())
+            samples.push_back(monotonic_ns() - state.timestamp_ns);
+        const std::uint64_t low = state.buttons & ((std::uint64_t{1} << (1 + kShift)) - 1);
+        const unsigned j = static_cast<unsigned>(std::countr_zero(low)) - 1;
+        int variant = -1;
+        if (std::popcount(low) == 1 && j < kShift && state.buttons == (low | low << kShift)) {
+            for (unsigned k = j; k < kVariants; k += kShift)
+                if (ResponseCurve::preset(kPresets[k % 5]).apply(kAxis) == state.axes[0])
+                    variant = static_cast<int>(k);
+        }
+        if (variant < 0)
+            ++mixed;
+        else if (variant != last)
+            ++switches;
+        last = variant;
+    }
+};
+
+struct Result {
+    std::vector<std::uint64_t> latencies;
+    std::uint64_t reloads = 0;
+    std::uint64_t switches = 0;
+    std::uint64_t mixed = 0;
+    std::uint64_t failed = 0;
+};
+
+Result run(bool reloading, std::uint64_t duration_ms)
+{
+    constexpr unsigned kRateHz = 2000;
+    ManagerConfig config;
+    config.ring_mode = RingMode::Queue;
+    ControllerManager manager(config);
+    manager.add_device(bench::null_device());
+    ProfileStore store(1, manager.writer_count());
+    store.load(make_profile(0));
+    manager.attach_profile(0, &store);
+
+    ReloadObserver observer;
+    observer.samples.reserve(kRateHz * duration_ms / 1000 * 5 / 4 + 1024);
+    manager.set_observer(&observer);
+    manager.start();
+
+    std::atomic<bool> running{true};
+    Result result;
+    std::thread reloader;
+    if (reloading) {
+        reloader = std::thread([&] {
+            std::uint64_t deadline = monotonic_ns();
+            for (unsigned k = 1; running.load(std::memory_order_relaxed); ++k) {
+                deadline += 1'000'000;
+                sleep_until_ns(deadline);
+                store.load_async(make_profile(k));
+                ++result.reloads;
+            }
+        });
+    }
+
+    const std::uint64_t period = 1'000'000'000ull / kRateHz;
+    const std::uint64_t end = monotonic_ns() + duration_ms * 1'000'000ull;
+    std::int16_t motion = 0;
+    for (std::uint64_t deadline = monotonic_ns(); deadline < end; deadline += period) {
+        sleep_until_ns(deadline);
+        JoystickState* s = manager.claim(0);
+        if (!s)
+            continue;
+        *s = JoystickState{};
+        s->buttons = 0b11;
+        s->axes[0] = kAxis;
+        s->axes[1] = ++motion; // so every frame produces events
+        s->timestamp_ns = monotonic_ns();
+        manager.commit(0);
+    }
+
+    running.store(false, std::memory_order_relaxed);
+    if (reloader.joinable())
+        reloader.join();
+    store.flush();
+    manager.stop();
+
+    result.latencies = std::move(observer.samples);
+    result.switches = observer.switches;
+    result.mixed = observer.mixed;
+    result.failed = store.failed_loads();
+    return result;
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(reload, "emit latency under profile hot reload and per-frame pin cost")
+{
+    for (bool reloading : {false, true}) {
+        Result r = run(reloading, options.duration_ms);
+        if (r.mixed != 0)
+            throw std::runtime_error("reload: " + std::to_string(r.mixed) + " frames mixed two profiles");
+        if (r.failed != 0)
+            throw std::runtime_error("reload: profile failed to load");
+        const double seconds = static_cast<double>(options.duration_ms) / 1000.0;
+        reporter.add(bench::Record("reload", reloading ? "reloading" : "steady")
+                         .field("reloads_per_sec", static_cast<double>(r.reloads) / seconds)
+                         .field("profile_switches", r.switches)
+                         .latency(bench::percentiles(r.latencies)));
+    }
+
+    // Cost of pinning the profile around each frame versus calling the
+    // compiled mapping and curves directly.
+    ProfileStore store(1, 1);
+    store.load(make_profile(7));
+    const Profile direct = Profile::parse(make_profile(7), 1, 1);
+    const std::size_t frames = options.quick ? 200'000 : 2'000'000;
+    JoystickState in;
+    in.buttons = 0b11;
+    in.axes[0] = kAxis;
+    JoystickState out;
+
+    std::uint64_t t0 = monotonic_ns();
+    for (std::size_t i = 0; i < frames; ++i) {
+        in.sequence = static_cast<std::uint32_t>(i);
+        direct.apply(0, in, out);
+        bench::do_not_optimize(out);
+    }
+    const std::uint64_t direct_ns = monotonic_ns() - t0;
+
+    t0 = monotonic_ns();
+    for (std::size_t i = 0; i < frames; ++i) {
+        in.sequence = static_cast<std::uint32_t>(i);
+        const auto profile = store.read(0);
+        profile->apply(0, in, out);
+        bench::do_not_optimize(out);
+    }
+    const std::uint64_t pinned_ns = monotonic_ns() - t0;
+
+    reporter.add(bench::Record("reload", "pin")
+                     .field("direct_ns_per_frame", static_cast<double>(direct_ns) / static_cast<double>(frames))
+                     .field("pinned_ns_per_frame", static_cast<double>(pinned_ns) / static_cast<double>(frames)));
+}
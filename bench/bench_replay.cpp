@@ -0,0 +1,105 @@
+// Session recording cost on the hot path, log size per frame, and replay
+// timing accuracy into /dev/null devices. The log round trip is checked
+// against the synthetic source.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/session_log.hpp"
+#include "vjc/session_replayer.hpp"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+constexpr std::size_t kDevices = 4;
+
+} // namespace
+
+VJC_BENCH_SUITE(replay, "session log recording overhead and replay timing accuracy")
+{
+    const std::string path = (std::filesystem::temp_directory_path() / ("vjc_bench_" + std::to_string(::getpid()) + ".log")).string();
+    const bench::SyntheticInput input;
+
+    // Recording: states spaced 1 ms apart per device, round-robin over devices.
+    const std::uint64_t frames = options.quick ? 200'000 : 2'000'000;
+    std::uint64_t record_ns = 0;
+    std::uint64_t bytes = 0;
+    {
+        SessionRecorder recorder(path, kDevices);
+        JoystickState state;
+        const std::uint64_t t0 = monotonic_ns();
+        for (std::uint64_t f = 0; f < frames; ++f) {
+            input.fill(f, state);
+            recorder.record(f % kDevices, state, f * (1'000'000 / kDevices));
+        }
+        record_ns = monotonic_ns() - t0;
+        bytes = recorder.bytes();
+    }
+
+    {
+        SessionReader reader(path);
+        SessionFrame frame;
+        JoystickState expected;
+        std::uint64_t read = 0;
+        const std::uint64_t t0 = monotonic_ns();
+        while (reader.next(frame)) {
+            input.fill(read, expected);
+            if (frame.device != read % kDevices || frame.time_ns != read * (1'000'000 / kDevices)
+                || diff_fields(frame.state, expected) != 0)
+                throw std::runtime_error("replay: log round trip mismatch");
+            ++read;
+        }
+        const std::uint64_t read_ns = monotonic_ns() - t0;
+        if (read != frames)
+            throw std::runtime_error("replay: log lost frames");
+
+        reporter.add(bench::Record("replay", "log")
+                         .field("frames", frames)
+                         .field("bytes_per_frame", static_cast<double>(bytes) / static_cast<double>(frames))
+                         .field("record_ns_per_frame", static_cast<double>(record_ns) / static_cast<double>(frames))
+                         .field("read_ns_per_frame", static_cast<double>(read_ns) / static_cast<double>(frames)));
+    }
+
+    // Timed replay of the first duration_ms of the session.
+    {
+        const std::uint64_t replay_frames = options.duration_ms * kDevices;
+        {
+            SessionRecorder recorder(path, kDevices);
+            JoystickState state;
+            for (std::uint64_t f = 0; f < replay_frames; ++f) {
+                input.fill(f, state);
+                recorder.record(f % kDevices, state, f * (1'000'000 / kDevices));
+            }
+        }
+        std::vector<std::unique_ptr<VirtualJoystick>> devices;
+        std::vector<VirtualJoystick*> targets;
+        for (std::size_t d = 0; d < kDevices; ++d) {
+            devices.push_back(bench::null_device());
+            targets.push_back(devices.back().get());
+        }
+        SessionReader reader(path);
+        SessionReplayer replayer(reader, targets);
+        const std::uint64_t t0 = monotonic_ns();
+        const SessionReplayer::Stats stats = replayer.run();
+        const std::uint64_t elapsed = monotonic_ns() - t0;
+        if (stats.frames != replay_frames)
+            throw std::runtime_error("replay: replayed frame count mismatch");
+
+        reporter.add(bench::Record("replay", "timing")
+                         .field("frames", stats.frames)
+                         .field("session_ns", (replay_frames - 1) * (1'000'000 / kDevices))
+                         .field("elapsed_ns", elapsed)
+                         .field("mean_late_ns", static_cast<double>(stats.total_late_ns) / static_cast<double>(stats.frames))
+                         .field("max_late_ns", stats.max_late_ns));
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,118 @@
+// Output scheduler on a simulated clock: a 10 kHz source with random button
+// taps paced down to 1 kHz. Reports the frame reduction and fails if any
+// tap the source produced is missing from the emitted frames.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/output_scheduler.hpp"
+
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr std::uint64_t kSourcePeriodNs = 100'000; // 10 kHz
+constexpr std::uint64_t kOutputPeriodNs = 1'000'000; // 1 kHz
+constexpr unsigned kButtons = 11;
+
+/// Presses each button for 1..16 source frames, then leaves it up for at
+/// least two output periods so separate taps never share a tick.
+class TapSource {
+public:
+    std::uint64_t step(std::uint64_t buttons) noexcept
+    {
+        for (unsigned b = 0; b < kButtons; ++b) {
+            if (--countdown_[b] > 0)
+                continue;
+            const std::uint64_t bit = std::uint64_t{1} << b;
+            if (buttons & bit) {
+                buttons &= ~bit;
+                countdown_[b] = 2 * kOutputPeriodNs / kSourcePeriodNs + next() % 64;
+            } else {
+                buttons |= bit;
+                countdown_[b] = 1 + next() % 16;
+                ++taps_;
+            }
+        }
+        return buttons;
+    }
+
+    [[nodiscard]] std::uint64_t taps() const noexcept { return taps_; }
+
+private:
+    std::uint32_t next() noexcept
+    {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 17;
+        rng_ ^= rng_ << 5;
+        return rng_;
+    }
+
+    std::array<int, kButtons> countdown_{1, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31};
+    std::uint32_t rng_ = 0x9e3779b9u;
+    std::uint64_t taps_ = 0;
+};
+
+} // namespace
+
+VJC_BENCH_SUITE(scheduler, "output coalescing and rate limiting with tap preservation")
+{
+    using namespace vjc;
+
+    const std::uint64_t frames = options.quick ? 200'000 : 2'000'000;
+    const bench::SyntheticInput input;
+
+    for (const auto& [name, policy] : {std::pair{"passthrough", SchedulePolicy::Passthrough},
+                                       std::pair{"fixed_rate", SchedulePolicy::FixedRate},
+                                       std::pair{"adaptive", SchedulePolicy::Adaptive}}) {
+        OutputScheduler scheduler({policy, kOutputPeriodNs});
+        TapSource taps;
+        JoystickState state;
+        JoystickState out[OutputScheduler::kMaxFrames];
+        std::uint64_t emitted = 0;
+        std::uint64_t buttons = 0;
+        std::uint64_t last_buttons = 0;
+        std::uint64_t press_edges = 0;
+        std::uint64_t completed_taps = 0;
+
+        const std::uint64_t t0 = monotonic_ns();
+        for (std::uint64_t f = 0; f < frames; ++f) {
+            const std::uint64_t now = f * kSourcePeriodNs;
+            input.fill(f, state);
+            const std::uint64_t next = taps.step(buttons);
+            completed_taps += static_cast<std::uint64_t>(std::popcount(buttons & ~next));
+            buttons = next;
+            state.buttons = buttons;
+            scheduler.push(state);
+
+            const std::size_t n = scheduler.poll(now, out);
+            for (std::size_t i = 0; i < n; ++i) {
+                press_edges += static_cast<std::uint64_t>(std::popcount(out[i].buttons & ~last_buttons));
+                last_buttons = out[i].buttons;
+            }
+            emitted += n;
+        }
+        const std::uint64_t t1 = monotonic_ns();
+        bench::do_not_optimize(last_buttons);
+
+        // Every completed tap shows up as exactly one press edge; a tap still
+        // held at the end may or may not have been emitted yet.
+        const std::uint64_t held = static_cast<std::uint64_t>(std::popcount(buttons));
+        if (press_edges < completed_taps || press_edges > completed_taps + held)
+            throw std::runtime_error(std::string("scheduler: ") + name + " saw " + std::to_string(press_edges) +
+                                     " presses for " + std::to_string(completed_taps) + " taps");
+
+        reporter.add(bench::Record("scheduler", name)
+                         .field("input_frames", frames)
+                         .field("output_frames", emitted)
+                         .field("reduction", static_cast<double>(frames) / static_cast<double>(emitted))
+                         .field("taps", completed_taps)
+                         .field("press_edges", press_edges)
+                         .field("edge_frames", scheduler.edge_frames())
+                         .field("ns_per_input", static_cast<double>(t1 - t0) / static_cast<double>(frames)));
+    }
+}
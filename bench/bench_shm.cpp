@@ -0,0 +1,141 @@
+// Local injection: source-to-device latency of the shared-memory channel
+// against loopback UDP, with states paced at 1 kHz through ControllerManager
+// into /dev/null devices, and the sender-side cost of one update on each.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/shm_client.hpp"
+#include "vjc/shm_server.hpp"
+#include "vjc/udp_client.hpp"
+#include "vjc/udp_server.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+constexpr unsigned kRateHz = 1000;
+
+/// Matches each emitted frame to its send time through an index carried in
+/// the first two axes.
+struct SendObserver final : FrameObserver {
+    const std::vector<std::uint64_t>* sent = nullptr;
+    std::vector<std::uint64_t> samples;
+
+    void on_frame(unsigned, std::size_t, const JoystickState& state, std::size_t) noexcept override
+    {
+        const std::size_t i = static_cast<std::uint16_t>(state.axes[0]) | static_cast<std::size_t>(
+                                  static_cast<std::uint16_t>(state.axes[1])) << 16;
+        if (i < sent->size() && (*sent)[i] != 0 && samples.size() < samples.capacity())
+            samples.push_back(monotonic_ns() - (*sent)[i]);
+    }
+};
+
+/// Sends `count` paced states through `send` and returns the latencies.
+template <typename Send>
+std::vector<std::uint64_t> run_paced(ControllerManager& manager, std::size_t count, Send send)
+{
+    std::vector<std::uint64_t> sent(count, 0);
+    SendObserver observer;
+    observer.sent = &sent;
+    observer.samples.reserve(count);
+    manager.set_observer(&observer);
+    manager.start();
+
+    const std::uint64_t period = 1'000'000'000ull / kRateHz;
+    std::uint64_t deadline = monotonic_ns();
+    for (std::size_t i = 1; i < count; ++i) {
+        deadline += period;
+        sleep_until_ns(deadline);
+        JoystickState state;
+        state.axes[0] = static_cast<std::int16_t>(i & 0xffff);
+        state.axes[1] = static_cast<std::int16_t>(i >> 16);
+        sent[i] = monotonic_ns();
+        send(state);
+    }
+    sleep_until_ns(monotonic_ns() + 20'000'000);
+    manager.stop();
+    return std::move(observer.samples);
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(shm, "shared-memory vs UDP local injection latency and sender cost")
+{
+    const std::size_t count = kRateHz * options.duration_ms / 1000 + 1;
+
+    {
+        ControllerManager manager;
+        manager.add_device(bench::null_device());
+        UdpServerConfig config;
+        config.address = "127.0.0.1";
+        UdpServer server(manager, config);
+        UdpClient client("127.0.0.1", server.port());
+        server.start();
+        std::vector<std::uint64_t> latencies
+            = run_paced(manager, count, [&](const JoystickState& s) { client.send(0, s); });
+        server.stop();
+        reporter.add(bench::Record("shm", "udp_latency").latency(bench::percentiles(latencies)));
+    }
+    {
+        ControllerManager manager;
+        manager.add_device(bench::null_device());
+        ShmServer server(manager);
+        ShmClient client(server.fd());
+        server.start();
+        std::vector<std::uint64_t> latencies
+            = run_paced(manager, count, [&](const JoystickState& s) { client.send(0, s); });
+        server.stop();
+        if (latencies.size() < count * 9 / 10)
+            throw std::runtime_error("shm: only " + std::to_string(latencies.size()) + " of "
+                                     + std::to_string(count) + " states arrived");
+        reporter.add(bench::Record("shm", "shm_latency")
+                         .field("torn", server.stats().torn)
+                         .latency(bench::percentiles(latencies)));
+    }
+
+    // Sender cost with nobody waiting: the shm update never enters the
+    // kernel, the UDP one is a sendto() per state.
+    const std::size_t sends = options.quick ? 100'000 : 1'000'000;
+    const bench::SyntheticInput input;
+    JoystickState state;
+    {
+        ControllerManager manager;
+        manager.add_device(bench::null_device());
+        ShmServer server(manager);
+        ShmClient client(server.fd());
+        const std::uint64_t t0 = monotonic_ns();
+        for (std::size_t i = 0; i < sends; ++i) {
+            input.fill(i, state);
+            client.send(0, state);
+        }
+        const std::uint64_t elapsed = monotonic_ns() - t0;
+        // The last state must be readable and intact.
+        if (server.drain() != 1)
+            throw std::runtime_error("shm: pending update not delivered");
+        reporter.add(bench::Record("shm", "shm_send")
+                         .field("ns_per_send", static_cast<double>(elapsed) / static_cast<double>(sends)));
+    }
+    {
+        ControllerManager manager;
+        manager.add_device(bench::null_device());
+        UdpServerConfig config;
+        config.address = "127.0.0.1";
+        UdpServer server(manager, config);
+        UdpClient client("127.0.0.1", server.port());
+        const std::uint64_t t0 = monotonic_ns();
+        for (std::size_t i = 0; i < sends; ++i) {
+            input.fill(i, state);
+            client.send(0, state);
+        }
+        const std::uint64_t elapsed = monotonic_ns() - t0;
+        reporter.add(bench::Record("shm", "udp_send")
+                         .field("ns_per_send", static_cast<double>(elapsed) / static_cast<double>(sends)));
+    }
+}
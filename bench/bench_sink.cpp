@@ -0,0 +1,294 @@
+// Events per second through the real emit path into the in-process evdev
+// sink, read back the way a game reads /dev/input/eventN: one thread
+// submitting and reading frame by frame, then ControllerManager writers
+// with a separate reader thread. Fails unless the reader's view of every
+// device matches the state that was submitted, and unless the sink's
+// duplicate, fuzz, framing and overflow rules match evdev.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/evdev_sink.hpp"
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+constexpr std::size_t kReadEvents = 256;
+
+/// What a game tracks from the event stream, resynced with EVIOCGABS and
+/// EVIOCGKEY after SYN_DROPPED as libevdev does.
+struct GameView {
+    std::array<std::int32_t, ABS_CNT> abs{};
+    std::bitset<KEY_CNT> keys;
+    bool dropped = false;
+    std::uint64_t events = 0;
+    std::uint64_t packets = 0;
+    std::uint64_t resyncs = 0;
+
+    void apply(const EvdevSink& sink, const input_event* events_in, std::size_t count)
+    {
+        events += count;
+        for (std::size_t i = 0; i < count; ++i) {
+            const input_event& e = events_in[i];
+            if (e.type == EV_SYN && e.code == SYN_DROPPED) {
+                dropped = true;
+            } else if (e.type == EV_SYN && e.code == SYN_REPORT) {
+                ++packets;
+                if (dropped) {
+                    dropped = false;
+                    ++resyncs;
+                    for (unsigned c = 0; c < ABS_CNT; ++c)
+                        abs[c] = sink.abs_value(static_cast<std::uint16_t>(c));
+                    for (unsigned c = 0; c < KEY_CNT; ++c)
+                        keys.set(c, sink.key_down(static_cast<std::uint16_t>(c)));
+                }
+            } else if (!dropped && e.type == EV_ABS) {
+                abs[e.code] = e.value;
+            } else if (!dropped && e.type == EV_KEY) {
+                keys.set(e.code, e.value != 0);
+            }
+        }
+    }
+
+    std::size_t drain(EvdevSink& sink)
+    {
+        input_event buffer[kReadEvents];
+        std::size_t total = 0;
+        while (const std::size_t n = sink.read(buffer, kReadEvents)) {
+            apply(sink, buffer, n);
+            total += n;
+        }
+        return total;
+    }
+
+    [[nodiscard]] bool matches(const DeviceDescriptor& d, const JoystickState& s) const
+    {
+        for (std::size_t a = 0; a < d.axes.size(); ++a)
+            if (abs[d.axes[a].code] != s.axes[a])
+                return false;
+        for (std::size_t t = 0; t < d.triggers.size(); ++t)
+            if (abs[d.triggers[t].code] != s.triggers[t])
+                return false;
+        for (std::size_t h = 0; h < 2 * d.hat_count; ++h)
+            if (abs[ABS_HAT0X + h] != s.hats[h])
+                return false;
+        for (std::size_t b = 0; b < d.buttons.size(); ++b)
+            if (keys.test(d.buttons[b]) != s.button(static_cast<unsigned>(b)))
+                return false;
+        return true;
+    }
+};
+
+/// The gamepad without stick fuzz, so a game sees exactly what was sent.
+DeviceDescriptor exact_gamepad()
+{
+    DeviceDescriptor d = DeviceDescriptor::gamepad();
+    for (auto& a : d.axes)
+        a.fuzz = 0;
+    return d;
+}
+
+void fail(const char* what)
+{
+    throw std::runtime_error(std::string("sink: ") + what);
+}
+
+input_event event(std::uint16_t type, std::uint16_t code, std::int32_t value)
+{
+    input_event e{};
+    e.type = type;
+    e.code = code;
+    e.value = value;
+    return e;
+}
+
+void write(EvdevSink& sink, std::initializer_list<input_event> events)
+{
+    sink.write_events(events.begin(), events.size());
+}
+
+std::size_t write_and_read(EvdevSink& sink, std::initializer_list<input_event> events, input_event* out)
+{
+    write(sink, events);
+    return sink.read(out, kReadEvents);
+}
+
+/// Hand-written streams against what the input core and evdev would do.
+void check_semantics()
+{
+    EvdevSink sink;
+    sink.create(DeviceDescriptor::gamepad()); // sticks have fuzz 16
+    input_event out[kReadEvents];
+
+    // Nothing is readable before SYN_REPORT; then the whole packet is.
+    write(sink, {event(EV_ABS, ABS_Z, 100), event(EV_KEY, BTN_SOUTH, 1)});
+    if (sink.read(out, kReadEvents) != 0)
+        fail("events readable before SYN_REPORT");
+    if (write_and_read(sink, {event(EV_SYN, SYN_REPORT, 0)}, out) != 3 || out[2].code != SYN_REPORT)
+        fail("packet not delivered on SYN_REPORT");
+
+    // Repeats, unknown codes and the report of the then empty packet vanish;
+    // key repeats pass.
+    if (write_and_read(sink,
+                       {event(EV_ABS, ABS_Z, 100), event(EV_KEY, BTN_SOUTH, 1), event(EV_KEY, KEY_A, 1),
+                        event(EV_ABS, ABS_MT_SLOT, 1), event(EV_REL, REL_X, 1), event(EV_SYN, SYN_REPORT, 0)},
+                       out)
+        != 0)
+        fail("duplicate or unsupported events delivered");
+    if (write_and_read(sink, {event(EV_KEY, BTN_SOUTH, 2), event(EV_SYN, SYN_REPORT, 0)}, out) != 2
+        || out[0].value != 2)
+        fail("key repeat dropped");
+
+    // Stick fuzz: within 8 of the last value is noise, within 16 it is
+    // averaged 3:1, within 32 averaged 1:1.
+    const std::int32_t steps[][2] = {{5, 0}, {12, 3}, {30, 16}, {200, 200}};
+    for (const auto& step : steps) {
+        write(sink, {event(EV_ABS, ABS_X, step[0]), event(EV_SYN, SYN_REPORT, 0)});
+        sink.read(out, kReadEvents);
+        if (sink.abs_value(ABS_X) != step[1])
+            fail("fuzz filter differs from the input core");
+    }
+
+    // Overflow: everything unread is replaced by SYN_DROPPED plus the newest
+    // event, readable from the next SYN_REPORT.
+    if (sink.capacity() != 128)
+        fail("queue not sized like evdev");
+    for (std::int32_t v = 1; v <= 100; ++v)
+        write(sink, {event(EV_ABS, ABS_Z, 1000 + v), event(EV_ABS, ABS_RZ, 1000 + v), event(EV_SYN, SYN_REPORT, 0)});
+    const std::size_t n = sink.read(out, kReadEvents);
+    if (sink.stats().dropped == 0 || n < 2 || out[0].type != EV_SYN || out[0].code != SYN_DROPPED
+        || out[n - 1].code != SYN_REPORT)
+        fail("overflow does not end in SYN_DROPPED and a complete packet");
+    if (sink.abs_value(ABS_Z) != 1100 || sink.abs_value(ABS_RZ) != 1100)
+        fail("device state lost on overflow");
+}
+
+/// One thread: submit a frame, read what a game would, compare.
+void run_inline(const bench::Options& options, bench::Reporter& reporter)
+{
+    const DeviceDescriptor descriptor = exact_gamepad();
+    auto owned = std::make_unique<EvdevSink>();
+    EvdevSink& sink = *owned;
+    VirtualJoystick joystick(std::move(owned), descriptor);
+    const bench::SyntheticInput input(3);
+    GameView view;
+
+    JoystickState state;
+    std::uint64_t frames = 0;
+    const std::uint64_t t0 = monotonic_ns();
+    const std::uint64_t end = t0 + options.duration_ms * 1'000'000u;
+    do {
+        for (int i = 0; i < 1024; ++i, ++frames) {
+            input.fill(frames, state);
+            joystick.submit(state);
+            view.drain(sink);
+            if (!view.matches(descriptor, state))
+                fail("inline reader disagrees with the submitted state");
+        }
+    } while (monotonic_ns() < end);
+    const double seconds = static_cast<double>(monotonic_ns() - t0) / 1e9;
+
+    const EvdevSink::Stats stats = sink.stats();
+    if (stats.dropped != 0 || view.resyncs != 0)
+        fail("inline run overflowed");
+    reporter.add(bench::Record("sink", "inline")
+                     .field("frames", frames)
+                     .field("events_per_frame", static_cast<double>(view.events) / static_cast<double>(frames))
+                     .field("events_per_sec", static_cast<double>(view.events) / seconds)
+                     .field("ns_per_frame", seconds * 1e9 / static_cast<double>(frames)));
+}
+
+/// ControllerManager writers into sinks, drained by a reader thread that
+/// runs concurrently, as a game polling its devices would.
+void run_managed(std::size_t devices, const bench::Options& options, bench::Reporter& reporter)
+{
+    const DeviceDescriptor descriptor = exact_gamepad();
+    ControllerManager manager;
+    std::vector<EvdevSink*> sinks;
+    for (std::size_t d = 0; d < devices; ++d) {
+        auto sink = std::make_unique<EvdevSink>();
+        sinks.push_back(sink.get());
+        manager.add_device(std::make_unique<VirtualJoystick>(std::move(sink), descriptor));
+    }
+    std::vector<GameView> views(devices);
+    manager.start();
+
+    std::atomic<bool> producing{true};
+    std::atomic<bool> reading{true};
+    std::vector<JoystickState> last(devices);
+    std::thread producer([&] {
+        const bench::SyntheticInput input(5);
+        for (std::uint64_t frame = 0; producing.load(std::memory_order_relaxed); ++frame)
+            for (std::size_t d = 0; d < devices; ++d) {
+                input.fill(frame + d * 17, last[d]);
+                manager.publish(d, last[d]);
+            }
+    });
+    std::thread reader([&] {
+        while (reading.load(std::memory_order_relaxed)) {
+            std::size_t read = 0;
+            for (std::size_t d = 0; d < devices; ++d)
+                read += views[d].drain(*sinks[d]);
+            if (read == 0)
+                std::this_thread::yield();
+        }
+    });
+
+    const std::uint64_t t0 = monotonic_ns();
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.duration_ms));
+    producing.store(false, std::memory_order_relaxed);
+    producer.join();
+    manager.stop();
+    reading.store(false, std::memory_order_relaxed);
+    reader.join();
+    const double seconds = static_cast<double>(monotonic_ns() - t0) / 1e9;
+
+    std::uint64_t events = 0;
+    std::uint64_t packets = 0;
+    std::uint64_t resyncs = 0;
+    std::uint64_t dropped = 0;
+    for (std::size_t d = 0; d < devices; ++d) {
+        views[d].drain(*sinks[d]);
+        if (!views[d].matches(descriptor, last[d]))
+            fail("reader's final view differs from the last published state");
+        if (sinks[d]->stats().packets != manager.stats(d).frames)
+            fail("packet count differs from frames written");
+        events += views[d].events;
+        packets += views[d].packets;
+        resyncs += views[d].resyncs;
+        dropped += sinks[d]->stats().dropped;
+    }
+    const std::string name = "managed_x" + std::to_string(devices);
+    reporter.add(bench::Record("sink", name.c_str())
+                     .field("devices", static_cast<std::uint64_t>(devices))
+                     .field("events_per_sec", static_cast<double>(events) / seconds)
+                     .field("packets_per_sec", static_cast<double>(packets) / seconds)
+                     .field("syn_dropped", dropped)
+                     .field("resyncs", resyncs));
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(sink, "events/sec through the emit path into the in-process evdev sink, read back and checked")
+{
+    check_semantics();
+    run_inline(options, reporter);
+    const std::vector<std::size_t> device_counts = options.quick ? std::vector<std::size_t>{16}
+                                                                 : std::vector<std::size_t>{1, 16, 256};
+    for (std::size_t devices : device_counts)
+        run_managed(devices, options, reporter);
+}
@@ -0,0 +1,117 @@
+// Stage instrumentation: per-stage latency of a loopback UDP session as the
+// histograms see it, the cost of recording a sample, and the percentile
+// error of the bucket layout against exact order statistics.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/stage_stats.hpp"
+#include "vjc/udp_client.hpp"
+#include "vjc/udp_server.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+void run_session(std::size_t rounds)
+{
+    constexpr std::size_t kDevices = 4;
+    constexpr std::size_t kBurst = 64;
+
+    ControllerManager manager;
+    for (std::size_t d = 0; d < kDevices; ++d)
+        manager.add_device(bench::null_device());
+    UdpServerConfig config;
+    config.address = "127.0.0.1";
+    UdpServer server(manager, config);
+    UdpClient client("127.0.0.1", server.port());
+    manager.start();
+
+    const bench::SyntheticInput input;
+    JoystickState state;
+    std::uint64_t frame = 0;
+    for (std::size_t r = 0; r < rounds; ++r) {
+        for (std::size_t i = 0; i < kBurst; ++i, ++frame) {
+            input.fill(frame, state);
+            client.send(static_cast<std::uint16_t>(frame % kDevices), state);
+        }
+        server.drain();
+    }
+    manager.stop();
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(stats, "per-stage latency histograms and instrumentation cost")
+{
+    run_session(options.quick ? 100 : 1000);
+    const StatsSnapshot session = stage_snapshot();
+    for (std::size_t s = 0; s < kStageCount; ++s) {
+        const HistogramSnapshot& h = session.stages[s];
+        bench::Percentiles p;
+        p.p50 = h.percentile(0.5);
+        p.p99 = h.percentile(0.99);
+        p.p999 = h.percentile(0.999);
+        p.max = h.max_ns;
+        p.count = h.count;
+        reporter.add(bench::Record("stats", to_string(static_cast<Stage>(s)))
+                         .field("enabled", VJC_STATS)
+                         .field("mean_ns", h.mean())
+                         .latency(p));
+    }
+
+    // Percentile accuracy on a long-tailed distribution.
+    std::vector<std::uint64_t> samples;
+    HistogramSnapshot histogram;
+    std::uint64_t x = 88172645463325252ull;
+    for (int i = 0; i < 100'000; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        const std::uint64_t v = 100 + (x % 1000) * (x % 1000) * ((x >> 40) % 50 == 0 ? 100 : 1);
+        samples.push_back(v);
+        ++histogram.buckets[HistogramLayout::index(v)];
+        ++histogram.count;
+        histogram.max_ns = std::max(histogram.max_ns, v);
+    }
+    std::sort(samples.begin(), samples.end());
+    double worst_error = 0;
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        const auto rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(samples.size()))) - 1;
+        const double exact = static_cast<double>(samples[rank]);
+        worst_error = std::max(worst_error, std::fabs(static_cast<double>(histogram.percentile(q)) - exact) / exact);
+    }
+    if (worst_error > 1.0 / HistogramLayout::kSubBuckets)
+        throw std::runtime_error("stats: histogram percentile error above bucket resolution");
+
+    // Cost of one sample, and of a timed scope including its two clock reads.
+    const std::uint64_t iterations = options.quick ? 1'000'000 : 10'000'000;
+    std::uint64_t t0 = monotonic_ns();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        record_stage(Stage::Shape, i & 0xffff);
+    const std::uint64_t record_ns = monotonic_ns() - t0;
+    t0 = monotonic_ns();
+    for (std::uint64_t i = 0; i < iterations; ++i) {
+        const StageTimer timer(Stage::Shape);
+        bench::do_not_optimize(i);
+    }
+    const std::uint64_t timer_ns = monotonic_ns() - t0;
+    t0 = monotonic_ns();
+    const StatsSnapshot snapshot = stage_snapshot();
+    const std::uint64_t snapshot_ns = monotonic_ns() - t0;
+    bench::do_not_optimize(snapshot.stages[0].count);
+
+    reporter.add(bench::Record("stats", "cost")
+                     .field("enabled", VJC_STATS)
+                     .field("record_ns", static_cast<double>(record_ns) / static_cast<double>(iterations))
+                     .field("timer_ns", static_cast<double>(timer_ns) / static_cast<double>(iterations))
+                     .field("snapshot_us", static_cast<double>(snapshot_ns) / 1e3)
+                     .field("percentile_max_rel_error", worst_error));
+}
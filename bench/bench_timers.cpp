@@ -0,0 +1,141 @@
+// Timer wheel and button sequencer: schedule/cancel cost as the number of
+// armed timers grows, transition accuracy of thousands of turbo patterns on
+// a fake clock, and wakeup lateness of periodic timers on the real clock.
+// The fake-clock run fails if any transition is later than its jitter bound
+// or a pattern drifts.
+
+#include "bench.hpp"
+
+#include "vjc/button_sequencer.hpp"
+#include "vjc/clock.hpp"
+#include "vjc/timer_wheel.hpp"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+constexpr std::uint64_t kTick = 100'000;
+
+/// ns per schedule() + cancel() pair with `armed` other timers in the wheel.
+double schedule_cancel_ns(std::size_t armed, std::size_t ops)
+{
+    std::mt19937_64 rng(armed);
+    std::uint64_t now = 1'000'000'000;
+    TimerWheel wheel(armed + 1, kTick, now);
+    for (std::size_t i = 0; i < armed; ++i)
+        wheel.schedule(now + rng() % 60'000'000'000ull, i);
+    std::vector<std::uint64_t> deadlines(1024);
+    for (std::uint64_t& d : deadlines)
+        d = now + rng() % 60'000'000'000ull;
+
+    const std::uint64_t t0 = monotonic_ns();
+    for (std::size_t i = 0; i < ops; ++i) {
+        const TimerId id = wheel.schedule(deadlines[i & 1023], i);
+        bench::do_not_optimize(id);
+        wheel.cancel(id);
+    }
+    return static_cast<double>(monotonic_ns() - t0) / static_cast<double>(ops);
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(timers, "timer wheel cost, fake-clock jitter bounds and real-clock lateness")
+{
+    const std::size_t ops = options.quick ? 200'000 : 2'000'000;
+    for (std::size_t armed : {1'000u, 10'000u, 100'000u}) {
+        reporter.add(bench::Record("timers", "schedule_cancel")
+                         .field("armed", static_cast<std::uint64_t>(armed))
+                         .field("ns_per_pair", schedule_cancel_ns(armed, ops)));
+    }
+
+    // Fake clock: 256 devices with 16 turbos each, advanced in random steps
+    // of up to 2.5 ticks. A transition may be late by at most one tick plus
+    // the step, and every pattern must flip exactly once per half period.
+    {
+        constexpr std::size_t kDevices = 256;
+        constexpr std::size_t kPerDevice = 16;
+        constexpr std::uint64_t kMaxStep = 5 * kTick / 2;
+        std::mt19937_64 rng(15);
+        const std::uint64_t start = 1'000'000'000;
+        ButtonSequencer sequencer(kDevices, kDevices * kPerDevice, kTick, start);
+        std::vector<std::uint64_t> halves;
+        for (std::size_t d = 0; d < kDevices; ++d)
+            for (std::size_t b = 0; b < kPerDevice; ++b) {
+                const std::uint64_t period = 2'000'000 + rng() % 48'000'000;
+                if (sequencer.turbo(d, std::uint64_t{1} << b, period, start) == kNoSequence)
+                    throw std::runtime_error("timers: pattern pool exhausted");
+                halves.push_back(period / 2);
+            }
+
+        const std::uint64_t simulated = (options.quick ? 2'000ull : 20'000ull) * 1'000'000;
+        std::uint64_t now = start;
+        std::uint64_t changed = 0;
+        std::size_t advances = 0;
+        const std::uint64_t t0 = monotonic_ns();
+        while (now < start + simulated) {
+            now += rng() % (kMaxStep + 1);
+            changed += sequencer.advance(now).size();
+            ++advances;
+        }
+        // Settle on a tick boundary so the expected count is exact.
+        now = (now / kTick + 1) * kTick;
+        changed += sequencer.advance(now).size();
+        ++advances;
+        const std::uint64_t elapsed = monotonic_ns() - t0;
+
+        std::uint64_t expected = 0;
+        for (std::uint64_t half : halves)
+            expected += (now - start) / half;
+        const ButtonSequencer::Stats& stats = sequencer.stats();
+        if (stats.max_late_ns > kTick + kMaxStep)
+            throw std::runtime_error("timers: transition " + std::to_string(stats.max_late_ns) + " ns late");
+        if (stats.transitions != expected)
+            throw std::runtime_error("timers: " + std::to_string(stats.transitions) + " transitions, expected "
+                                     + std::to_string(expected));
+        reporter.add(bench::Record("timers", "fake_clock")
+                         .field("patterns", static_cast<std::uint64_t>(halves.size()))
+                         .field("transitions", stats.transitions)
+                         .field("max_late_ns", stats.max_late_ns)
+                         .field("bound_ns", kTick + kMaxStep)
+                         .field("overlay_changes", changed)
+                         .field("ns_per_transition",
+                                static_cast<double>(elapsed) / static_cast<double>(stats.transitions))
+                         .field("advances", static_cast<std::uint64_t>(advances)));
+    }
+
+    // Real clock: 4096 periodic timers, the thread sleeping until the wheel's
+    // next deadline as a writer would.
+    {
+        constexpr std::size_t kTimers = 4096;
+        std::mt19937_64 rng(16);
+        std::uint64_t now = monotonic_ns();
+        TimerWheel wheel(kTimers, kTick, now);
+        std::vector<std::uint64_t> periods(kTimers);
+        for (std::size_t i = 0; i < kTimers; ++i) {
+            periods[i] = 1'000'000 + rng() % 19'000'000;
+            wheel.schedule(now + periods[i], i);
+        }
+        std::vector<std::uint64_t> late;
+        late.reserve(options.duration_ms * 4096);
+        const std::uint64_t end = now + options.duration_ms * 1'000'000;
+        while (now < end) {
+            sleep_until_ns(std::min(wheel.next_deadline(), end));
+            now = monotonic_ns();
+            wheel.advance(now, [&](TimerId, std::uint64_t i, std::uint64_t deadline) {
+                if (late.size() < late.capacity())
+                    late.push_back(now - deadline);
+                wheel.schedule(deadline + periods[i], i);
+            });
+        }
+        reporter.add(bench::Record("timers", "real_clock")
+                         .field("timers", static_cast<std::uint64_t>(kTimers))
+                         .field("tick_ns", kTick)
+                         .latency(bench::percentiles(late)));
+    }
+}
@@ -0,0 +1,156 @@
+// UDP receive path over loopback: a burst of datagrams is queued on the
+// socket, then drained by the server, comparing one datagram per syscall
+// (batch 1, the recvfrom() pattern) against recvmmsg() batches. Fails
+// unless a re-delivered keyframe leaves the device state alone and a new
+// client session restarts it.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/udp_client.hpp"
+#include "vjc/udp_server.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+using namespace vjc;
+
+/// Sends hand-made datagrams, so packets can be repeated and reordered.
+class RawSender {
+public:
+    explicit RawSender(std::uint16_t port)
+        : fd_(::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0))
+    {
+        if (fd_ < 0)
+            throw std::system_error(errno, std::system_category(), "socket");
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0) {
+            const int err = errno;
+            ::close(fd_);
+            throw std::system_error(err, std::system_category(), "connect");
+        }
+    }
+    ~RawSender() { ::close(fd_); }
+
+    void send(std::uint32_t session, std::uint32_t sequence, std::int16_t x, bool keyframe) const
+    {
+        PacketHeader header;
+        header.flags = keyframe ? kPacketKeyframe : 0;
+        header.sequence = sequence;
+        header.session = session;
+        JoystickState state;
+        state.axes[0] = x;
+        std::byte packet[kMaxPacketSize];
+        encode_packet_header(header, packet);
+        const std::size_t size
+            = kPacketHeaderSize + encode_fields(state, static_cast<std::uint16_t>(keyframe ? kAllFields : kFieldAxis0),
+                                                packet + kPacketHeaderSize);
+        if (::send(fd_, packet, size, 0) != static_cast<ssize_t>(size))
+            throw std::system_error(errno, std::system_category(), "send");
+    }
+
+private:
+    int fd_;
+};
+
+/// Value of axis 0 the server has taken for device 0 after `send` runs.
+std::int16_t delivered_x(ControllerManager& manager, UdpServer& server)
+{
+    server.drain();
+    manager.start(); // the writer emits what is pending before it sees stop()
+    manager.stop();
+    return manager.device(0).state().axes[0];
+}
+
+/// A keyframe that was reordered or duplicated is stale like any other old
+/// packet; only a packet of a new session restarts the stream.
+void check_sessions()
+{
+    ControllerManager manager;
+    manager.add_device(bench::null_device());
+    UdpServerConfig config;
+    config.address = "127.0.0.1";
+    UdpServer server(manager, config);
+    const RawSender sender(server.port());
+
+    sender.send(7, 1, 100, true);
+    sender.send(7, 2, 200, false);
+    sender.send(7, 3, 300, false);
+    sender.send(7, 1, 100, true); // duplicated keyframe
+    sender.send(7, 2, 200, false);
+    if (delivered_x(manager, server) != 300 || server.stats().stale != 2 || server.stats().restarts != 0)
+        throw std::runtime_error("udp: an old keyframe rolled the device state back");
+
+    sender.send(9, 1, -100, true); // the client restarted
+    sender.send(7, 4, 400, false); // late packet of the old run
+    if (delivered_x(manager, server) != -100 || server.stats().stale != 3 || server.stats().restarts != 1)
+        throw std::runtime_error("udp: a new client session was not taken as a restart");
+}
+
+} // namespace
+
+VJC_BENCH_SUITE(udp, "loopback UDP receive cost, single vs recvmmsg batches")
+{
+    check_sessions();
+
+    constexpr std::size_t kDevices = 16;
+    constexpr std::size_t kBurst = 256;
+    const std::size_t rounds = options.quick ? 40 : 400;
+
+    for (unsigned batch : {1u, 8u, 64u}) {
+        ControllerManager manager;
+        for (std::size_t d = 0; d < kDevices; ++d)
+            manager.add_device(bench::null_device());
+
+        UdpServerConfig config;
+        config.address = "127.0.0.1";
+        config.batch = batch;
+        config.receive_buffer = 4 << 20;
+        UdpServer server(manager, config);
+        UdpClient client("127.0.0.1", server.port());
+        const bench::SyntheticInput input;
+
+        std::uint64_t busy_ns = 0;
+        std::uint64_t received = 0;
+        std::uint64_t frame = 0;
+        JoystickState state;
+        for (std::size_t r = 0; r < rounds; ++r) {
+            for (std::size_t i = 0; i < kBurst; ++i, ++frame) {
+                input.fill(frame, state);
+                client.send(static_cast<std::uint16_t>(frame % kDevices), state);
+            }
+            const std::uint64_t t0 = monotonic_ns();
+            received += server.drain();
+            busy_ns += monotonic_ns() - t0;
+        }
+
+        const auto& stats = server.stats();
+        if (stats.invalid != 0 || received == 0)
+            throw std::runtime_error("udp: server rejected loopback traffic");
+
+        const std::string name = "batch" + std::to_string(batch);
+        reporter.add(bench::Record("udp", name.c_str())
+                         .field("batch", batch)
+                         .field("sent", frame)
+                         .field("received", received)
+                         .field("gaps", stats.gaps)
+                         .field("packets_per_syscall",
+                                static_cast<double>(stats.packets) / static_cast<double>(stats.batches))
+                         .field("ns_per_packet", static_cast<double>(busy_ns) / static_cast<double>(received))
+                         .field("packets_per_sec", static_cast<double>(received) * 1e9 / static_cast<double>(busy_ns)));
+    }
+}
@@ -0,0 +1,54 @@
+// Bytes per frame and encode/decode cost of the delta wire format against
+// full-state copies, on the same synthetic traffic as the pipeline suite.
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/wire_format.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+VJC_BENCH_SUITE(wire, "packed state size and delta encoding cost")
+{
+    using namespace vjc;
+
+    const std::size_t frames = options.quick ? 200'000 : 2'000'000;
+    const bench::SyntheticInput input;
+
+    std::vector<std::byte> stream(frames * kMaxWireStateSize);
+    DeltaEncoder encoder;
+    JoystickState state;
+    std::size_t bytes = 0;
+
+    const std::uint64_t t0 = monotonic_ns();
+    for (std::size_t f = 0; f < frames; ++f) {
+        input.fill(f, state);
+        bytes += encoder.encode(state, stream.data() + bytes);
+    }
+    const std::uint64_t t1 = monotonic_ns();
+
+    JoystickState decoded;
+    std::size_t offset = 0;
+    while (offset < bytes) {
+        const std::size_t n = decode_fields(stream.data() + offset, bytes - offset, decoded);
+        if (n == 0)
+            throw std::runtime_error("wire: decode failed");
+        offset += n;
+    }
+    const std::uint64_t t2 = monotonic_ns();
+    bench::do_not_optimize(decoded);
+
+    input.fill(frames - 1, state);
+    if (diff_fields(state, decoded) != 0)
+        throw std::runtime_error("wire: round trip mismatch");
+
+    reporter.add(bench::Record("wire", "delta")
+                     .field("frames", static_cast<std::uint64_t>(frames))
+                     .field("state_bytes", static_cast<std::uint64_t>(sizeof(JoystickState)))
+                     .field("full_wire_bytes", static_cast<std::uint64_t>(kMaxWireStateSize))
+                     .field("delta_bytes_per_frame", static_cast<double>(bytes) / static_cast<double>(frames))
+                     .field("encode_ns_per_frame", static_cast<double>(t1 - t0) / static_cast<double>(frames))
+                     .field("decode_ns_per_frame", static_cast<double>(t2 - t1) / static_cast<double>(frames)));
+}
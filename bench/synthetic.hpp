@@ -0,0 +1,44 @@
+#pragma once
+
+#include "vjc/joystick_state.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+namespace vjc::bench {
+
+/// Deterministic stick and button traffic: both sticks trace circles at
+/// different speeds, triggers ramp and one button changes every eight frames.
+class SyntheticInput {
+public:
+    explicit SyntheticInput(unsigned seed = 0) noexcept
+        : phase_(seed * 37u)
+    {
+        for (std::size_t i = 0; i < kSteps; ++i)
+            sine_[i] = static_cast<std::int16_t>(32767.0 * std::sin(2.0 * std::numbers::pi * static_cast<double>(i) / kSteps));
+    }
+
+    void fill(std::uint64_t frame, JoystickState& s) const noexcept
+    {
+        const std::uint64_t p = frame + phase_;
+        s.axes[0] = sine_[p % kSteps];
+        s.axes[1] = sine_[(p + kSteps / 4) % kSteps];
+        s.axes[2] = sine_[(3 * p) % kSteps];
+        s.axes[3] = sine_[(3 * p + kSteps / 4) % kSteps];
+        s.triggers[0] = static_cast<std::uint16_t>(p * 257u);
+        s.triggers[1] = static_cast<std::uint16_t>(65535u - p * 257u);
+        const unsigned button = static_cast<unsigned>((p / 8) % 11);
+        s.buttons = ((p / 8) & 1) ? (std::uint64_t{1} << button) : 0;
+        s.hats[0] = static_cast<std::int8_t>(static_cast<int>((p / 64) % 3) - 1);
+    }
+
+private:
+    static constexpr std::size_t kSteps = 256;
+
+    std::array<std::int16_t, kSteps> sine_{};
+    std::uint64_t phase_;
+};
+
+} // namespace vjc::bench
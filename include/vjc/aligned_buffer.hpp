@@ -0,0 +1,67 @@
+#pragma once
+
+#include "vjc/platform.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace vjc {
+
+/// Fixed-size, zero-initialised, cache-line-aligned array for SIMD blocks.
+template <typename T>
+class AlignedBuffer {
+    static_assert(std::is_trivial_v<T>);
+
+public:
+    AlignedBuffer() = default;
+
+    explicit AlignedBuffer(std::size_t size)
+        : data_(static_cast<T*>(::operator new(std::max<std::size_t>(size, 1) * sizeof(T),
+                                               std::align_val_t{kCacheLineSize})))
+        , size_(size)
+    {
+        std::fill_n(data_, size_, T{});
+    }
+
+    ~AlignedBuffer() { release(); }
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    [[nodiscard]] T* data() noexcept { return data_; }
+    [[nodiscard]] const T* data() const noexcept { return data_; }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    T& operator[](std::size_t i) noexcept { return data_[i]; }
+    const T& operator[](std::size_t i) const noexcept { return data_[i]; }
+
+private:
+    void release() noexcept
+    {
+        if (data_)
+            ::operator delete(data_, std::align_val_t{kCacheLineSize});
+    }
+
+    T* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace vjc
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+namespace vjc {
+
+/// Counts heap allocations made anywhere in the process while it lives.
+///
+/// Meant for checking that a pipeline stays off the heap once warmed up:
+/// start the threads, run some traffic, then hold a guard over the steady
+/// state. The counting comes from replacement global operator new/delete
+/// defined next to this class in the separate vjc_alloc_guard library, so a
+/// program gets them only when it links that library; the cost when
+/// disarmed is one relaxed load per allocation. Guards may nest.
+class AllocationGuard {
+public:
+    AllocationGuard() noexcept;
+    ~AllocationGuard();
+
+    AllocationGuard(const AllocationGuard&) = delete;
+    AllocationGuard& operator=(const AllocationGuard&) = delete;
+
+    /// Calls to operator new since construction, on any thread.
+    [[nodiscard]] std::uint64_t allocations() const noexcept;
+    /// Bytes they requested.
+    [[nodiscard]] std::uint64_t bytes() const noexcept;
+
+    /// Throws std::runtime_error naming `what` if anything was allocated.
+    void check(const char* what) const;
+
+private:
+    std::uint64_t allocations_ = 0;
+    std::uint64_t bytes_ = 0;
+};
+
+} // namespace vjc
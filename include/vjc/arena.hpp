@@ -0,0 +1,73 @@
+#pragma once
+
+#include "vjc/aligned_buffer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <type_traits>
+
+namespace vjc {
+
+/// Bump allocator over one cache-line-aligned block.
+///
+/// Allocating is a pointer bump and nothing is freed on its own; rewind()
+/// and reset() drop everything carved after a mark. A thread can carve its
+/// long-lived buffers at setup and use the rest as per-frame scratch that is
+/// reset each frame. Holds trivially destructible objects only. Not
+/// thread-safe: an arena belongs to the thread that uses it.
+class Arena {
+public:
+    Arena() = default;
+    explicit Arena(std::size_t bytes)
+        : block_(bytes)
+    {
+    }
+
+    /// `bytes` aligned to `align` (a power of two), or nullptr when the
+    /// block is exhausted.
+    [[nodiscard]] void* allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t)) noexcept
+    {
+        const auto base = reinterpret_cast<std::uintptr_t>(block_.data());
+        const std::size_t offset = ((base + used_ + align - 1) & ~(std::uintptr_t{align} - 1)) - base;
+        if (offset > block_.size() || bytes > block_.size() - offset)
+            return nullptr;
+        used_ = offset + bytes;
+        if (used_ > high_water_)
+            high_water_ = used_;
+        return block_.data() + offset;
+    }
+
+    /// `count` value-initialised objects. Throws std::bad_alloc when the
+    /// block is exhausted, so it is meant for setup rather than the hot path.
+    template <typename T>
+    [[nodiscard]] std::span<T> array(std::size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>);
+        void* p = count <= block_.size() / sizeof(T) ? allocate(count * sizeof(T), alignof(T)) : nullptr;
+        if (!p)
+            throw std::bad_alloc();
+        T* first = static_cast<T*>(p);
+        for (std::size_t i = 0; i < count; ++i)
+            ::new (static_cast<void*>(first + i)) T();
+        return {first, count};
+    }
+
+    /// Position to rewind() to later.
+    [[nodiscard]] std::size_t mark() const noexcept { return used_; }
+    void rewind(std::size_t mark) noexcept { used_ = mark < used_ ? mark : used_; }
+    void reset() noexcept { used_ = 0; }
+
+    [[nodiscard]] std::size_t used() const noexcept { return used_; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return block_.size(); }
+    /// Most bytes ever in use, for sizing the block.
+    [[nodiscard]] std::size_t high_water() const noexcept { return high_water_; }
+
+private:
+    AlignedBuffer<std::byte> block_;
+    std::size_t used_ = 0;
+    std::size_t high_water_ = 0;
+};
+
+} // namespace vjc
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "vjc/aligned_buffer.hpp"
+#include "vjc/cpu_features.hpp"
+#include "vjc/joystick_state.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc {
+
+/// Shaping of one axis, applied after the stick's radial deadzone.
+struct AxisCurve {
+    float deadzone = 0.0f; ///< axial deadzone, fraction of full scale in [0, 1)
+    float expo = 0.0f;     ///< 0 = linear, 1 = cubic: (1 - e) x + e x^3
+    float gain = 1.0f;     ///< output scale, saturated to full scale
+    bool invert = false;
+};
+
+/// Shaping of a stick, i.e. a pair of axes (0/1, 2/3, 4/5 or 6/7).
+struct StickCurve {
+    float radial_deadzone = 0.0f; ///< fraction of full scale in [0, 1)
+    AxisCurve x;
+    AxisCurve y;
+};
+
+/// Fused deadzone, response curve, inversion, scaling and saturation for
+/// every axis of many devices at once.
+///
+/// Axis values and curve parameters are kept as structure-of-arrays blocks
+/// indexed by (stick, device), so a single kernel sweeps all sticks of all
+/// devices. The kernel is picked once at construction (scalar, SSE2 or AVX2)
+/// and every tier produces bit-identical output.
+class AxisProcessor {
+public:
+    static constexpr std::size_t kSticks = kMaxAxes / 2;
+
+    /// Throws std::invalid_argument if `devices` is 0.
+    explicit AxisProcessor(std::size_t devices, SimdLevel level = detect_simd_level());
+
+    /// Sets the curve of one stick of one device. Unconfigured sticks pass
+    /// values through. Throws std::invalid_argument on out-of-range values.
+    void configure(std::size_t device, std::size_t stick, const StickCurve& curve);
+
+    /// Copies the axes of `state` into the processing block.
+    void load(std::size_t device, const JoystickState& state) noexcept;
+
+    /// Writes the shaped axes back into `state`; other fields are untouched.
+    void store(std::size_t device, JoystickState& state) const noexcept;
+
+    /// Shapes every loaded axis in place.
+    void run() noexcept;
+
+    /// load() + run() + store() for `count` consecutive devices.
+    void process(JoystickState* states, std::size_t count) noexcept;
+
+    [[nodiscard]] std::size_t devices() const noexcept { return devices_; }
+    [[nodiscard]] SimdLevel level() const noexcept { return level_; }
+
+private:
+    std::size_t index(std::size_t device, std::size_t stick) const noexcept { return stick * stride_ + device; }
+    void configure_lane(std::size_t device, std::size_t stick, const StickCurve& curve) noexcept;
+
+    std::size_t devices_;
+    std::size_t stride_;
+    SimdLevel level_;
+    AlignedBuffer<std::int16_t> x_;
+    AlignedBuffer<std::int16_t> y_;
+    AlignedBuffer<float> params_;
+};
+
+} // namespace vjc
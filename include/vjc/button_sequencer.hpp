@@ -0,0 +1,124 @@
+#pragma once
+
+#include "vjc/object_pool.hpp"
+#include "vjc/timer_wheel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace vjc {
+
+/// One step of a timed sequence: `buttons` held for `duration_ns`.
+struct SequenceStep {
+    std::uint64_t buttons = 0;
+    std::uint64_t duration_ns = 0;
+};
+
+/// A scripted button sequence, e.g. a combo macro.
+struct ButtonSequence {
+    std::vector<SequenceStep> steps;
+    bool repeat = false; ///< start over after the last step until cancelled
+};
+
+/// Identifies a running turbo or sequence; stale ids are ignored.
+using SequenceId = std::uint64_t;
+inline constexpr SequenceId kNoSequence = 0;
+
+/// Time-driven turbo buttons and sequences, overlaid on device output.
+///
+/// Every running pattern owns exactly one TimerWheel timer, armed for its
+/// next transition; when it fires the pattern moves to its next step and
+/// re-arms from the previous deadline, so periods do not drift with wakeup
+/// latency. The buttons of all patterns of a device are ORed into an
+/// overlay that the output path merges into each frame. Patterns come from a
+/// pool sized at construction, so nothing allocates once running; starting
+/// one with the pool exhausted fails. Single-threaded, with time passed in
+/// by the caller.
+class ButtonSequencer {
+public:
+    struct Stats {
+        std::uint64_t transitions = 0; ///< timers fired
+        std::uint64_t max_late_ns = 0; ///< worst advance time past a deadline
+        std::uint64_t rejected = 0;    ///< starts refused for lack of a pattern
+    };
+
+    /// Throws std::invalid_argument if `capacity` or `tick_ns` is 0.
+    ButtonSequencer(std::size_t devices, std::size_t capacity, std::uint64_t tick_ns, std::uint64_t now_ns);
+
+    /// Pulses `buttons` on `device`: pressed for the first half of each
+    /// `period_ns`, released for the second.
+    SequenceId turbo(std::size_t device, std::uint64_t buttons, std::uint64_t period_ns,
+                     std::uint64_t now_ns) noexcept;
+
+    /// Plays `sequence` on `device` from its first step.
+    SequenceId play(std::size_t device, std::shared_ptr<const ButtonSequence> sequence,
+                    std::uint64_t now_ns) noexcept;
+
+    bool cancel(SequenceId id) noexcept;
+
+    /// Cancels the turbos of `device` that pulse any of `buttons`.
+    void cancel_turbo(std::size_t device, std::uint64_t buttons) noexcept;
+
+    /// Cancels every pattern of `device`.
+    void cancel_device(std::size_t device) noexcept;
+
+    /// Runs the transitions due at `now_ns`. Returns the devices whose
+    /// overlay changed since the last call, including through start and
+    /// cancel; the span is valid until the next call.
+    std::span<const std::uint32_t> advance(std::uint64_t now_ns) noexcept;
+
+    /// Buttons the device's patterns currently hold down.
+    [[nodiscard]] std::uint64_t overlay(std::size_t device) const noexcept { return devices_[device].overlay; }
+
+    /// When advance() next has work; TimerWheel::kNoDeadline when idle.
+    [[nodiscard]] std::uint64_t next_deadline() const noexcept { return wheel_.next_deadline(); }
+
+    [[nodiscard]] std::size_t active() const noexcept { return wheel_.size(); }
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    static constexpr std::uint32_t kNil = ObjectPool<std::uint32_t>::kNone;
+
+    struct Pattern {
+        std::shared_ptr<const ButtonSequence> sequence; // null for turbo
+        std::uint64_t buttons = 0; // turbo buttons, or held by the current step
+        std::uint64_t half_period_ns = 0;
+        std::uint64_t deadline_ns = 0;
+        TimerId timer = kNoTimer;
+        std::uint32_t generation = 1;
+        std::uint32_t device = 0;
+        std::uint32_t step = 0;
+        std::uint32_t next = kNil; // device list
+        std::uint32_t prev = kNil;
+        bool pressed = false;
+    };
+
+    struct Device {
+        std::uint64_t overlay = 0;
+        std::uint32_t head = kNil;
+        bool dirty = false;
+    };
+
+    [[nodiscard]] std::uint64_t held(const Pattern& pattern) const noexcept
+    {
+        return pattern.sequence ? pattern.buttons : pattern.pressed ? pattern.buttons : 0;
+    }
+
+    std::uint32_t acquire(std::size_t device) noexcept;
+    void release(std::uint32_t index) noexcept;
+    bool arm(std::uint32_t index, std::uint64_t deadline_ns) noexcept;
+    void step(std::uint32_t index, std::uint64_t now_ns) noexcept;
+    void touch(std::uint32_t device) noexcept;
+
+    TimerWheel wheel_;
+    ObjectPool<Pattern> patterns_;
+    std::vector<Device> devices_;
+    std::vector<std::uint32_t> dirty_;   // devices touched since the last advance()
+    std::vector<std::uint32_t> changed_; // of those, the ones whose overlay changed
+    Stats stats_;
+};
+
+} // namespace vjc
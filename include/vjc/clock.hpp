@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+namespace vjc {
+
+/// CLOCK_MONOTONIC in nanoseconds; the time base of every timestamp in vjc.
+inline std::uint64_t monotonic_ns() noexcept
+{
+    timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000u + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+/// Sleeps until the absolute CLOCK_MONOTONIC time `deadline_ns`.
+inline void sleep_until_ns(std::uint64_t deadline_ns) noexcept
+{
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadline_ns / 1'000'000'000u);
+    ts.tv_nsec = static_cast<long>(deadline_ns % 1'000'000'000u);
+    while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0) {
+    }
+}
+
+} // namespace vjc
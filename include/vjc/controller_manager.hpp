@@ -0,0 +1,240 @@
+#pragma once
+
+#include "vjc/button_sequencer.hpp"
+#include "vjc/doorbell.hpp"
+#include "vjc/joystick_state.hpp"
+#include "vjc/output_scheduler.hpp"
+#include "vjc/platform.hpp"
+#include "vjc/realtime.hpp"
+#include "vjc/spsc_ring.hpp"
+#include "vjc/state_ring.hpp"
+#include "vjc/virtual_joystick.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace vjc {
+
+class ProfileStore;
+
+/// Notified on the writer thread after each frame a device emitted.
+/// Implementations must be cheap and must not block.
+class FrameObserver {
+public:
+    virtual ~FrameObserver() = default;
+    virtual void on_frame(unsigned writer, std::size_t device, const JoystickState& state,
+                          std::size_t events) noexcept = 0;
+};
+
+struct ManagerConfig {
+    /// Number of writer threads; devices are sharded round-robin across them.
+    unsigned writer_threads = 1;
+    /// CPU for writer `i` is `cpus[i % cpus.size()]`; empty leaves them unpinned.
+    std::vector<int> cpus;
+    /// SCHED_FIFO, memory locking and spin-then-park for the writer
+    /// threads; all off by default, and each skipped if not permitted.
+    RealtimeConfig realtime;
+    RingMode ring_mode = RingMode::Coalesce;
+    /// Output pacing per device. Any policy other than Passthrough needs
+    /// every intermediate state to see button edges, so it forces Queue rings.
+    ScheduleConfig schedule;
+    /// Turbo and sequence patterns each writer can run at once; 0 disables
+    /// turbo() and play().
+    std::size_t sequence_capacity = 0;
+    /// Timer wheel resolution of those patterns.
+    std::uint64_t sequence_tick_ns = 100'000;
+};
+
+/// Owns many virtual devices and the threads that write to them.
+///
+/// Every device has its own StateRing, so producers for different devices
+/// never contend. Each writer thread services a fixed shard of devices,
+/// visiting them round-robin from a rotating start so a busy device cannot
+/// starve the others, and sleeps on a futex doorbell when its shard is idle.
+/// With a scheduling policy the writer also wakes at the earliest pending
+/// output deadline of its shard. Turbo buttons and sequences run on a timer
+/// wheel per writer, ticked from the same loop, and are ORed into the frames.
+/// Devices are added before start(); a device accepts one producer thread.
+class ControllerManager {
+public:
+    struct DeviceStats {
+        std::uint64_t frames = 0;
+        std::uint64_t events = 0;
+        std::uint64_t failed_frames = 0;
+        std::uint64_t coalesced = 0; ///< merged in the ring or the scheduler
+        std::uint64_t dropped = 0;
+        std::uint64_t edge_frames = 0; ///< extra frames that preserved button taps
+    };
+
+    explicit ControllerManager(ManagerConfig config = {});
+    ~ControllerManager();
+
+    ControllerManager(const ControllerManager&) = delete;
+    ControllerManager& operator=(const ControllerManager&) = delete;
+
+    /// Takes ownership of a device and returns its index. Throws
+    /// std::logic_error once the manager is running.
+    std::size_t add_device(std::unique_ptr<VirtualJoystick> joystick);
+
+    /// Installs an observer (or nullptr) for emitted frames; call before start().
+    void set_observer(FrameObserver* observer) noexcept { observer_ = observer; }
+
+    /// Maps and shapes every frame of `device` through the store's current
+    /// profile (or none with nullptr); the observer sees the result. The
+    /// store must outlive the manager and have a reader per writer thread.
+    /// Throws std::logic_error while running, std::invalid_argument otherwise.
+    void attach_profile(std::size_t device, ProfileStore* store);
+
+    /// Starts the writer threads. Pinning and real-time failures are not
+    /// fatal; see pinned(), fifo() and memory_locked().
+    void start();
+
+    /// Stops and joins the writer threads after they drain pending states.
+    void stop() noexcept;
+
+    // Producer side, one thread per device.
+
+    /// Slot to decode the next state of `device` into, or nullptr when a
+    /// Queue ring is full. Must be followed by commit().
+    [[nodiscard]] JoystickState* claim(std::size_t device) noexcept { return slots_[device]->ring.claim(); }
+
+    /// Publishes the claimed state and wakes the device's writer.
+    void commit(std::size_t device) noexcept
+    {
+        Slot& slot = *slots_[device];
+        slot.ring.publish();
+        slot.writer->ring_doorbell();
+    }
+
+    /// Copies `state` into the device's ring. Returns false if it was full.
+    bool publish(std::size_t device, const JoystickState& state) noexcept
+    {
+        JoystickState* s = claim(device);
+        if (!s)
+            return false;
+        *s = state;
+        commit(device);
+        return true;
+    }
+
+    /// Pulses `buttons` of `device` with `period_ns`, or stops pulsing them
+    /// when `period_ns` is 0. Returns false when sequences are disabled or
+    /// the device's command queue is full.
+    bool turbo(std::size_t device, std::uint64_t buttons, std::uint64_t period_ns) noexcept
+    {
+        return command(device, {SequenceCommand::Turbo, 0, buttons, period_ns});
+    }
+
+    /// Plays a sequence registered with add_sequence() on `device`.
+    bool play(std::size_t device, std::uint32_t sequence) noexcept
+    {
+        return command(device, {SequenceCommand::Play, sequence, 0, 0});
+    }
+
+    /// Stops every turbo and sequence of `device`.
+    bool stop_sequences(std::size_t device) noexcept { return command(device, {SequenceCommand::Stop, 0, 0, 0}); }
+
+    /// Registers a sequence for play() and returns its number. Throws
+    /// std::logic_error while running and std::invalid_argument for an empty
+    /// sequence or a zero-length step.
+    std::uint32_t add_sequence(ButtonSequence sequence);
+
+    [[nodiscard]] std::size_t device_count() const noexcept { return slots_.size(); }
+    [[nodiscard]] unsigned writer_count() const noexcept { return static_cast<unsigned>(writers_.size()); }
+    [[nodiscard]] bool running() const noexcept { return running_.load(std::memory_order_relaxed); }
+
+    /// Writers successfully pinned to their configured CPU.
+    [[nodiscard]] unsigned pinned() const noexcept { return pinned_.load(std::memory_order_relaxed); }
+
+    /// Writers running under SCHED_FIFO at the configured priority.
+    [[nodiscard]] unsigned fifo() const noexcept { return fifo_.load(std::memory_order_relaxed); }
+
+    /// Whether start() managed to lock memory when asked to.
+    [[nodiscard]] bool memory_locked() const noexcept { return memory_locked_; }
+
+    /// Counters for `device`; safe to call while running.
+    [[nodiscard]] DeviceStats stats(std::size_t device) const noexcept;
+
+    /// Direct access to a device; only safe while the manager is stopped.
+    [[nodiscard]] VirtualJoystick& device(std::size_t index) noexcept { return *slots_[index]->joystick; }
+
+private:
+    struct Writer;
+
+    struct SequenceCommand {
+        enum Kind : std::uint8_t { Turbo, Play, Stop };
+        Kind kind;
+        std::uint32_t sequence;
+        std::uint64_t buttons;
+        std::uint64_t period_ns;
+    };
+    using CommandRing = SpscRing<SequenceCommand, 64>;
+
+    struct alignas(kCacheLineSize) Slot {
+        Slot(RingMode mode, const ScheduleConfig& schedule)
+            : ring(mode)
+            , scheduler(schedule)
+        {
+        }
+
+        StateRing ring;
+        OutputScheduler scheduler; // writer thread only
+        std::unique_ptr<CommandRing> commands; // with sequences enabled
+        JoystickState output{};                // last frame after the profile, before the overlay
+        std::unique_ptr<VirtualJoystick> joystick;
+        Writer* writer = nullptr;
+        ProfileStore* profile = nullptr;
+        std::size_t index = 0;
+        std::uint32_t local = 0; // position in writer->slots
+        alignas(kCacheLineSize) std::atomic<std::uint64_t> frames{0};
+        std::atomic<std::uint64_t> events{0};
+        std::atomic<std::uint64_t> failed{0};
+        std::atomic<std::uint64_t> scheduled{0}; // scheduler.coalesced(), published
+        std::atomic<std::uint64_t> edge_frames{0};
+    };
+
+    struct Writer {
+        Doorbell doorbell;
+        alignas(kCacheLineSize) std::vector<Slot*> slots;
+        std::unique_ptr<ButtonSequencer> sequencer;
+        unsigned index = 0;
+        int cpu = -1;
+        std::thread thread;
+
+        void ring_doorbell() noexcept { doorbell.ring(); }
+    };
+
+    bool command(std::size_t device, const SequenceCommand& cmd) noexcept
+    {
+        Slot& slot = *slots_[device];
+        if (!slot.commands || !slot.commands->try_push(cmd))
+            return false;
+        slot.writer->ring_doorbell();
+        return true;
+    }
+
+    void run_writer(Writer& writer) noexcept;
+    bool service(Writer& writer, Slot& slot) noexcept;
+    bool schedule(Writer& writer, Slot& slot, std::uint64_t now) noexcept;
+    bool sequence(Writer& writer, std::uint64_t now) noexcept;
+    void emit(Writer& writer, Slot& slot, const JoystickState& state) noexcept;
+    void map(Writer& writer, Slot& slot, const JoystickState& state) noexcept;
+    JoystickState overlaid(const Writer& writer, const Slot& slot) const noexcept;
+    void write(Writer& writer, Slot& slot, const JoystickState& frame) noexcept;
+
+    ManagerConfig config_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::vector<std::unique_ptr<Writer>> writers_;
+    std::vector<std::shared_ptr<const ButtonSequence>> sequences_;
+    FrameObserver* observer_ = nullptr;
+    std::atomic<bool> running_{false};
+    std::atomic<unsigned> pinned_{0};
+    std::atomic<unsigned> fifo_{0};
+    bool memory_locked_ = false;
+};
+
+} // namespace vjc
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace vjc {
+
+/// Instruction-set tiers of the vectorized kernels, in increasing order.
+enum class SimdLevel {
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+/// Best level supported by the running CPU. The VJC_SIMD environment
+/// variable ("scalar", "sse2", "avx2") can lower it, e.g. to compare kernels.
+[[nodiscard]] SimdLevel detect_simd_level() noexcept;
+
+/// Clamps `requested` to what the CPU supports.
+[[nodiscard]] SimdLevel supported_simd_level(SimdLevel requested) noexcept;
+
+[[nodiscard]] const char* to_string(SimdLevel level) noexcept;
+
+} // namespace vjc
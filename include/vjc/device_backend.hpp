@@ -0,0 +1,81 @@
+#pragma once
+
+#include "vjc/device_descriptor.hpp"
+
+#include <linux/input.h>
+#include <linux/uinput.h>
+
+#include <cstddef>
+#include <string>
+
+namespace vjc {
+
+/// Destination of encoded evdev frames.
+///
+/// `create()` may throw; `write_events()` runs on the emit path and must
+/// not. A frame is always handed over in one `write_events()` call.
+class DeviceBackend {
+public:
+    virtual ~DeviceBackend() = default;
+
+    /// Registers the device capabilities. Throws std::system_error on failure.
+    virtual void create(const DeviceDescriptor& descriptor) = 0;
+
+    /// Writes `count` events. Returns false if the frame could not be written
+    /// in full (for instance EAGAIN on a non-blocking fd).
+    virtual bool write_events(const input_event* events, std::size_t count) noexcept = 0;
+
+    /// Underlying file descriptor, or -1 for backends without one.
+    [[nodiscard]] virtual int fd() const noexcept = 0;
+
+    /// Force-feedback handshake for an EV_UINPUT request read from fd():
+    /// begin fetches the upload or erase named by `request_id`, end hands
+    /// `retval` back to the game blocked in its ioctl. Called from the
+    /// ForceFeedback thread, concurrently with write_events(). Backends
+    /// without force feedback fail every call.
+    virtual bool ff_begin_upload(uinput_ff_upload&) noexcept { return false; }
+    virtual bool ff_end_upload(const uinput_ff_upload&) noexcept { return false; }
+    virtual bool ff_begin_erase(uinput_ff_erase&) noexcept { return false; }
+    virtual bool ff_end_erase(const uinput_ff_erase&) noexcept { return false; }
+};
+
+/// Writes frames to an arbitrary file descriptor with a single write().
+///
+/// Used as a stand-in for /dev/uinput: a pipe, socket or memfd receives the
+/// exact byte stream the kernel would. `create()` only records the descriptor.
+class FdBackend : public DeviceBackend {
+public:
+    /// Takes ownership of `fd` when `owned` is true.
+    explicit FdBackend(int fd, bool owned = true) noexcept;
+    ~FdBackend() override;
+
+    FdBackend(const FdBackend&) = delete;
+    FdBackend& operator=(const FdBackend&) = delete;
+
+    void create(const DeviceDescriptor& descriptor) override;
+    bool write_events(const input_event* events, std::size_t count) noexcept override;
+    [[nodiscard]] int fd() const noexcept override { return fd_; }
+
+protected:
+    int fd_;
+    bool owned_;
+};
+
+/// Creates a real device through /dev/uinput.
+class UinputBackend final : public FdBackend {
+public:
+    /// Opens the uinput node. Throws std::system_error if it is unavailable.
+    explicit UinputBackend(const std::string& path = "/dev/uinput");
+    ~UinputBackend() override;
+
+    void create(const DeviceDescriptor& descriptor) override;
+    bool ff_begin_upload(uinput_ff_upload& upload) noexcept override;
+    bool ff_end_upload(const uinput_ff_upload& upload) noexcept override;
+    bool ff_begin_erase(uinput_ff_erase& erase) noexcept override;
+    bool ff_end_erase(const uinput_ff_erase& erase) noexcept override;
+
+private:
+    bool created_ = false;
+};
+
+} // namespace vjc
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vjc {
+
+/// Effects a device may hold at once; sizes ForceFeedback's slot tables.
+inline constexpr unsigned kMaxFfEffects = 64;
+
+/// Range and evdev code of one absolute axis.
+struct AbsAxisInfo {
+    std::uint16_t code = 0;
+    std::int32_t min = 0;
+    std::int32_t max = 0;
+    std::int32_t fuzz = 0;
+    std::int32_t flat = 0;
+    std::int32_t resolution = 0; ///< units per mm; per g or per deg/s on a motion sensor
+};
+
+/// Capabilities of a virtual device and how JoystickState fields map onto
+/// evdev codes. `axes[i]` is driven by `JoystickState::axes[i]`, `triggers[i]`
+/// by `JoystickState::triggers[i]`, hat `i` uses ABS_HAT0X + 2i / ABS_HAT0Y + 2i
+/// and bit `i` of `JoystickState::buttons` is reported as `buttons[i]`.
+struct DeviceDescriptor {
+    std::string name = "VirtualJoystickController";
+    std::uint16_t bustype = 0x03; // BUS_USB
+    std::uint16_t vendor = 0x045e;
+    std::uint16_t product = 0x028e;
+    std::uint16_t version = 0x0110;
+
+    std::vector<AbsAxisInfo> axes;
+    std::vector<AbsAxisInfo> triggers;
+    unsigned hat_count = 0;
+    std::vector<std::uint16_t> buttons;
+
+    /// Force-feedback capabilities (FF_RUMBLE, FF_PERIODIC, waveforms such as
+    /// FF_SINE, FF_GAIN, ...) and how many effects a game may upload at
+    /// once; 0 effects means no force feedback. See ForceFeedback.
+    std::vector<std::uint16_t> ff_features;
+    unsigned ff_effects = 0;
+
+    /// Input properties (INPUT_PROP_ACCELEROMETER, ...) and EV_MSC codes
+    /// (MSC_TIMESTAMP, ...) the device declares.
+    std::vector<std::uint16_t> properties;
+    std::vector<std::uint16_t> misc;
+
+    /// Xbox-style layout: two sticks, two analog triggers, one d-pad hat and
+    /// eleven buttons.
+    [[nodiscard]] static DeviceDescriptor gamepad();
+
+    /// gamepad() with rumble, periodic effects and gain, 16 effects.
+    [[nodiscard]] static DeviceDescriptor rumble_gamepad();
+
+    /// Companion motion-sensor node: accelerometer on ABS_X/Y/Z (8192 per
+    /// g), gyroscope on ABS_RX/RY/RZ (1024 per deg/s), MSC_TIMESTAMP and
+    /// INPUT_PROP_ACCELEROMETER. See MotionSensor.
+    [[nodiscard]] static DeviceDescriptor motion_sensor();
+
+    /// Throws std::invalid_argument if the descriptor exceeds the limits of
+    /// JoystickState or reuses an evdev code.
+    void validate() const;
+};
+
+} // namespace vjc
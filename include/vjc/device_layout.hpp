@@ -0,0 +1,146 @@
+#pragma once
+
+#include "vjc/device_descriptor.hpp"
+#include "vjc/joystick_state.hpp"
+
+#include <linux/input.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace vjc {
+
+/// Capabilities of a virtual device fixed at compile time, with the same
+/// meaning as DeviceDescriptor: `axes[i]` is driven by
+/// `JoystickState::axes[i]` and so on. A constexpr layout can be turned
+/// into a specialized encoder with StaticEncoder; descriptor() gives the
+/// runtime form the backends and EventEncoder take.
+template <std::size_t Axes, std::size_t Triggers, std::size_t Hats, std::size_t Buttons>
+struct DeviceLayout {
+    static_assert(Axes <= kMaxAxes && Triggers <= kMaxTriggers && Hats <= kMaxHats && Buttons <= kMaxButtons,
+                  "layout exceeds the limits of JoystickState");
+
+    static constexpr std::size_t kAxes = Axes;
+    static constexpr std::size_t kTriggers = Triggers;
+    static constexpr std::size_t kHats = Hats;
+    static constexpr std::size_t kButtons = Buttons;
+
+    const char* name = "VirtualJoystickController";
+    std::uint16_t bustype = 0x03; // BUS_USB
+    std::uint16_t vendor = 0x045e;
+    std::uint16_t product = 0x028e;
+    std::uint16_t version = 0x0110;
+    std::array<AbsAxisInfo, Axes> axes{};
+    std::array<AbsAxisInfo, Triggers> triggers{};
+    std::array<std::uint16_t, Buttons> buttons{};
+
+    /// The checks of DeviceDescriptor::validate() that do not depend on
+    /// the limits above: codes in range and none reused.
+    [[nodiscard]] consteval bool valid() const
+    {
+        std::array<std::uint16_t, Axes + Triggers + 2 * Hats> abs{};
+        std::size_t n = 0;
+        for (const auto& a : axes)
+            abs[n++] = a.code;
+        for (const auto& t : triggers)
+            abs[n++] = t.code;
+        for (std::size_t h = 0; h < Hats; ++h) {
+            abs[n++] = static_cast<std::uint16_t>(ABS_HAT0X + 2 * h);
+            abs[n++] = static_cast<std::uint16_t>(ABS_HAT0Y + 2 * h);
+        }
+        return unique(abs, ABS_MAX) && unique(buttons, KEY_MAX);
+    }
+
+    [[nodiscard]] DeviceDescriptor descriptor() const
+    {
+        DeviceDescriptor d;
+        d.name = name;
+        d.bustype = bustype;
+        d.vendor = vendor;
+        d.product = product;
+        d.version = version;
+        d.axes.assign(axes.begin(), axes.end());
+        d.triggers.assign(triggers.begin(), triggers.end());
+        d.hat_count = static_cast<unsigned>(Hats);
+        d.buttons.assign(buttons.begin(), buttons.end());
+        return d;
+    }
+
+private:
+    template <std::size_t N>
+    static consteval bool unique(const std::array<std::uint16_t, N>& codes, unsigned max)
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            if (codes[i] > max)
+                return false;
+            for (std::size_t j = i + 1; j < N; ++j)
+                if (codes[i] == codes[j])
+                    return false;
+        }
+        return true;
+    }
+};
+
+namespace layouts {
+
+inline constexpr AbsAxisInfo kStick{0, -32768, 32767, 16, 128};
+inline constexpr AbsAxisInfo kPedal{0, 0, 65535, 0, 0};
+
+constexpr AbsAxisInfo with_code(AbsAxisInfo info, std::uint16_t code) noexcept
+{
+    info.code = code;
+    return info;
+}
+
+/// Same capabilities as DeviceDescriptor::gamepad().
+inline constexpr DeviceLayout<4, 2, 1, 11> kXboxPad{
+    .name = "VirtualJoystickController Gamepad",
+    .axes = {with_code(kStick, ABS_X), with_code(kStick, ABS_Y), with_code(kStick, ABS_RX),
+             with_code(kStick, ABS_RY)},
+    .triggers = {with_code(kPedal, ABS_Z), with_code(kPedal, ABS_RZ)},
+    .buttons = {BTN_SOUTH, BTN_EAST, BTN_NORTH, BTN_WEST, BTN_TL, BTN_TR, BTN_SELECT, BTN_START, BTN_MODE,
+                BTN_THUMBL, BTN_THUMBR},
+};
+
+/// Digital lever on a hat and eight attack buttons.
+inline constexpr DeviceLayout<0, 0, 1, 11> kArcadeStick{
+    .name = "VirtualJoystickController Arcade Stick",
+    .product = 0x0001,
+    .buttons = {BTN_SOUTH, BTN_EAST, BTN_NORTH, BTN_WEST, BTN_TL, BTN_TR, BTN_TL2, BTN_TR2, BTN_SELECT, BTN_START,
+                BTN_MODE},
+};
+
+/// Stick with twist, throttle, rudder pedals and a thumb mini-stick; two
+/// hats and 32 buttons.
+inline constexpr DeviceLayout<7, 0, 2, 32> kFlightHotas{
+    .name = "VirtualJoystickController HOTAS",
+    .product = 0x0002,
+    .axes = {with_code(kStick, ABS_X), with_code(kStick, ABS_Y), with_code(kStick, ABS_RZ),
+             with_code(kStick, ABS_THROTTLE), with_code(kStick, ABS_RUDDER), with_code(kStick, ABS_RX),
+             with_code(kStick, ABS_RY)},
+    .buttons = {BTN_TRIGGER, BTN_THUMB, BTN_THUMB2, BTN_TOP, BTN_TOP2, BTN_PINKIE, BTN_BASE, BTN_BASE2,
+                BTN_BASE3, BTN_BASE4, BTN_BASE5, BTN_BASE6, BTN_TRIGGER_HAPPY1, BTN_TRIGGER_HAPPY2,
+                BTN_TRIGGER_HAPPY3, BTN_TRIGGER_HAPPY4, BTN_TRIGGER_HAPPY5, BTN_TRIGGER_HAPPY6,
+                BTN_TRIGGER_HAPPY7, BTN_TRIGGER_HAPPY8, BTN_TRIGGER_HAPPY9, BTN_TRIGGER_HAPPY10,
+                BTN_TRIGGER_HAPPY11, BTN_TRIGGER_HAPPY12, BTN_TRIGGER_HAPPY13, BTN_TRIGGER_HAPPY14,
+                BTN_TRIGGER_HAPPY15, BTN_TRIGGER_HAPPY16, BTN_TRIGGER_HAPPY17, BTN_TRIGGER_HAPPY18,
+                BTN_TRIGGER_HAPPY19, BTN_TRIGGER_HAPPY20},
+};
+
+/// Steering on ABS_X, gas and brake pedals, paddles, a d-pad and an
+/// H-pattern shifter (six gears and reverse).
+inline constexpr DeviceLayout<1, 2, 1, 18> kWheel{
+    .name = "VirtualJoystickController Wheel",
+    .product = 0x0003,
+    .axes = {with_code(kStick, ABS_X)},
+    .triggers = {with_code(kPedal, ABS_GAS), with_code(kPedal, ABS_BRAKE)},
+    .buttons = {BTN_SOUTH, BTN_EAST, BTN_NORTH, BTN_WEST, BTN_GEAR_DOWN, BTN_GEAR_UP, BTN_SELECT, BTN_START,
+                BTN_MODE, BTN_THUMBL, BTN_THUMBR, BTN_TRIGGER_HAPPY1, BTN_TRIGGER_HAPPY2, BTN_TRIGGER_HAPPY3,
+                BTN_TRIGGER_HAPPY4, BTN_TRIGGER_HAPPY5, BTN_TRIGGER_HAPPY6, BTN_TRIGGER_HAPPY7},
+};
+
+} // namespace layouts
+
+} // namespace vjc
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "vjc/platform.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace vjc {
+
+/// Wake-up signal from producers to one consumer thread, built on a futex.
+///
+/// The consumer reads a ticket with prepare(), checks its queues and, if they
+/// are empty, calls wait() with that ticket; any ring() after prepare() makes
+/// wait() return immediately. ring() only enters the kernel when a consumer
+/// is actually asleep. A process-shared doorbell placed in shared memory
+/// works across processes.
+class Doorbell {
+public:
+    static constexpr std::uint64_t kForever = ~std::uint64_t{0};
+
+    explicit Doorbell(bool process_shared = false) noexcept
+        : process_shared_(process_shared)
+    {
+    }
+
+    [[nodiscard]] std::uint32_t prepare() const noexcept { return sequence_.load(std::memory_order_acquire); }
+
+    void ring() noexcept;
+
+    /// Sleeps until ring() is called after `ticket` was prepared, or until
+    /// the absolute CLOCK_MONOTONIC time `deadline_ns`. Returns false on
+    /// timeout. With `spin_ns` it first busy-waits that long, which avoids a
+    /// futex wake-up on both sides when the ring comes soon.
+    bool wait(std::uint32_t ticket, std::uint64_t deadline_ns = kForever, std::uint64_t spin_ns = 0) noexcept;
+
+private:
+    alignas(kCacheLineSize) std::atomic<std::uint32_t> sequence_{0};
+    std::atomic<std::uint32_t> waiters_{0};
+    bool process_shared_;
+};
+
+} // namespace vjc
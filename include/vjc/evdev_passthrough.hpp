@@ -0,0 +1,142 @@
+#pragma once
+
+#include "vjc/io_loop.hpp"
+#include "vjc/joystick_state.hpp"
+#include "vjc/mapping.hpp"
+#include "vjc/response_curve.hpp"
+
+#include <linux/input.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vjc {
+
+class ControllerManager;
+
+enum class EvdevTarget : std::uint8_t { None, Axis, Trigger, Hat, Button };
+
+/// Routes one source event code to a JoystickState field.
+struct EvdevBinding {
+    std::uint16_t type = EV_ABS; ///< EV_ABS or EV_KEY
+    std::uint16_t code = 0;
+    EvdevTarget target = EvdevTarget::None;
+    std::uint8_t index = 0; ///< axis, trigger, hat or button number
+    bool invert = false;
+    /// Source range of an EV_ABS code. Left at 0/0 it is read from the device
+    /// with EVIOCGABS, or defaults to the target's own range.
+    std::int32_t min = 0;
+    std::int32_t max = 0;
+};
+
+struct EvdevSource {
+    std::string path; ///< /dev/input/eventN; opened non-blocking
+    int fd = -1;      ///< used instead of `path` when set; ownership is taken
+    std::size_t device = 0; ///< manager device the source drives
+    bool grab = true;       ///< EVIOCGRAB so other readers stop seeing it
+    std::vector<EvdevBinding> bindings;
+    std::shared_ptr<const CompiledMapping> mapping; ///< optional button/axis rules
+    CurveSet curves; ///< applied to the axes after the mapping
+
+    /// Bindings for a standard gamepad, mirroring DeviceDescriptor::gamepad().
+    static std::vector<EvdevBinding> gamepad_bindings();
+};
+
+struct EvdevConfig {
+    unsigned read_events = 256; ///< input_events per read() call
+};
+
+/// Re-emits physical evdev devices through managed virtual joysticks.
+///
+/// All sources share one epoll loop. Each ready source is drained with large
+/// reads, its events are mapped onto the target device's state through a
+/// per-code lookup table, and each SYN_REPORT publishes one state, passed
+/// through the source's mapping and curves, into the device's ring. After a
+/// SYN_DROPPED the partial frame is discarded and the state re-read with
+/// EVIOCGABS/EVIOCGKEY where the source supports it. Any readable fd of
+/// input_events works as a source, so a pipe stands in for hardware.
+class EvdevPassthrough {
+public:
+    struct Stats {
+        std::uint64_t events = 0;
+        std::uint64_t reads = 0;
+        std::uint64_t frames = 0;
+        std::uint64_t unmapped = 0;
+        std::uint64_t dropped_syncs = 0;
+        std::uint64_t ring_full = 0;
+        std::uint64_t read_errors = 0; ///< transient failures of a loop read, retried
+    };
+
+    /// Opens, grabs and registers every source. Throws std::system_error or
+    /// std::invalid_argument.
+    EvdevPassthrough(ControllerManager& manager, std::vector<EvdevSource> sources, EvdevConfig config = {});
+    /// Releases the grabs and closes the sources.
+    ~EvdevPassthrough();
+
+    EvdevPassthrough(const EvdevPassthrough&) = delete;
+    EvdevPassthrough& operator=(const EvdevPassthrough&) = delete;
+
+    /// Waits up to `timeout_ms` for input and drains every ready source.
+    /// Returns the number of events processed.
+    std::size_t poll(int timeout_ms) noexcept;
+
+    /// Runs poll() on a background thread until stop().
+    void start();
+    void stop() noexcept;
+
+    /// Reads every source on `loop` instead, one task per source, so the
+    /// thread running it can serve other fds too. Not together with start();
+    /// the loop must be destroyed before the passthrough.
+    void serve(IoLoop& loop);
+
+    /// Counters; only consistent when read from the polling thread or after stop().
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    struct Route {
+        EvdevTarget target = EvdevTarget::None;
+        std::uint8_t index = 0;
+        bool invert = false;
+        std::int32_t min = 0;
+        std::int32_t span = 1;
+    };
+
+    struct Source {
+        int fd = -1;
+        bool grabbed = false;
+        bool evdev = false;
+        bool dropping = false;
+        std::size_t device = 0;
+        std::size_t partial = 0; // bytes of an incomplete event left from the last read
+        char tail[sizeof(input_event)]{};
+        std::shared_ptr<const CompiledMapping> mapping;
+        MappingState mapping_state;
+        CurveSet curves;
+        std::vector<Route> abs;
+        std::vector<Route> keys;
+    };
+
+    std::size_t drain(Source& source) noexcept;
+    std::size_t consume(Source& source, const input_event* events, std::size_t bytes) noexcept;
+    IoTask receive(IoLoop& loop, Source& source);
+    void apply(Source& source, const input_event& event) noexcept;
+    void publish(Source& source) noexcept;
+    void resync(Source& source) noexcept;
+
+    ControllerManager& manager_;
+    EvdevConfig config_;
+    int epoll_fd_ = -1;
+    std::vector<Source> sources_;
+    std::vector<JoystickState> states_;
+    std::vector<input_event> buffer_;
+    Stats stats_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+} // namespace vjc
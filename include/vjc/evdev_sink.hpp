@@ -0,0 +1,101 @@
+#pragma once
+
+#include "vjc/device_backend.hpp"
+#include "vjc/doorbell.hpp"
+
+#include <linux/input.h>
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vjc {
+
+/// A uinput device and one client of its /dev/input/eventN node, in
+/// process, for tests and CI machines without /dev/uinput.
+///
+/// write_events() applies what the input core does to a uinput write:
+/// events for types and codes the descriptor does not declare are ignored,
+/// EV_ABS values pass through the axis fuzz filter, and an EV_ABS or EV_KEY
+/// event that leaves the value unchanged is dropped (key repeats, value 2,
+/// always pass), as is the SYN_REPORT of a packet left empty. What remains
+/// goes into a bounded client queue that overflows like evdev's: everything
+/// unread is replaced by SYN_DROPPED and the newest event. read() never
+/// returns events past the last SYN_REPORT, and abs_value()/key_down()
+/// answer as EVIOCGABS/EVIOCGKEY would.
+///
+/// Events are stamped with CLOCK_MONOTONIC, as for a client that selected
+/// it with EVIOCSCLOCKID. One writer and one reader may use the sink from
+/// different threads.
+class EvdevSink final : public DeviceBackend {
+public:
+    struct Stats {
+        std::uint64_t written = 0;    ///< events handed to write_events()
+        std::uint64_t ignored = 0;    ///< unsupported type or code, empty packet
+        std::uint64_t duplicates = 0; ///< value unchanged, after fuzz
+        std::uint64_t packets = 0;    ///< SYN_REPORTs queued
+        std::uint64_t dropped = 0;    ///< SYN_DROPPEDs queued on overflow
+        std::uint64_t read = 0;       ///< events returned by read()
+    };
+
+    /// `capacity` is the client queue size in events, rounded up to a power
+    /// of two and at least 64; 0 sizes it as evdev does, for eight packets
+    /// with every axis moving.
+    explicit EvdevSink(std::size_t capacity = 0) noexcept;
+
+    /// Records the capabilities. Throws std::invalid_argument for an invalid
+    /// descriptor and std::logic_error if called twice.
+    void create(const DeviceDescriptor& descriptor) override;
+    bool write_events(const input_event* events, std::size_t count) noexcept override;
+    [[nodiscard]] int fd() const noexcept override { return -1; }
+
+    /// Moves up to `max` complete-packet events into `out` without blocking.
+    /// Returns the number moved.
+    std::size_t read(input_event* out, std::size_t max) noexcept;
+
+    /// Blocks until read() has something to return or until the absolute
+    /// CLOCK_MONOTONIC time `deadline_ns`. Returns false on timeout.
+    bool wait(std::uint64_t deadline_ns = Doorbell::kForever) noexcept;
+
+    /// Current value of an axis, 0 for codes the device does not have.
+    [[nodiscard]] std::int32_t abs_value(std::uint16_t code) const noexcept;
+    /// Whether a key is held, false for codes the device does not have.
+    [[nodiscard]] bool key_down(std::uint16_t code) const noexcept;
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return queue_.size(); }
+    [[nodiscard]] Stats stats() const noexcept;
+
+private:
+    void lock() const noexcept;
+    void unlock() const noexcept;
+    bool accept(input_event& event) noexcept;
+    void push(const input_event& event) noexcept;
+
+    std::size_t requested_capacity_;
+    bool created_ = false;
+    std::bitset<ABS_CNT> abs_bits_;
+    std::bitset<KEY_CNT> key_bits_;
+    std::bitset<MSC_CNT> msc_bits_;
+    std::bitset<KEY_CNT> keys_;
+    std::array<std::int32_t, ABS_CNT> abs_{};
+    std::array<std::int32_t, ABS_CNT> fuzz_{};
+
+    // Client ring, as evdev_client: head is the next write, tail the next
+    // read, packet_head the end of the last complete packet. One slot stays
+    // free, so head == tail means empty.
+    std::vector<input_event> queue_;
+    std::size_t mask_ = 0;
+    std::size_t head_ = 0;
+    std::size_t tail_ = 0;
+    std::size_t packet_head_ = 0;
+    std::size_t pending_ = 0; ///< events since the last SYN_REPORT
+
+    Stats stats_;
+    mutable std::atomic_flag busy_ = ATOMIC_FLAG_INIT;
+    Doorbell readable_;
+};
+
+} // namespace vjc
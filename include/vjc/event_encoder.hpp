@@ -0,0 +1,49 @@
+#pragma once
+
+#include "vjc/device_descriptor.hpp"
+#include "vjc/joystick_state.hpp"
+
+#include <linux/input.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc {
+
+/// Upper bound of events one frame can produce, SYN_REPORT included.
+inline constexpr std::size_t kMaxFrameEvents = kMaxAxes + kMaxTriggers + kMaxHats * 2 + kMaxButtons + 1;
+
+using EventBuffer = std::array<input_event, kMaxFrameEvents>;
+
+/// Turns the difference between two states into evdev events.
+///
+/// The descriptor is flattened into code tables at construction so encoding
+/// a frame is a few tight loops with no lookups. Values are forwarded as-is;
+/// the descriptor's ranges must match the JoystickState field ranges.
+class EventEncoder {
+public:
+    explicit EventEncoder(const DeviceDescriptor& descriptor);
+
+    /// Writes the events needed to move from `prev` to `next` into `out`,
+    /// followed by SYN_REPORT. Returns the number of events written, or 0
+    /// when nothing changed (no SYN_REPORT is emitted for an empty frame).
+    std::size_t encode(const JoystickState& prev, const JoystickState& next, input_event* out) const noexcept;
+
+    /// Encodes every field of `state`, used to publish the initial frame.
+    std::size_t encode_full(const JoystickState& state, input_event* out) const noexcept;
+
+private:
+    template <bool Full>
+    std::size_t encode_impl(const JoystickState& prev, const JoystickState& next, input_event* out) const noexcept;
+
+    std::array<std::uint16_t, kMaxAxes> axis_codes_{};
+    std::array<std::uint16_t, kMaxTriggers> trigger_codes_{};
+    std::array<std::uint16_t, kMaxButtons> button_codes_{};
+    std::uint8_t axis_count_ = 0;
+    std::uint8_t trigger_count_ = 0;
+    std::uint8_t hat_count_ = 0;
+    std::uint64_t button_mask_ = 0;
+};
+
+} // namespace vjc
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "vjc/net_protocol.hpp"
+
+#include <linux/input.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace vjc {
+
+class ControllerManager;
+class DeviceBackend;
+
+/// Where play, stop and gain commands go: the transport of the client
+/// driving the device. Called on the ForceFeedback thread; must not block.
+class FfSink {
+public:
+    virtual ~FfSink() = default;
+    /// Returns false if the command could not be delivered.
+    virtual bool send_ff(const FfPacket& packet) noexcept = 0;
+};
+
+/// Services force-feedback requests of the managed devices.
+///
+/// A game uploading or erasing an effect blocks in its ioctl until the
+/// uinput owner answers the EV_UINPUT request, so the requests are read from
+/// the device fds on a thread of their own, never behind the writers' emit
+/// loop. Uploaded effects are kept in a slot table per device, preallocated
+/// from DeviceDescriptor::ff_effects; EV_FF play, stop and gain events are
+/// forwarded to the sink, a play with the effect's parameters. Handling
+/// allocates nothing and never waits on the sink.
+class ForceFeedback {
+public:
+    struct Stats {
+        std::uint64_t uploads = 0;
+        std::uint64_t erases = 0;
+        std::uint64_t plays = 0;
+        std::uint64_t stops = 0;
+        std::uint64_t rejected = 0;    ///< upload or erase of an id outside the table
+        std::uint64_t unknown = 0;     ///< play or stop of an effect never uploaded
+        std::uint64_t failed = 0;      ///< handshake the backend refused
+        std::uint64_t undelivered = 0; ///< commands the sink could not send
+    };
+
+    /// Registers every device of `manager` whose descriptor has force
+    /// feedback. The manager must not be running yet and must outlive this
+    /// object; so must `sink`. Throws std::system_error or std::logic_error.
+    ForceFeedback(ControllerManager& manager, FfSink& sink);
+    ~ForceFeedback();
+
+    ForceFeedback(const ForceFeedback&) = delete;
+    ForceFeedback& operator=(const ForceFeedback&) = delete;
+
+    /// Waits up to `timeout_ms` for requests and handles those pending.
+    /// Returns the number of events handled.
+    std::size_t poll(int timeout_ms) noexcept;
+
+    /// Runs poll() on a background thread until stop().
+    void start();
+    void stop() noexcept;
+
+    /// Devices with force feedback.
+    [[nodiscard]] std::size_t device_count() const noexcept { return devices_.size(); }
+
+    /// Effect `id` of manager device `device` as last uploaded, or nullptr.
+    /// Same consistency rules as stats().
+    [[nodiscard]] const ff_effect* effect(std::size_t device, int id) const noexcept;
+
+    /// Counters; only consistent when read from the polling thread or after stop().
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    struct Slot {
+        ff_effect effect{};
+        bool loaded = false;
+        bool playing = false;
+    };
+
+    struct Device {
+        DeviceBackend* backend = nullptr;
+        std::uint16_t index = 0; // in the manager
+        std::vector<Slot> slots;
+    };
+
+    std::size_t drain(Device& device) noexcept;
+    void upload(Device& device, std::uint32_t request) noexcept;
+    void erase(Device& device, std::uint32_t request) noexcept;
+    void play(Device& device, std::uint16_t code, std::int32_t value) noexcept;
+    void forward(const FfPacket& packet) noexcept;
+
+    FfSink& sink_;
+    int epoll_fd_ = -1;
+    std::vector<Device> devices_;
+    std::vector<std::int32_t> by_index_; // manager index -> devices_, or -1
+    Stats stats_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+} // namespace vjc
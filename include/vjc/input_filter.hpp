@@ -0,0 +1,86 @@
+#pragma once
+
+#include "vjc/aligned_buffer.hpp"
+#include "vjc/cpu_features.hpp"
+#include "vjc/joystick_state.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc {
+
+enum class FilterKind : std::uint8_t {
+    None,
+    Ema,     ///< exponential moving average, time constant 1 / (2 pi min_cutoff)
+    OneEuro, ///< cutoff rises with speed: min_cutoff + beta * |velocity|
+    Kalman,  ///< constant-velocity model
+};
+
+/// Smoothing of one axis. Values are in full-scale units (1 = full
+/// deflection), so parameters do not depend on the axis range; frequencies
+/// are in Hz. Every filter keeps a velocity estimate, which `lead_ms`
+/// extrapolates along to hide transport latency.
+struct AxisFilter {
+    FilterKind kind = FilterKind::None;
+    float min_cutoff = 1.0f;        ///< Ema, OneEuro
+    float beta = 0.0f;              ///< OneEuro, per full scale per second
+    float derivative_cutoff = 1.0f; ///< Ema, OneEuro: smoothing of the velocity
+    float process_noise = 50.0f;    ///< Kalman: acceleration noise density
+    float measurement_noise = 1e-4f; ///< Kalman: variance of one sample
+    float lead_ms = 0.0f;           ///< prediction horizon, in [0, 100]
+};
+
+/// Jitter filters with optional prediction for every axis of many devices.
+///
+/// Like AxisProcessor, axis values, parameters and filter state are kept as
+/// structure-of-arrays blocks indexed by (axis, device), and one kernel
+/// (scalar, SSE2 or AVX2, picked at construction) sweeps every axis of every
+/// device; every tier produces bit-identical output. Lanes with different
+/// filter kinds share the pass. All devices advance together: run() is
+/// given the frame time and derives one time step for every lane.
+class InputFilter {
+public:
+    /// Throws std::invalid_argument if `devices` is 0.
+    explicit InputFilter(std::size_t devices, SimdLevel level = detect_simd_level());
+
+    /// Sets the filter of one axis of one device and restarts it from the
+    /// next input. Unconfigured axes pass values through. Throws
+    /// std::invalid_argument on out-of-range values.
+    void configure(std::size_t device, std::size_t axis, const AxisFilter& filter);
+
+    /// Restarts every filter of `device` from its next input, e.g. after the
+    /// source reconnected.
+    void reset(std::size_t device) noexcept;
+
+    /// Copies the axes of `state` into the processing block.
+    void load(std::size_t device, const JoystickState& state) noexcept;
+
+    /// Writes the filtered axes back into `state`; other fields are untouched.
+    void store(std::size_t device, JoystickState& state) const noexcept;
+
+    /// Advances every filter to `now_ns` (CLOCK_MONOTONIC) and filters the
+    /// loaded axes in place.
+    void run(std::uint64_t now_ns) noexcept;
+
+    /// load() + run() + store() for `count` consecutive devices.
+    void process(JoystickState* states, std::size_t count, std::uint64_t now_ns) noexcept;
+
+    [[nodiscard]] std::size_t devices() const noexcept { return devices_; }
+    [[nodiscard]] SimdLevel level() const noexcept { return level_; }
+
+private:
+    std::size_t index(std::size_t device, std::size_t axis) const noexcept { return axis * stride_ + device; }
+    void configure_lane(std::size_t lane, const AxisFilter& filter) noexcept;
+
+    std::size_t devices_;
+    std::size_t stride_;
+    SimdLevel level_;
+    std::uint64_t last_ns_ = 0;
+    AlignedBuffer<std::int16_t> x_;
+    AlignedBuffer<std::int32_t> mode_;
+    AlignedBuffer<std::uint8_t> restart_;
+    AlignedBuffer<float> params_;
+    AlignedBuffer<float> state_;
+};
+
+} // namespace vjc
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+
+namespace vjc {
+
+class IoLoop;
+
+enum class IoBackend {
+    Auto,  ///< io_uring when the kernel allows it, epoll otherwise
+    Uring, ///< io_uring through raw syscalls
+    Epoll, ///< readiness with epoll, then the plain syscall
+};
+
+[[nodiscard]] const char* to_string(IoBackend backend) noexcept;
+
+/// Coroutine run by an IoLoop. It starts when spawned, runs until its first
+/// co_await and is resumed by the loop whenever the awaited operation
+/// completes. The frame frees itself when the coroutine returns; the loop
+/// destroys the frames of tasks still suspended when it is destroyed.
+class IoTask {
+public:
+    struct promise_type {
+        IoLoop* loop = nullptr;
+        promise_type* prev = nullptr;
+        promise_type* next = nullptr;
+
+        ~promise_type();
+        IoTask get_return_object() noexcept
+        {
+            return IoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    IoTask(IoTask&& other) noexcept
+        : handle_(other.handle_)
+    {
+        other.handle_ = nullptr;
+    }
+    IoTask(const IoTask&) = delete;
+    IoTask& operator=(const IoTask&) = delete;
+    /// Destroys a task that was never spawned.
+    ~IoTask()
+    {
+        if (handle_)
+            handle_.destroy();
+    }
+
+private:
+    friend class IoLoop;
+
+    explicit IoTask(std::coroutine_handle<promise_type> handle) noexcept
+        : handle_(handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/// One pending operation; lives in the awaiting coroutine's frame.
+struct IoOp {
+    enum Kind : std::uint8_t { Read, Write, RecvMsg, Yield };
+
+    Kind kind = Read;
+    bool polling = false; // waiting for readiness before retrying
+    int fd = -1;
+    void* buffer = nullptr;
+    std::size_t length = 0;
+    msghdr* message = nullptr;
+    long result = 0; // bytes, or -errno
+    std::coroutine_handle<> waiter;
+    IoOp* next = nullptr; // yielded operations waiting for the next turn
+};
+
+/// True for an operation result after which the fd will never deliver data
+/// again: end of file, a closed or unsuitable fd, or a device that is gone.
+/// Anything else (a full submission ring, ENOBUFS, ENOMEM) is transient.
+[[nodiscard]] constexpr bool io_result_fatal(long result) noexcept
+{
+    return result == 0 || result == -EBADF || result == -EINVAL || result == -ENODEV || result == -ENXIO
+        || result == -ENOTSOCK;
+}
+
+/// `co_await loop.read(...)` and friends: suspends until the operation
+/// completes and yields its result.
+class IoAwaitable {
+public:
+    IoAwaitable(IoLoop& loop, const IoOp& op) noexcept
+        : loop_(loop)
+        , op_(op)
+    {
+    }
+
+    bool await_ready() const noexcept { return false; }
+    inline bool await_suspend(std::coroutine_handle<> waiter) noexcept;
+    /// Bytes transferred, or -errno.
+    long await_resume() const noexcept { return op_.result; }
+
+private:
+    IoLoop& loop_;
+    IoOp op_;
+};
+
+/// Single-threaded completion loop for coroutine I/O.
+///
+/// Tasks co_await reads, writes and socket receives on non-blocking fds;
+/// one thread calling run_once() drives all of them. With io_uring the
+/// operations of every task are queued in the submission ring and handed to
+/// the kernel in one io_uring_enter() per turn, which also reaps the
+/// completions; an operation that finds its fd not ready is re-armed as a
+/// poll and retried. With epoll an operation is tried at once, and only
+/// parked on the fd's readiness when it would block. Both backends resume
+/// tasks in completion order. Not thread-safe: one thread owns a loop.
+class IoLoop {
+public:
+    /// Creates a loop with room for `entries` operations in flight. Auto
+    /// falls back to epoll if io_uring is missing, disabled or too old (it
+    /// needs IORING_FEAT_EXT_ARG, Linux 5.11); asking for Uring then throws
+    /// std::system_error.
+    static std::unique_ptr<IoLoop> create(IoBackend backend = IoBackend::Auto, unsigned entries = 256);
+
+    /// Cancels pending operations and destroys every suspended task.
+    virtual ~IoLoop();
+
+    IoLoop(const IoLoop&) = delete;
+    IoLoop& operator=(const IoLoop&) = delete;
+
+    [[nodiscard]] virtual IoBackend backend() const noexcept = 0;
+
+    [[nodiscard]] IoAwaitable read(int fd, void* buffer, std::size_t length) noexcept
+    {
+        return IoAwaitable(*this, {IoOp::Read, false, fd, buffer, length, nullptr, 0, {}});
+    }
+
+    [[nodiscard]] IoAwaitable write(int fd, const void* buffer, std::size_t length) noexcept
+    {
+        return IoAwaitable(*this, {IoOp::Write, false, fd, const_cast<void*>(buffer), length, nullptr, 0, {}});
+    }
+
+    [[nodiscard]] IoAwaitable recvmsg(int fd, msghdr* message) noexcept
+    {
+        return IoAwaitable(*this, {IoOp::RecvMsg, false, fd, nullptr, 0, message, 0, {}});
+    }
+
+    /// Suspends until the next run_once(), after its completions. A task
+    /// backs off this way after a transient error instead of retrying in a
+    /// loop that never lets the loop submit or reap.
+    [[nodiscard]] IoAwaitable yield() noexcept
+    {
+        return IoAwaitable(*this, {IoOp::Yield, false, -1, nullptr, 0, nullptr, 0, {}});
+    }
+
+    /// Starts `task` on this loop; it runs until its first suspension.
+    void spawn(IoTask task) noexcept;
+
+    /// Submits queued operations, waits up to `timeout_ms` (-1: forever) for
+    /// at least one completion and resumes the tasks whose operations
+    /// finished. Returns the number resumed.
+    virtual std::size_t run_once(int timeout_ms) noexcept = 0;
+
+    /// Tasks spawned and not yet finished.
+    [[nodiscard]] std::size_t tasks() const noexcept { return tasks_; }
+
+protected:
+    IoLoop() = default;
+
+    /// Performs or queues `op`. Returns true if it already completed, in
+    /// which case the caller carries on without suspending.
+    virtual bool start(IoOp& op) noexcept = 0;
+
+    /// Destroys the frames of unfinished tasks; backends call it from their
+    /// destructor once nothing can complete into those frames any more.
+    void destroy_tasks() noexcept;
+
+    /// Whether a task yielded; run_once() must then not block.
+    [[nodiscard]] bool yielded() const noexcept { return yielded_ != nullptr; }
+
+    /// Resumes the tasks that yielded before this call, in order. Backends
+    /// call it at the end of run_once(). Returns the number resumed.
+    std::size_t resume_yielded() noexcept;
+
+private:
+    friend class IoAwaitable;
+    friend struct IoTask::promise_type;
+
+    void defer(IoOp& op) noexcept;
+
+    IoTask::promise_type* head_ = nullptr;
+    std::size_t tasks_ = 0;
+    IoOp* yielded_ = nullptr;
+    IoOp** yielded_tail_ = &yielded_;
+};
+
+bool IoAwaitable::await_suspend(std::coroutine_handle<> waiter) noexcept
+{
+    op_.waiter = waiter;
+    if (op_.kind == IoOp::Yield) {
+        loop_.defer(op_);
+        return true;
+    }
+    return !loop_.start(op_);
+}
+
+} // namespace vjc
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "vjc/platform.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc {
+
+inline constexpr std::size_t kMaxAxes = 8;
+inline constexpr std::size_t kMaxTriggers = 2;
+inline constexpr std::size_t kMaxHats = 2;
+inline constexpr std::size_t kMaxButtons = 64;
+
+/// Logical controller state for one frame: the shared currency between
+/// transports, mapping and device sinks.
+///
+/// Sticks are signed 16-bit, triggers unsigned 16-bit, hats take -1, 0 or 1
+/// per direction and buttons are one bit each. How the fields map onto evdev
+/// codes is decided by the device's DeviceDescriptor. `timestamp_ns` is the
+/// monotonic time the state was produced and `sequence` a per-source frame
+/// counter; both are bookkeeping and never emitted. The whole state fits in
+/// one cache line so a hand-off between threads touches exactly one line.
+struct alignas(kCacheLineSize) JoystickState {
+    std::uint64_t buttons = 0;
+    std::uint64_t timestamp_ns = 0;
+    std::array<std::int16_t, kMaxAxes> axes{};
+    std::array<std::uint16_t, kMaxTriggers> triggers{};
+    std::array<std::int8_t, kMaxHats * 2> hats{};
+    std::uint32_t sequence = 0;
+
+    [[nodiscard]] constexpr bool button(unsigned index) const noexcept
+    {
+        return (buttons >> index) & 1u;
+    }
+
+    constexpr void set_button(unsigned index, bool pressed) noexcept
+    {
+        const std::uint64_t bit = std::uint64_t{1} << index;
+        buttons = pressed ? (buttons | bit) : (buttons & ~bit);
+    }
+
+    /// Equal when both would emit the same events; `timestamp_ns` and
+    /// `sequence` are not compared.
+    friend constexpr bool operator==(const JoystickState& a, const JoystickState& b) noexcept
+    {
+        return a.buttons == b.buttons && a.axes == b.axes && a.triggers == b.triggers && a.hats == b.hats;
+    }
+};
+
+static_assert(sizeof(JoystickState) == kCacheLineSize, "JoystickState must occupy exactly one cache line");
+
+} // namespace vjc
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "vjc/joystick_state.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace vjc {
+
+enum class RuleKind : std::uint8_t {
+    Button,       ///< button -> button
+    Chord,        ///< all of several buttons -> set of buttons
+    Macro,        ///< all of several buttons -> timed button sequence
+    Toggle,       ///< each press flips a latched output button
+    Turbo,        ///< held button -> output pulsing every `period` frames
+    Axis,         ///< axis -> axis, optionally inverted
+    AxisToButton, ///< axis strictly past `threshold` -> button
+    AxisToHat,    ///< axis pair -> 8-way hat
+};
+
+struct MacroStep {
+    std::uint64_t buttons = 0;
+    std::uint16_t frames = 1;
+};
+
+/// One declarative rule. Which fields matter depends on `kind`.
+struct MappingRule {
+    RuleKind kind = RuleKind::Button;
+    std::uint64_t inputs = 0;  ///< source buttons; one bit except for Chord and Macro
+    std::uint64_t outputs = 0; ///< target buttons
+    std::uint8_t axis = 0;     ///< source axis, or the X axis of AxisToHat
+    std::uint8_t axis_y = 0;   ///< Y axis of AxisToHat
+    std::uint8_t target = 0;   ///< target axis or hat
+    bool invert = false;
+    bool below = false;         ///< AxisToButton: fires below `threshold` rather than above
+    std::int16_t threshold = 0; ///< AxisToButton: signed axis value; AxisToHat: deadzone
+    std::uint16_t period = 1;   ///< Turbo half-period in frames
+    std::vector<MacroStep> steps;
+};
+
+/// Rules as written by the user.
+///
+/// The text form has one rule per line; `#` starts a comment. Buttons are
+/// `b0`..`b63`, axes `a0`..`a7`, hats `hat0`..`hat1`:
+///
+///   b0 -> b3                        remap (a source may feed several targets)
+///   b4+b5 -> b10 b11                chord
+///   b4+b6 -> macro b0:3 -:2 b0+b1:1 chord macro, steps are buttons:frames
+///   toggle b2 -> b7
+///   turbo b1 -> b1 every 4
+///   a0 -> a2 invert
+///   a2 -> b9 when > 16000           fires for a2 > 16000
+///   a3 -> b8 when < -12000          fires for a3 < -12000
+///   a0 a1 -> hat0 deadzone 8000
+struct MappingProfile {
+    std::vector<MappingRule> rules;
+
+    /// Throws std::invalid_argument naming the offending line.
+    static MappingProfile parse(std::string_view text);
+};
+
+class CompiledMapping;
+
+/// Per-device runtime state of a mapping: toggles, turbo counters, macros.
+class MappingState {
+public:
+    MappingState() = default;
+    explicit MappingState(const CompiledMapping& mapping) { reset(mapping); }
+
+    /// Sizes and clears the state for `mapping`; allocates, so call it when a
+    /// mapping is installed, not per frame.
+    void reset(const CompiledMapping& mapping);
+
+private:
+    friend class CompiledMapping;
+
+    struct Macro {
+        std::int32_t step = -1;
+        std::uint16_t left = 0;
+    };
+
+    std::uint64_t previous = 0;
+    std::uint64_t latched = 0;
+    std::array<std::uint32_t, kMaxButtons> turbo{};
+    std::vector<std::uint8_t> chord_held;
+    std::vector<Macro> macros;
+    std::uint32_t running = 0; // macros with step >= 0
+};
+
+/// A profile compiled to flat tables at load time.
+///
+/// Per frame the cost does not depend on the number of remap rules: buttons
+/// go through eight 256-entry tables indexed by the bytes of the input mask,
+/// so any set of button -> button rules costs eight loads and ORs. Chords are
+/// bucketed by their lowest button and only tested when that button is down;
+/// toggles and turbos are walked over the set bits of changed or held
+/// sources; axis thresholds are a binary search per axis. Buttons no rule
+/// reads pass through unchanged, as do axes.
+class CompiledMapping {
+public:
+    /// Throws std::invalid_argument for rules that cannot be combined, such
+    /// as two toggles driving the same output.
+    explicit CompiledMapping(const MappingProfile& profile);
+
+    /// Maps `in` into `out`; `state` must have been reset for this mapping.
+    void apply(const JoystickState& in, MappingState& state, JoystickState& out) const noexcept;
+
+    [[nodiscard]] std::size_t rule_count() const noexcept { return rules_; }
+
+private:
+    friend class MappingState;
+    friend class ProfileCache;
+
+    CompiledMapping() = default;
+
+    struct Chord {
+        std::uint64_t mask;
+        std::uint64_t outputs;
+        std::int32_t macro; // index into macros_, or -1
+    };
+
+    struct MacroRange {
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+
+    // One per target axis or hat: a later rule for the same target replaces
+    // an earlier one.
+    struct AxisOp {
+        RuleKind kind;
+        std::uint8_t axis;
+        std::uint8_t axis_y;
+        std::uint8_t target;
+        bool invert;
+        std::int16_t deadzone;
+    };
+
+    // AxisToButton thresholds of one axis and direction, sorted so the ones
+    // a value passes form a prefix; `buttons` accumulates over that prefix.
+    struct Threshold {
+        std::int16_t value;
+        std::uint64_t buttons;
+    };
+
+    struct Range {
+        std::uint32_t first = 0;
+        std::uint32_t count = 0;
+    };
+
+    std::size_t rules_ = 0;
+    std::array<std::array<std::uint64_t, 256>, 8> buttons_{};
+    std::uint64_t consumed_ = 0; // toggle and turbo sources, never remapped
+    std::array<std::uint32_t, kMaxButtons + 1> chord_start_{};
+    std::uint64_t chord_keys_ = 0;
+    std::vector<Chord> chords_;
+    std::vector<MacroRange> macros_;
+    std::vector<MacroStep> steps_;
+    std::uint64_t toggle_sources_ = 0;
+    std::array<std::uint64_t, kMaxButtons> toggle_outputs_{};
+    std::uint64_t turbo_sources_ = 0;
+    std::array<std::uint64_t, kMaxButtons> turbo_outputs_{};
+    std::array<std::uint16_t, kMaxButtons> turbo_period_{};
+    std::uint8_t cleared_axes_ = 0; // axis sources not rewritten by an Axis rule
+    std::vector<AxisOp> axis_ops_;
+    std::array<Range, kMaxAxes> above_{};
+    std::array<Range, kMaxAxes> below_{};
+    std::vector<Threshold> thresholds_;
+};
+
+} // namespace vjc
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "vjc/aligned_buffer.hpp"
+#include "vjc/cpu_features.hpp"
+#include "vjc/device_backend.hpp"
+#include "vjc/device_descriptor.hpp"
+
+#include <linux/input.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace vjc {
+
+/// One raw 6-axis reading as an IMU delivers it.
+struct MotionSample {
+    std::array<std::int16_t, 3> accel{}; ///< sensor counts
+    std::array<std::int16_t, 3> gyro{};
+    std::uint64_t timestamp_ns = 0; ///< sensor clock, any epoch
+};
+
+/// A sample after calibration, in the descriptor's units.
+struct MotionReading {
+    std::array<std::int32_t, 3> accel{};
+    std::array<std::int32_t, 3> gyro{};
+    std::uint64_t timestamp_ns = 0;
+};
+
+/// Bias, per-axis scale and mounting of one 3-axis sensor:
+/// out = matrix * (raw - bias). The matrix folds the counts-to-units scale
+/// into the rotation from the sensor's frame to the controller's.
+struct SensorCalibration {
+    std::array<std::int16_t, 3> bias{};
+    std::array<float, 9> matrix{1, 0, 0, 0, 1, 0, 0, 0, 1}; ///< row-major, entries in [-4, 4]
+};
+
+struct MotionCalibration {
+    SensorCalibration accel;
+    SensorCalibration gyro;
+};
+
+/// Fixed-point calibration of motion samples.
+///
+/// Samples are transposed into structure-of-arrays blocks of kBlock and each
+/// sensor is run through a Q12 integer kernel picked once at construction
+/// (scalar, SSE2 or AVX2); every tier produces bit-identical output.
+class MotionCalibrator {
+public:
+    static constexpr std::size_t kBlock = 64;
+
+    explicit MotionCalibrator(SimdLevel level = detect_simd_level());
+
+    /// Throws std::invalid_argument if a matrix entry is outside [-4, 4].
+    void configure(const MotionCalibration& calibration);
+
+    /// Calibrates `count` samples into `out`.
+    void apply(const MotionSample* in, std::size_t count, MotionReading* out) noexcept;
+
+    [[nodiscard]] SimdLevel level() const noexcept { return level_; }
+
+private:
+    SimdLevel level_;
+    std::int16_t bias_[2][3]{};
+    std::int16_t matrix_[2][9]{};
+    AlignedBuffer<std::int16_t> raw_;
+    AlignedBuffer<std::int32_t> out_;
+};
+
+/// Events one motion report takes: six axes, MSC_TIMESTAMP and SYN_REPORT.
+inline constexpr std::size_t kMotionReportEvents = 8;
+
+/// Virtual motion-sensor node, the IMU half of a controller.
+///
+/// Samples arrive in batches from the sensor transport at 1 kHz or more.
+/// Each submit() calibrates the batch, encodes one report per sample (all
+/// six axes, MSC_TIMESTAMP in microseconds and SYN_REPORT) into a
+/// preallocated buffer and hands up to kMaxBatch reports to the backend in
+/// a single write. Not thread-safe: one thread owns a sensor.
+class MotionSensor {
+public:
+    static constexpr std::size_t kMaxBatch = MotionCalibrator::kBlock;
+
+    struct Stats {
+        std::uint64_t samples = 0;
+        std::uint64_t events = 0;
+        std::uint64_t writes = 0;
+        std::uint64_t failed_writes = 0;
+    };
+
+    /// Creates the device on `backend`. Throws std::invalid_argument unless
+    /// the descriptor has exactly six axes (accelerometer x, y, z, then
+    /// gyroscope x, y, z), declares MSC_TIMESTAMP and nothing else to report;
+    /// throws if the backend refuses it.
+    MotionSensor(std::unique_ptr<DeviceBackend> backend,
+                 DeviceDescriptor descriptor = DeviceDescriptor::motion_sensor(),
+                 SimdLevel level = detect_simd_level());
+
+    /// Convenience constructor for a real /dev/uinput device.
+    static std::unique_ptr<MotionSensor> open_uinput(DeviceDescriptor descriptor = DeviceDescriptor::motion_sensor(),
+                                                     const std::string& path = "/dev/uinput");
+
+    /// See MotionCalibrator::configure().
+    void calibrate(const MotionCalibration& calibration) { calibrator_.configure(calibration); }
+
+    /// Emits one report per sample, in order. Returns the number of events
+    /// written. A write the backend refuses is dropped rather than retried:
+    /// the next samples supersede it.
+    std::size_t submit(std::span<const MotionSample> samples) noexcept;
+
+    [[nodiscard]] const DeviceDescriptor& descriptor() const noexcept { return descriptor_; }
+    [[nodiscard]] DeviceBackend& backend() noexcept { return *backend_; }
+    [[nodiscard]] SimdLevel level() const noexcept { return calibrator_.level(); }
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    std::unique_ptr<DeviceBackend> backend_;
+    DeviceDescriptor descriptor_;
+    MotionCalibrator calibrator_;
+    std::array<std::uint16_t, 6> codes_{};
+    std::vector<MotionReading> readings_;
+    std::vector<input_event> buffer_;
+    Stats stats_;
+};
+
+} // namespace vjc
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "vjc/wire_format.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc {
+
+/// Datagram layout, all fields little-endian:
+///
+///   u32 magic    'VJC1'
+///   u8  version  kProtocolVersion
+///   u8  flags    PacketFlag bits
+///   u16 device   index of the target device
+///   u32 sequence per-device packet counter, wraps
+///   u32 session  picked at random by each client run
+///   ... one wire_format frame (field mask + fields)
+///
+/// Frames carry absolute field values, so a lost packet only delays the
+/// fields it changed; senders mark every Nth packet as a keyframe with all
+/// fields set to bound that delay. Sequences are only compared within one
+/// session: a new session restarts the device's stream from its sequence.
+inline constexpr std::uint32_t kPacketMagic = 0x314a4356; // "VJC1"
+inline constexpr std::uint8_t kProtocolVersion = 2;
+inline constexpr std::size_t kPacketHeaderSize = 16;
+inline constexpr std::size_t kMaxPacketSize = kPacketHeaderSize + kMaxWireStateSize;
+
+enum PacketFlag : std::uint8_t {
+    kPacketKeyframe = 1u << 0,
+};
+
+struct PacketHeader {
+    std::uint8_t flags = 0;
+    std::uint16_t device = 0;
+    std::uint32_t sequence = 0;
+    std::uint32_t session = 0;
+};
+
+/// Writes the header into `out` (kPacketHeaderSize bytes).
+void encode_packet_header(const PacketHeader& header, std::byte* out) noexcept;
+
+/// Parses and validates the header of a datagram in place. Returns false on
+/// a short datagram, wrong magic or unsupported version.
+bool decode_packet_header(const std::byte* in, std::size_t size, PacketHeader& header) noexcept;
+
+/// Force-feedback datagram, server to client, little-endian:
+///
+///   u32 magic     'VJF1'
+///   u8  version   kProtocolVersion
+///   u8  command   FfCommand
+///   u16 device
+///   u16 effect    id the game's kernel assigned at upload
+///   u16 type      FF_RUMBLE, FF_PERIODIC, FF_CONSTANT, ...
+///   u32 value     play count, or gain for kFfGain
+///   u16 length_ms, delay_ms
+///   u16 waveform, period_ms   FF_PERIODIC only
+///   u16 strong, weak          rumble motors; periodic magnitude and offset
+///                             and constant level as raw s16 bits
+///
+/// A play carries the effect's parameters, so a client need not track
+/// uploads; a stop only names the effect.
+inline constexpr std::uint32_t kFfPacketMagic = 0x31464a56; // "VJF1"
+inline constexpr std::size_t kFfPacketSize = 28;
+
+enum FfCommand : std::uint8_t {
+    kFfPlay = 1,
+    kFfStop = 2,
+    kFfGain = 3,
+};
+
+struct FfPacket {
+    std::uint8_t command = 0;
+    std::uint16_t device = 0;
+    std::uint16_t effect = 0;
+    std::uint16_t type = 0;
+    std::uint32_t value = 0;
+    std::uint16_t length_ms = 0;
+    std::uint16_t delay_ms = 0;
+    std::uint16_t waveform = 0;
+    std::uint16_t period_ms = 0;
+    std::uint16_t strong = 0;
+    std::uint16_t weak = 0;
+};
+
+/// Writes `packet` into `out` (kFfPacketSize bytes).
+void encode_ff_packet(const FfPacket& packet, std::byte* out) noexcept;
+
+/// Parses a force-feedback datagram. Returns false on a wrong size, magic,
+/// version or command.
+bool decode_ff_packet(const std::byte* in, std::size_t size, FfPacket& packet) noexcept;
+
+/// True if `sequence` is newer than `last` under 32-bit wrap-around.
+constexpr bool sequence_newer(std::uint32_t sequence, std::uint32_t last) noexcept
+{
+    return static_cast<std::int32_t>(sequence - last) > 0;
+}
+
+} // namespace vjc
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace vjc {
+
+/// Fixed-capacity pool of recycled objects, addressed by index.
+///
+/// Every object is constructed up front. acquire() and release() only move
+/// indices on and off a free stack, so neither allocates nor runs a
+/// constructor, and released objects keep their state for the caller to
+/// reset. Indices are stable, which lets pooled objects link to each other
+/// with 32-bit indices instead of pointers. Not thread-safe.
+template <typename T>
+class ObjectPool {
+public:
+    static constexpr std::uint32_t kNone = ~std::uint32_t{0};
+
+    /// Throws std::invalid_argument if `capacity` is 0 or does not fit an index.
+    explicit ObjectPool(std::size_t capacity)
+        : objects_(capacity)
+    {
+        if (capacity == 0 || capacity >= kNone)
+            throw std::invalid_argument("ObjectPool: bad capacity");
+        free_.reserve(capacity);
+        for (std::size_t i = capacity; i-- > 0;)
+            free_.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    /// Index of a free object, or kNone when all are in use. Lower indices
+    /// are handed out first.
+    [[nodiscard]] std::uint32_t acquire() noexcept
+    {
+        if (free_.empty())
+            return kNone;
+        const std::uint32_t index = free_.back();
+        free_.pop_back();
+        if (in_use() > high_water_)
+            high_water_ = in_use();
+        return index;
+    }
+
+    /// Returns an acquired object to the pool.
+    void release(std::uint32_t index) noexcept { free_.push_back(index); }
+
+    T& operator[](std::uint32_t index) noexcept { return objects_[index]; }
+    const T& operator[](std::uint32_t index) const noexcept { return objects_[index]; }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return objects_.size(); }
+    [[nodiscard]] std::size_t available() const noexcept { return free_.size(); }
+    [[nodiscard]] std::size_t in_use() const noexcept { return objects_.size() - free_.size(); }
+    /// Most objects ever in use at once.
+    [[nodiscard]] std::size_t high_water() const noexcept { return high_water_; }
+
+private:
+    std::vector<T> objects_;
+    std::vector<std::uint32_t> free_; // never grows past its reserve
+    std::size_t high_water_ = 0;
+};
+
+} // namespace vjc
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "vjc/joystick_state.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc {
+
+enum class SchedulePolicy {
+    /// Every state is emitted as soon as it arrives.
+    Passthrough,
+    /// At most one frame per period, on a fixed grid of ticks.
+    FixedRate,
+    /// A change is emitted at once unless the previous frame went out less
+    /// than `period_ns` ago, in which case it waits for that interval.
+    Adaptive,
+};
+
+struct ScheduleConfig {
+    SchedulePolicy policy = SchedulePolicy::Passthrough;
+    std::uint64_t period_ns = 1'000'000; ///< tick length / minimum interval
+};
+
+/// Merges incoming states and decides when a device frame goes out.
+///
+/// All intermediate states of a tick collapse into the latest one, except
+/// button edges: a button pressed and released (or released and pressed)
+/// within one tick is emitted as an extra frame showing the transient value,
+/// so a game polling the device still observes the tap. Time is passed in by
+/// the caller, which keeps the scheduler deterministic under a fake clock.
+class OutputScheduler {
+public:
+    /// Frames a single poll() can produce.
+    static constexpr std::size_t kMaxFrames = 2;
+    static constexpr std::uint64_t kNoDeadline = ~std::uint64_t{0};
+
+    explicit OutputScheduler(const ScheduleConfig& config = {}) noexcept
+        : config_(config)
+    {
+    }
+
+    /// Merges a newly received state.
+    void push(const JoystickState& state) noexcept
+    {
+        const std::uint64_t changed = state.buttons ^ pending_.buttons;
+        pressed_ |= changed & state.buttons;
+        released_ |= changed & ~state.buttons;
+        pending_ = state;
+        dirty_ = true;
+        ++pushed_;
+    }
+
+    /// Writes the frames due at `now_ns` into `out` (room for kMaxFrames) and
+    /// returns how many there are.
+    std::size_t poll(std::uint64_t now_ns, JoystickState* out) noexcept;
+
+    /// Time at which poll() will next produce a frame, or kNoDeadline when
+    /// nothing is pending.
+    [[nodiscard]] std::uint64_t deadline() const noexcept;
+
+    /// States that were merged away instead of being emitted.
+    [[nodiscard]] std::uint64_t coalesced() const noexcept { return pushed_ - emits_; }
+
+    /// Extra frames emitted to preserve button taps.
+    [[nodiscard]] std::uint64_t edge_frames() const noexcept { return edge_frames_; }
+
+    [[nodiscard]] const ScheduleConfig& config() const noexcept { return config_; }
+
+private:
+    ScheduleConfig config_;
+    JoystickState pending_{};
+    JoystickState last_frame_{};
+    std::uint64_t pressed_ = 0;  // buttons that went down since the last frame
+    std::uint64_t released_ = 0; // buttons that went up since the last frame
+    std::uint64_t next_tick_ = 0;
+    std::uint64_t last_emit_ = 0;
+    bool dirty_ = false;
+    bool started_ = false;
+    std::uint64_t pushed_ = 0;
+    std::uint64_t emits_ = 0;
+    std::uint64_t edge_frames_ = 0;
+};
+
+} // namespace vjc
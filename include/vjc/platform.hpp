@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+namespace vjc {
+
+/// Alignment used to keep data written by different threads on separate
+/// cache lines. Fixed rather than std::hardware_destructive_interference_size
+/// so the layout does not change with compiler flags.
+inline constexpr std::size_t kCacheLineSize = 64;
+
+/// Busy-wait hint: lets the sibling hyperthread run and saves power.
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+} // namespace vjc
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "vjc/device_descriptor.hpp"
+#include "vjc/profile_store.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vjc {
+
+/// Cache file layout, native byte order (a cache never leaves its host):
+///
+///   header (kProfileCacheHeaderSize bytes)
+///     u32 magic           'VJCC'
+///     u16 version         kProfileCacheVersion
+///     u16 reserved
+///     u64 layout          fingerprint of the compiled table layout
+///     u64 source_hash     hash of the profile text the tables came from
+///     u64 source_size
+///     u64 payload_size
+///     u64 payload_hash    hash of the payload bytes
+///   payload
+///     compiled mapping tables, each array aligned for its element type
+///     curve presets by number, custom curve tables cache-line aligned
+///     device descriptors
+///
+/// A file written by another build, for other text, or damaged in any byte
+/// is rejected and rebuilt by the caller.
+inline constexpr std::uint32_t kProfileCacheMagic = 0x43434a56; // "VJCC"
+inline constexpr std::uint16_t kProfileCacheVersion = 4;
+inline constexpr std::size_t kProfileCacheHeaderSize = 64;
+
+/// Compiled profiles saved to disk so a restart skips parsing and baking.
+///
+/// load() maps the file, checks it against the profile text and copies the
+/// mapping tables out; custom curve tables are used in place from the
+/// mapping, which stays mapped for as long as a curve refers to it. store()
+/// writes a temporary file and renames it over the old one, so a reader never
+/// sees a half-written cache and a mapped one is never truncated under it.
+class ProfileCache {
+public:
+    enum class Status {
+        Hit,
+        Missing, ///< no file, or not readable
+        Stale,   ///< written for other text or by another build
+        Corrupt, ///< truncated or checksum mismatch
+    };
+
+    explicit ProfileCache(std::string path);
+
+    /// The profile compiled from `source`, or nullptr when the file does not
+    /// hold one (see status()). `descriptors`, if given, receives the device
+    /// descriptors stored with it.
+    [[nodiscard]] std::unique_ptr<Profile> load(std::string_view source, std::uint64_t version, std::size_t devices,
+                                                std::vector<DeviceDescriptor>* descriptors = nullptr);
+
+    /// Saves `profile`, which must have been compiled from `source`, along
+    /// with `descriptors`. Throws std::system_error.
+    void store(std::string_view source, const Profile& profile,
+               std::span<const DeviceDescriptor> descriptors = {}) const;
+
+    /// Outcome of the last load().
+    [[nodiscard]] Status status() const noexcept { return status_; }
+    [[nodiscard]] const std::string& path() const noexcept { return path_; }
+
+private:
+    [[nodiscard]] static std::uint64_t layout() noexcept;
+
+    std::string path_;
+    Status status_ = Status::Missing;
+};
+
+[[nodiscard]] const char* to_string(ProfileCache::Status status) noexcept;
+
+} // namespace vjc
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "vjc/mapping.hpp"
+#include "vjc/rcu_cell.hpp"
+#include "vjc/response_curve.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace vjc {
+
+class ProfileCache;
+
+/// A compiled mapping plus axis curves, immutable once published except for
+/// the per-device mapping state, which only that device's writer touches.
+struct Profile {
+    Profile(std::uint64_t version, const MappingProfile& rules, CurveSet curves, std::size_t devices);
+    Profile(std::uint64_t version, CompiledMapping mapping, CurveSet curves, std::size_t devices);
+
+    /// Parses the mapping text format of MappingProfile, extended with
+    /// `curve aN <linear|gamma15|quadratic|cubic|expo50>` and
+    /// `curve aN gamma X` lines. Throws std::invalid_argument naming the
+    /// offending line.
+    static Profile parse(std::string_view text, std::uint64_t version, std::size_t devices);
+
+    /// Maps and shapes `in` for `device` into `out`.
+    void apply(std::size_t device, const JoystickState& in, JoystickState& out) const noexcept
+    {
+        mapping.apply(in, states[device], out);
+        curves.apply(out);
+    }
+
+    std::uint64_t version;
+    CompiledMapping mapping;
+    CurveSet curves;
+    /// Sized and reset at load so the emit path never allocates; a new
+    /// profile starts with fresh toggles, turbos and macros.
+    mutable std::vector<MappingState> states;
+};
+
+/// Hot-reloadable profile shared by the devices of a ControllerManager.
+///
+/// Profiles are parsed and compiled off the emit path, either by the caller
+/// of load() or by a loader thread fed through load_async(), and installed
+/// with a single pointer swap. Readers pin the current profile for the
+/// duration of one frame, so a frame started on the old profile finishes on
+/// it and the next one sees the new profile; the old profile is freed once
+/// no reader can still hold it. Reading takes no lock and never allocates.
+class ProfileStore {
+public:
+    /// `readers` is the number of threads that may call read() concurrently,
+    /// each with its own id below it; `devices` sizes the mapping state.
+    ProfileStore(std::size_t devices, unsigned readers);
+    ~ProfileStore();
+
+    ProfileStore(const ProfileStore&) = delete;
+    ProfileStore& operator=(const ProfileStore&) = delete;
+
+    /// Parses, compiles and publishes `text` on the calling thread. Throws
+    /// std::invalid_argument and keeps the current profile on bad input.
+    /// Returns the new version.
+    std::uint64_t load(std::string_view text);
+
+    /// Like load(), but takes the compiled profile from `cache` when it was
+    /// built from `text` and rewrites the cache otherwise; see
+    /// cache.status(). Failing to write the cache is not an error.
+    std::uint64_t load(std::string_view text, ProfileCache& cache);
+
+    /// Queues `text` for the loader thread. Texts queued behind a newer one
+    /// are skipped. Failures are counted in failed_loads() and leave the
+    /// current profile in place.
+    void load_async(std::string text);
+
+    /// Waits until every queued profile has been loaded or rejected.
+    void flush();
+
+    /// Profile to use for one frame on reader `reader`; may be empty before
+    /// the first load.
+    [[nodiscard]] RcuCell<Profile>::ReadGuard read(unsigned reader) noexcept { return cell_.read(reader); }
+
+    [[nodiscard]] std::size_t device_count() const noexcept { return devices_; }
+    [[nodiscard]] unsigned reader_count() const noexcept { return cell_.readers(); }
+
+    /// Version of the last published profile, 0 before the first load.
+    [[nodiscard]] std::uint64_t version() const noexcept;
+    [[nodiscard]] std::uint64_t failed_loads() const noexcept;
+    [[nodiscard]] std::string last_error() const;
+
+private:
+    void run_loader() noexcept;
+
+    std::size_t devices_;
+    RcuCell<Profile> cell_;
+    std::mutex load_mutex_; // serialises compile + publish so versions stay ordered
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::deque<std::string> queue_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    std::uint64_t version_ = 0;
+    std::uint64_t failed_ = 0;
+    std::string last_error_;
+    std::thread loader_;
+};
+
+} // namespace vjc
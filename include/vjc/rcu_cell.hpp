@@ -0,0 +1,145 @@
+#pragma once
+
+#include "vjc/platform.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace vjc {
+
+/// A pointer that a fixed set of reader threads dereference wait-free while
+/// writers replace it, with epoch-based deferred reclamation.
+///
+/// Reader `i` announces the epoch it starts in on its own cache line, loads
+/// the pointer and clears the announcement when its guard goes away: two
+/// stores and two loads, no read-modify-write and no lock. publish() swaps
+/// the pointer, advances the epoch and retires the old object; reclaim()
+/// frees retired objects once every reader is either idle or started after
+/// they were retired. Writers serialise on a mutex that readers never touch.
+template <typename T>
+class RcuCell {
+public:
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept
+            : slot_(std::exchange(other.slot_, nullptr))
+            , value_(other.value_)
+        {
+        }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+
+        ~ReadGuard()
+        {
+            if (slot_)
+                slot_->store(0, std::memory_order_release);
+        }
+
+        [[nodiscard]] const T* get() const noexcept { return value_; }
+        const T* operator->() const noexcept { return value_; }
+        const T& operator*() const noexcept { return *value_; }
+        explicit operator bool() const noexcept { return value_ != nullptr; }
+
+    private:
+        friend class RcuCell;
+
+        ReadGuard(std::atomic<std::uint64_t>* slot, const T* value) noexcept
+            : slot_(slot)
+            , value_(value)
+        {
+        }
+
+        std::atomic<std::uint64_t>* slot_;
+        const T* value_;
+    };
+
+    explicit RcuCell(unsigned readers, std::unique_ptr<T> initial = nullptr)
+        : slots_(readers)
+        , current_(initial.release())
+    {
+        if (readers == 0)
+            throw std::invalid_argument("RcuCell: at least one reader is required");
+    }
+
+    ~RcuCell() { delete current_.load(std::memory_order_relaxed); }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    [[nodiscard]] unsigned readers() const noexcept { return static_cast<unsigned>(slots_.size()); }
+
+    /// Pins the current object for reader `reader` (< readers()). A reader
+    /// must not hold two guards at once.
+    [[nodiscard]] ReadGuard read(unsigned reader) noexcept
+    {
+        // The epoch load is acquire so that the pointer loaded below is at
+        // least as new as the publish that made this epoch current.
+        std::atomic<std::uint64_t>& slot = slots_[reader].epoch;
+        slot.store(epoch_.load(std::memory_order_acquire), std::memory_order_seq_cst);
+        return ReadGuard(&slot, current_.load(std::memory_order_seq_cst));
+    }
+
+    /// Installs `next` for subsequent reads and retires the previous object.
+    void publish(std::unique_ptr<T> next)
+    {
+        std::lock_guard lock(writer_);
+        T* old = current_.exchange(next.release(), std::memory_order_seq_cst);
+        const std::uint64_t epoch = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+        if (old)
+            retired_.push_back({epoch, std::unique_ptr<T>(old)});
+        reclaim_locked();
+    }
+
+    /// Frees retired objects no reader can still see. Returns how many are
+    /// still waiting.
+    std::size_t reclaim()
+    {
+        std::lock_guard lock(writer_);
+        reclaim_locked();
+        return retired_.size();
+    }
+
+private:
+    struct alignas(kCacheLineSize) Slot {
+        std::atomic<std::uint64_t> epoch{0}; // 0 while not reading
+    };
+
+    struct Retired {
+        std::uint64_t epoch;
+        std::unique_ptr<T> object;
+    };
+
+    void reclaim_locked()
+    {
+        if (retired_.empty())
+            return;
+        // Oldest epoch any active reader may have started in.
+        std::uint64_t oldest = ~std::uint64_t{0};
+        for (const Slot& slot : slots_) {
+            const std::uint64_t e = slot.epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e < oldest)
+                oldest = e;
+        }
+        std::size_t kept = 0;
+        for (Retired& r : retired_) {
+            if (r.epoch > oldest)
+                retired_[kept++] = std::move(r);
+        }
+        retired_.resize(kept);
+    }
+
+    std::vector<Slot> slots_;
+    alignas(kCacheLineSize) std::atomic<T*> current_;
+    std::atomic<std::uint64_t> epoch_{1};
+    std::mutex writer_;
+    std::vector<Retired> retired_;
+};
+
+} // namespace vjc
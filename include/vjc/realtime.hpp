@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+namespace vjc {
+
+/// Opt-in real-time settings for latency-critical threads. Every part is
+/// best effort: without CAP_SYS_NICE, a large enough RLIMIT_MEMLOCK or a
+/// spare core the thread simply runs as it would without them.
+struct RealtimeConfig {
+    /// SCHED_FIFO priority (1-99); 0 keeps the default policy.
+    int fifo_priority = 0;
+    /// mlockall(MCL_CURRENT | MCL_FUTURE) so the hot path never page-faults.
+    /// Process-wide, and left in place when the owner stops.
+    bool lock_memory = false;
+    /// How long an idle thread spins on its doorbell before sleeping on the
+    /// futex; 0 sleeps at once. Only pays off with a core to spare, and is
+    /// ignored for a SCHED_FIFO thread on a single-CPU machine.
+    std::uint64_t spin_ns = 0;
+};
+
+/// Restricts the calling thread to `cpu`. Returns false if not allowed.
+bool pin_current_thread(int cpu) noexcept;
+
+/// Moves the calling thread to SCHED_FIFO at `priority`. Returns false,
+/// leaving the thread as it was, when that is not permitted.
+bool set_fifo_priority(int priority) noexcept;
+
+/// Locks the current and future address space into RAM. Returns false when
+/// the limit or the privileges do not allow it.
+bool lock_memory() noexcept;
+
+} // namespace vjc
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "vjc/joystick_state.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace vjc {
+
+/// One entry per possible 16-bit axis value, indexed by the value's bit
+/// pattern (`static_cast<std::uint16_t>(v)`).
+using CurveTable = std::array<std::int16_t, 65536>;
+
+namespace detail {
+
+constexpr double constexpr_sqrt(double x) noexcept
+{
+    if (x <= 0.0)
+        return 0.0;
+    double r = x < 1.0 ? 1.0 : x;
+    for (int i = 0; i < 64; ++i) {
+        const double next = 0.5 * (r + x / r);
+        if (next == r)
+            break;
+        r = next;
+    }
+    return r;
+}
+
+constexpr std::int16_t round_to_axis(double unit) noexcept
+{
+    const double scaled = unit * 32767.0;
+    return static_cast<std::int16_t>(scaled >= 0.0 ? scaled + 0.5 : scaled - 0.5);
+}
+
+} // namespace detail
+
+/// Bakes an odd-symmetric curve into `table`. `f` maps a magnitude in [0, 1]
+/// to [0, 1]; the sign of the input is carried over, -32768 is treated as
+/// -32767 and the centre maps to 0 whatever f(0) is. Usable in constant
+/// expressions when `f` is.
+template <typename F>
+constexpr void fill_curve_table(F f, CurveTable& table)
+{
+    table[0] = 0;
+    for (std::int32_t v = 1; v <= 32767; ++v) {
+        const std::int16_t out = detail::round_to_axis(f(static_cast<double>(v) / 32767.0));
+        table[static_cast<std::uint16_t>(v)] = out;
+        table[static_cast<std::uint16_t>(-v)] = static_cast<std::int16_t>(-out);
+    }
+    table[0x8000] = static_cast<std::int16_t>(-table[0x7fff]);
+}
+
+template <typename F>
+constexpr CurveTable make_curve_table(F f)
+{
+    CurveTable table{};
+    fill_curve_table(f, table);
+    return table;
+}
+
+/// Curves compiled into the binary.
+enum class CurvePreset {
+    Linear,
+    Gamma15,   ///< x^1.5
+    Quadratic, ///< x^2
+    Cubic,     ///< x^3
+    Expo50,    ///< 0.5 x + 0.5 x^3
+};
+
+/// Control point of a piecewise-linear curve, both coordinates in [0, 1].
+struct CurvePoint {
+    float x;
+    float y;
+};
+
+/// A response curve evaluated with one table load per sample.
+///
+/// Presets refer to tables generated at compile time; custom curves are baked
+/// once when built (normally at config load) and own their table.
+class ResponseCurve {
+public:
+    /// The linear preset.
+    ResponseCurve() noexcept;
+
+    [[nodiscard]] static ResponseCurve preset(CurvePreset preset) noexcept;
+
+    /// Linear interpolation through `points`, which must be sorted by strictly
+    /// increasing x. (0, 0) and (1, 1) are implied when missing; a point at
+    /// x = 0 must have y = 0, as the curve is odd-symmetric. Throws
+    /// std::invalid_argument on malformed points.
+    [[nodiscard]] static ResponseCurve piecewise_linear(std::span<const CurvePoint> points);
+
+    /// CSS-style cubic Bezier from (0, 0) to (1, 1) with control points
+    /// (x1, y1) and (x2, y2); x1 and x2 must lie in [0, 1].
+    [[nodiscard]] static ResponseCurve bezier(float x1, float y1, float x2, float y2);
+
+    /// x^exponent, exponent > 0.
+    [[nodiscard]] static ResponseCurve gamma(float exponent);
+
+    /// Bakes an arbitrary magnitude function, see fill_curve_table().
+    template <typename F>
+    [[nodiscard]] static ResponseCurve from_function(F f)
+    {
+        auto table = std::make_shared<CurveTable>();
+        fill_curve_table(f, *table);
+        return ResponseCurve(std::move(table));
+    }
+
+    /// Uses a table baked elsewhere, e.g. one mapped from a profile cache;
+    /// `table` keeps its storage alive.
+    [[nodiscard]] static ResponseCurve from_table(std::shared_ptr<const CurveTable> table) noexcept
+    {
+        return ResponseCurve(std::move(table));
+    }
+
+    [[nodiscard]] std::int16_t apply(std::int16_t v) const noexcept { return table_[static_cast<std::uint16_t>(v)]; }
+
+    void apply(std::int16_t* values, std::size_t count) const noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            values[i] = table_[static_cast<std::uint16_t>(values[i])];
+    }
+
+    [[nodiscard]] const std::int16_t* table() const noexcept { return table_; }
+
+private:
+    explicit ResponseCurve(const CurveTable& table) noexcept;
+    explicit ResponseCurve(std::shared_ptr<const CurveTable> owned) noexcept;
+
+    const std::int16_t* table_;
+    std::shared_ptr<const CurveTable> owned_;
+};
+
+/// Optional curve per axis of a device. Axes without a curve pass through.
+class CurveSet {
+public:
+    void set(std::size_t axis, ResponseCurve curve) noexcept
+    {
+        curves_[axis] = std::move(curve);
+        active_ |= 1u << axis;
+    }
+
+    void clear(std::size_t axis) noexcept
+    {
+        curves_[axis] = ResponseCurve();
+        active_ &= ~(1u << axis);
+    }
+
+    void apply(JoystickState& state) const noexcept
+    {
+        for (unsigned mask = active_; mask; mask &= mask - 1) {
+            const unsigned axis = static_cast<unsigned>(std::countr_zero(mask));
+            state.axes[axis] = curves_[axis].apply(state.axes[axis]);
+        }
+    }
+
+    [[nodiscard]] const ResponseCurve& curve(std::size_t axis) const noexcept { return curves_[axis]; }
+    [[nodiscard]] bool has_curve(std::size_t axis) const noexcept { return (active_ >> axis) & 1u; }
+
+private:
+    std::array<ResponseCurve, kMaxAxes> curves_{};
+    unsigned active_ = 0;
+};
+
+} // namespace vjc
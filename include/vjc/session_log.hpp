@@ -0,0 +1,136 @@
+#pragma once
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/joystick_state.hpp"
+#include "vjc/wire_format.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vjc {
+
+/// Session log layout, all fields little-endian:
+///
+///   header (kSessionHeaderSize bytes)
+///     u32 magic      'VJCS'
+///     u16 version    kSessionVersion
+///     u16 devices    number of devices recorded
+///     u64 data_size  bytes of records, 0 if the recorder did not close
+///     u64 reserved[2]
+///   records, back to back
+///     u8  size       wire frame length; 0 marks the end of the data
+///     u16 device
+///     u64 time_ns    since the first record
+///     ... one wire_format frame, a delta against the device's previous one
+///
+/// A log whose recorder died keeps every record written so far: the file is
+/// extended in zero-filled chunks, so the data ends at the first zero size.
+inline constexpr std::uint32_t kSessionMagic = 0x53434a56; // "VJCS"
+inline constexpr std::uint16_t kSessionVersion = 1;
+inline constexpr std::size_t kSessionHeaderSize = 32;
+inline constexpr std::size_t kSessionRecordHeaderSize = 11;
+inline constexpr std::size_t kMaxSessionRecordSize = kSessionRecordHeaderSize + kMaxWireStateSize;
+
+/// Appends every frame it is given to a memory-mapped session log.
+///
+/// Recording a frame is a delta encode straight into the mapping: no
+/// allocation and no syscall, except for growing the file once per
+/// kGrowBytes. As a FrameObserver it records what each device actually
+/// emitted, timed when the writer emitted it; writers of one manager are
+/// serialised by a spin flag that is uncontended with a single writer.
+class SessionRecorder final : public FrameObserver {
+public:
+    /// File growth step; also the size of the initial mapping.
+    static constexpr std::size_t kGrowBytes = std::size_t{64} << 20;
+
+    /// Creates (or truncates) `path` for `devices` devices. Throws
+    /// std::system_error or std::invalid_argument.
+    SessionRecorder(const std::string& path, std::size_t devices);
+    ~SessionRecorder() override;
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    /// Appends the state of `device` at CLOCK_MONOTONIC time `time_ns`.
+    /// Returns false if the device is out of range, the recorder is closed or
+    /// the file could not grow.
+    bool record(std::size_t device, const JoystickState& state, std::uint64_t time_ns) noexcept;
+    bool record(std::size_t device, const JoystickState& state) noexcept { return record(device, state, monotonic_ns()); }
+
+    void on_frame(unsigned writer, std::size_t device, const JoystickState& state, std::size_t events) noexcept override;
+
+    /// Trims the file to the recorded data and finalises the header.
+    /// Further records are rejected. Called by the destructor.
+    void close() noexcept;
+
+    [[nodiscard]] std::uint64_t frames() const noexcept { return frames_; }
+    [[nodiscard]] std::uint64_t dropped() const noexcept { return dropped_; }
+    /// Bytes of record data written so far.
+    [[nodiscard]] std::uint64_t bytes() const noexcept { return used_ - kSessionHeaderSize; }
+
+private:
+    bool grow() noexcept;
+
+    int fd_ = -1;
+    std::byte* map_ = nullptr;
+    std::size_t mapped_ = 0;
+    std::size_t used_ = kSessionHeaderSize;
+    std::uint64_t start_ns_ = 0;
+    std::uint64_t last_offset_ = 0;
+    bool started_ = false;
+    std::vector<DeltaEncoder> encoders_;
+    std::uint64_t frames_ = 0;
+    std::uint64_t dropped_ = 0;
+    std::atomic_flag busy_ = ATOMIC_FLAG_INIT;
+};
+
+/// One decoded record: the full state of `device` after applying it.
+struct SessionFrame {
+    std::uint64_t time_ns = 0;
+    std::uint16_t device = 0;
+    JoystickState state{};
+};
+
+/// Streams a session log from a read-only mapping.
+///
+/// The kernel reads ahead sequentially and pages already consumed are
+/// dropped every kReleaseBytes, so memory use stays flat for sessions far
+/// larger than RAM.
+class SessionReader {
+public:
+    static constexpr std::size_t kReleaseBytes = std::size_t{64} << 20;
+
+    /// Maps `path` and validates the header. Throws std::system_error, or
+    /// std::runtime_error if the file is not a session log.
+    explicit SessionReader(const std::string& path);
+    ~SessionReader();
+
+    SessionReader(const SessionReader&) = delete;
+    SessionReader& operator=(const SessionReader&) = delete;
+
+    /// Decodes the next record. Returns false at the end of the data or at a
+    /// truncated or corrupt record.
+    bool next(SessionFrame& frame) noexcept;
+
+    /// Restarts from the first record.
+    void rewind() noexcept;
+
+    [[nodiscard]] std::size_t device_count() const noexcept { return states_.size(); }
+    /// Bytes of record data in the file.
+    [[nodiscard]] std::size_t data_size() const noexcept { return end_ - kSessionHeaderSize; }
+
+private:
+    int fd_ = -1;
+    const std::byte* map_ = nullptr;
+    std::size_t length_ = 0;
+    std::size_t end_ = 0;
+    std::size_t offset_ = kSessionHeaderSize;
+    std::size_t released_ = 0;
+    std::vector<JoystickState> states_;
+};
+
+} // namespace vjc
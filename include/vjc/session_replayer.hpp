@@ -0,0 +1,49 @@
+#pragma once
+
+#include "vjc/session_log.hpp"
+#include "vjc/virtual_joystick.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace vjc {
+
+struct ReplayConfig {
+    double speed = 1.0;              ///< 2.0 replays twice as fast
+    std::uint64_t spin_ns = 100'000; ///< busy-wait this close to each deadline
+};
+
+/// Plays a session log back into virtual devices with its original timing.
+///
+/// Each frame sleeps until `spin_ns` before its deadline and busy-waits the
+/// rest, which keeps it within a few microseconds of the recorded time
+/// without burning a core between sparse frames.
+class SessionReplayer {
+public:
+    struct Stats {
+        std::uint64_t frames = 0;
+        std::uint64_t skipped = 0;      ///< records for a device with no target
+        std::uint64_t max_late_ns = 0;  ///< worst submission delay past its deadline
+        std::uint64_t total_late_ns = 0;
+    };
+
+    /// `devices[i]` receives the frames recorded for device `i`; null entries
+    /// and devices past the end are skipped.
+    SessionReplayer(SessionReader& reader, std::vector<VirtualJoystick*> devices, ReplayConfig config = {});
+
+    /// Replays from the reader's current position to the end, or until
+    /// stop(). Blocks the calling thread.
+    Stats run() noexcept;
+
+    /// Makes run() return after the current frame; callable from any thread.
+    void stop() noexcept { stop_.store(true, std::memory_order_relaxed); }
+
+private:
+    SessionReader& reader_;
+    std::vector<VirtualJoystick*> devices_;
+    ReplayConfig config_;
+    std::atomic<bool> stop_{false};
+};
+
+} // namespace vjc
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "vjc/joystick_state.hpp"
+#include "vjc/shm_protocol.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace vjc {
+
+/// Writes controller states into a ShmServer's segment.
+///
+/// An update is a seqlock-protected copy of the state into the device's
+/// slot, one atomic OR on the dirty bitmap and a doorbell ring; no syscall
+/// is made unless the server is asleep. States are stamped with
+/// CLOCK_MONOTONIC at send, which is shared by every process on the host.
+class ShmClient {
+public:
+    /// Maps the POSIX shared-memory object `name` (e.g. "/vjc").
+    explicit ShmClient(const std::string& name);
+    /// Maps the segment behind `fd`, e.g. a memfd inherited from the server
+    /// process; the fd is not kept. Both throw std::system_error or
+    /// std::runtime_error for a segment that is not a valid vjc channel.
+    explicit ShmClient(int fd);
+    ~ShmClient();
+
+    ShmClient(const ShmClient&) = delete;
+    ShmClient& operator=(const ShmClient&) = delete;
+
+    /// Publishes `state` for `device`. Returns false if the segment has no
+    /// such device.
+    bool send(std::uint16_t device, const JoystickState& state) noexcept;
+
+    [[nodiscard]] std::size_t device_count() const noexcept { return layout_.devices; }
+
+private:
+    void map(int fd);
+
+    void* base_ = nullptr;
+    ShmLayout layout_{0};
+    Doorbell* doorbell_ = nullptr;
+    std::atomic<std::uint64_t>* dirty_ = nullptr;
+    ShmSlot* slots_ = nullptr;
+};
+
+} // namespace vjc
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "vjc/doorbell.hpp"
+#include "vjc/joystick_state.hpp"
+#include "vjc/platform.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc {
+
+/// Shared-memory segment layout, native byte order (both ends share a host):
+///
+///   ShmHeader                         one cache line
+///   Doorbell                          one cache line, process-shared futex
+///   u64 dirty[(devices + 63) / 64]    bit set by a client after each update
+///   ShmSlot slots[devices]            seqlock + state, two cache lines each
+///
+/// A client writes a slot under its seqlock, sets the device's dirty bit and
+/// rings the doorbell, which only enters the kernel when the server sleeps.
+/// Each device takes a single writer at a time.
+inline constexpr std::uint32_t kShmMagic = 0x4d434a56; // "VJCM"
+inline constexpr std::uint16_t kShmVersion = 1;
+inline constexpr std::size_t kShmStateWords = sizeof(JoystickState) / sizeof(std::uint64_t);
+
+struct alignas(kCacheLineSize) ShmHeader {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t devices;
+    std::uint64_t size; ///< whole segment in bytes
+};
+
+struct alignas(kCacheLineSize) ShmSlot {
+    std::atomic<std::uint32_t> sequence; ///< odd while a write is in progress
+    std::atomic<std::uint64_t> words[kShmStateWords];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+
+/// Byte offsets of each part of a segment for `devices` devices.
+struct ShmLayout {
+    std::size_t devices;
+
+    [[nodiscard]] static constexpr std::size_t doorbell() noexcept { return sizeof(ShmHeader); }
+    [[nodiscard]] static constexpr std::size_t dirty() noexcept { return doorbell() + sizeof(Doorbell); }
+    [[nodiscard]] constexpr std::size_t dirty_words() const noexcept { return (devices + 63) / 64; }
+    [[nodiscard]] constexpr std::size_t slots() const noexcept
+    {
+        const std::size_t end = dirty() + dirty_words() * sizeof(std::uint64_t);
+        return (end + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+    }
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return slots() + devices * sizeof(ShmSlot); }
+};
+
+} // namespace vjc
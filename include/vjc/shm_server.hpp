@@ -0,0 +1,86 @@
+#pragma once
+
+#include "vjc/joystick_state.hpp"
+#include "vjc/shm_protocol.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace vjc {
+
+class ControllerManager;
+
+struct ShmServerConfig {
+    /// POSIX shared-memory name such as "/vjc"; empty creates an anonymous
+    /// memfd whose fd() is handed to clients instead.
+    std::string name;
+    /// Replace an existing object of the same name instead of failing.
+    bool replace = false;
+};
+
+/// Local input channel: clients on the same host write states straight
+/// into a shared-memory segment with one slot per manager device.
+///
+/// The server scans the dirty bitmap, reads each flagged slot under its
+/// seqlock and publishes the state into the device's ring. When idle it
+/// sleeps on a process-shared futex doorbell in the segment. The server is
+/// the only producer for every device of the manager.
+class ShmServer {
+public:
+    struct Stats {
+        std::uint64_t updates = 0;
+        std::uint64_t scans = 0;
+        std::uint64_t torn = 0; ///< reads retried because a write overlapped
+        std::uint64_t ring_full = 0;
+    };
+
+    /// Creates and maps the segment. Throws std::system_error or
+    /// std::invalid_argument.
+    explicit ShmServer(ControllerManager& manager, ShmServerConfig config = {});
+    /// Unmaps the segment and unlinks a named one.
+    ~ShmServer();
+
+    ShmServer(const ShmServer&) = delete;
+    ShmServer& operator=(const ShmServer&) = delete;
+
+    /// Segment fd, for passing a memfd to clients.
+    [[nodiscard]] int fd() const noexcept { return fd_; }
+    [[nodiscard]] const std::string& name() const noexcept { return config_.name; }
+
+    /// Waits up to `timeout_ms` for an update, then drains the segment.
+    /// While a device whose ring was full is waiting to be retried, the wait
+    /// is cut to a fraction of a millisecond. Returns the number of states
+    /// published.
+    std::size_t poll(int timeout_ms) noexcept;
+
+    /// Publishes every pending update without waiting.
+    std::size_t drain() noexcept;
+
+    /// Runs poll() on a background thread until stop().
+    void start();
+    void stop() noexcept;
+
+    /// Counters; only consistent when read from the polling thread or after stop().
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    bool read(std::size_t device, JoystickState& out) noexcept;
+
+    ControllerManager& manager_;
+    ShmServerConfig config_;
+    int fd_ = -1;
+    void* base_ = nullptr;
+    ShmLayout layout_;
+    Doorbell* doorbell_ = nullptr;
+    std::atomic<std::uint64_t>* dirty_ = nullptr;
+    ShmSlot* slots_ = nullptr;
+    Stats stats_;
+    bool retry_ = false; // a claim failed and its dirty bit was set again
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+} // namespace vjc
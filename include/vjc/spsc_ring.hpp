@@ -0,0 +1,190 @@
+#pragma once
+
+#include "vjc/platform.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace vjc {
+
+/// Bounded wait-free single-producer/single-consumer queue.
+///
+/// Producer and consumer indices live on their own cache lines, and each side
+/// keeps a cached copy of the other's index so the shared line is only read
+/// when the ring looks full (producer) or empty (consumer). Slots can be
+/// written and read in place with claim()/publish() and front()/pop().
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    static constexpr std::size_t capacity = Capacity;
+
+    // Producer side.
+
+    /// Returns the next free slot, or nullptr if the ring is full. The slot
+    /// becomes visible to the consumer on publish().
+    [[nodiscard]] T* claim() noexcept
+    {
+        const std::size_t tail = tail_.value.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == Capacity) {
+            head_cache_ = head_.value.load(std::memory_order_acquire);
+            if (tail - head_cache_ == Capacity)
+                return nullptr;
+        }
+        return &slots_[tail & kMask];
+    }
+
+    void publish() noexcept
+    {
+        tail_.value.store(tail_.value.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool try_push(const T& value) noexcept
+    {
+        T* slot = claim();
+        if (!slot)
+            return false;
+        *slot = value;
+        publish();
+        return true;
+    }
+
+    // Consumer side.
+
+    /// Returns the oldest element, or nullptr if the ring is empty. The slot
+    /// stays valid until pop().
+    [[nodiscard]] const T* front() noexcept
+    {
+        const std::size_t head = head_.value.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.value.load(std::memory_order_acquire);
+            if (head == tail_cache_)
+                return nullptr;
+        }
+        return &slots_[head & kMask];
+    }
+
+    void pop() noexcept
+    {
+        head_.value.store(head_.value.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool try_pop(T& out) noexcept
+    {
+        const T* slot = front();
+        if (!slot)
+            return false;
+        out = *slot;
+        pop();
+        return true;
+    }
+
+    /// Discards everything but the newest element and returns it in `out`.
+    /// Returns the number of elements consumed (0 if the ring was empty).
+    std::size_t pop_latest(T& out) noexcept
+    {
+        const std::size_t head = head_.value.load(std::memory_order_relaxed);
+        tail_cache_ = tail_.value.load(std::memory_order_acquire);
+        if (head == tail_cache_)
+            return 0;
+        out = slots_[(tail_cache_ - 1) & kMask];
+        head_.value.store(tail_cache_, std::memory_order_release);
+        return tail_cache_ - head;
+    }
+
+    /// Approximate number of queued elements; exact only when both sides are idle.
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return tail_.value.load(std::memory_order_acquire) - head_.value.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+private:
+    static constexpr std::size_t kMask = Capacity - 1;
+
+    struct alignas(kCacheLineSize) Index {
+        std::atomic<std::size_t> value{0};
+    };
+
+    Index head_; // written by the consumer
+    alignas(kCacheLineSize) std::size_t tail_cache_ = 0; // consumer-private
+    Index tail_; // written by the producer
+    alignas(kCacheLineSize) std::size_t head_cache_ = 0; // producer-private
+    alignas(kCacheLineSize) std::array<T, Capacity> slots_{};
+};
+
+/// Single-producer/single-consumer "latest value wins" mailbox.
+///
+/// A triple buffer: the producer always owns one buffer, the consumer owns
+/// another and the third is exchanged through one atomic. Publishing never
+/// blocks or fails; a value not yet read is simply replaced by the newer one.
+template <typename T>
+class LatestSlot {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    // Producer side.
+
+    /// Buffer to write the next value into; valid until publish().
+    [[nodiscard]] T* claim() noexcept { return &buffers_[write_index_].value; }
+
+    /// Makes the claimed buffer the latest value. Returns true if it replaced
+    /// a value the consumer never saw.
+    bool publish() noexcept
+    {
+        const std::uint8_t prev = middle_.exchange(static_cast<std::uint8_t>(write_index_ | kFresh), std::memory_order_acq_rel);
+        write_index_ = prev & kIndexMask;
+        return (prev & kFresh) != 0;
+    }
+
+    bool push(const T& value) noexcept
+    {
+        *claim() = value;
+        return publish();
+    }
+
+    // Consumer side.
+
+    /// Copies the latest value into `out` if one was published since the last
+    /// call. Returns false if there is nothing new.
+    bool try_pop(T& out) noexcept
+    {
+        const T* value = acquire();
+        if (!value)
+            return false;
+        out = *value;
+        return true;
+    }
+
+    /// Takes the latest unseen value in place; the pointer stays valid until
+    /// the next acquire().
+    [[nodiscard]] const T* acquire() noexcept
+    {
+        if (!(middle_.load(std::memory_order_relaxed) & kFresh))
+            return nullptr;
+        const std::uint8_t prev = middle_.exchange(read_index_, std::memory_order_acq_rel);
+        read_index_ = prev & kIndexMask;
+        return &buffers_[read_index_].value;
+    }
+
+private:
+    static constexpr std::uint8_t kFresh = 0x4;
+    static constexpr std::uint8_t kIndexMask = 0x3;
+
+    struct alignas(kCacheLineSize) Buffer {
+        T value{};
+    };
+
+    std::array<Buffer, 3> buffers_{};
+    alignas(kCacheLineSize) std::atomic<std::uint8_t> middle_{1};
+    alignas(kCacheLineSize) std::uint8_t write_index_ = 0; // producer-private
+    alignas(kCacheLineSize) std::uint8_t read_index_ = 2;  // consumer-private
+};
+
+} // namespace vjc
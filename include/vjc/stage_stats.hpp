@@ -0,0 +1,164 @@
+#pragma once
+
+#include "vjc/clock.hpp"
+#include "vjc/platform.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef VJC_STATS
+#define VJC_STATS 1
+#endif
+
+namespace vjc {
+
+/// Pipeline stages with their own latency histogram.
+enum class Stage : unsigned {
+    Receive,  ///< socket read, per recvmmsg() batch or IoLoop receive
+    Decode,   ///< header validation and wire decode, per packet
+    Filter,   ///< jitter filtering, per InputFilter pass
+    Shape,    ///< axis shaping, per AxisProcessor pass
+    Coalesce, ///< wait from receive to writer pick-up, per state
+    Write,    ///< event encode and device write, per frame
+};
+
+inline constexpr std::size_t kStageCount = 6;
+
+[[nodiscard]] const char* to_string(Stage stage) noexcept;
+
+/// Log-linear latency buckets in the style of HdrHistogram: values below
+/// 2 * kSubBuckets are exact, larger ones keep the top log2(kSubBuckets) + 1
+/// significant bits, i.e. about 3% relative error over the whole u64 range.
+struct HistogramLayout {
+    static constexpr unsigned kSubBits = 5;
+    static constexpr std::uint64_t kSubBuckets = std::uint64_t{1} << kSubBits;
+    static constexpr std::size_t kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+    static constexpr std::size_t index(std::uint64_t v) noexcept
+    {
+        if (v < 2 * kSubBuckets)
+            return static_cast<std::size_t>(v);
+        const unsigned shift = static_cast<unsigned>(std::bit_width(v)) - kSubBits - 1;
+        return static_cast<std::size_t>(shift * kSubBuckets + (v >> shift));
+    }
+
+    /// Largest value that maps to bucket `i`.
+    static constexpr std::uint64_t upper(std::size_t i) noexcept
+    {
+        if (i < 2 * kSubBuckets)
+            return i;
+        const std::size_t shift = i / kSubBuckets - 1;
+        const std::uint64_t base = (i % kSubBuckets + kSubBuckets) << shift;
+        return base + ((std::uint64_t{1} << shift) - 1);
+    }
+};
+
+/// Merged view of one stage across every thread.
+struct HistogramSnapshot {
+    std::uint64_t count = 0;
+    std::uint64_t sum_ns = 0;
+    std::uint64_t max_ns = 0;
+    std::array<std::uint64_t, HistogramLayout::kBuckets> buckets{};
+
+    /// Upper bound of the bucket holding quantile `q` in [0, 1].
+    [[nodiscard]] std::uint64_t percentile(double q) const noexcept;
+    [[nodiscard]] double mean() const noexcept { return count ? static_cast<double>(sum_ns) / static_cast<double>(count) : 0.0; }
+};
+
+struct StatsSnapshot {
+    std::array<HistogramSnapshot, kStageCount> stages{};
+
+    [[nodiscard]] const HistogramSnapshot& operator[](Stage s) const noexcept { return stages[static_cast<std::size_t>(s)]; }
+
+    /// One line per stage with count, mean and p50/p99/p99.9/max.
+    [[nodiscard]] std::string text() const;
+    /// A single JSON object keyed by stage name.
+    [[nodiscard]] std::string json() const;
+};
+
+namespace detail {
+
+/// Histograms of one thread. Only that thread writes; snapshots read the
+/// relaxed atomics concurrently, so a snapshot may be a few samples stale
+/// but never torn.
+struct alignas(kCacheLineSize) ThreadStats {
+    struct Histogram {
+        std::atomic<std::uint64_t> sum{0};
+        std::atomic<std::uint64_t> max{0};
+        std::array<std::atomic<std::uint64_t>, HistogramLayout::kBuckets> buckets{};
+    };
+
+    std::array<Histogram, kStageCount> stages;
+};
+
+/// This thread's histograms, registered on first use and kept after the
+/// thread exits so its samples stay in later snapshots.
+ThreadStats& thread_stats() noexcept;
+
+inline void bump(std::atomic<std::uint64_t>& counter, std::uint64_t n = 1) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+/// Records one latency sample for `stage` on the calling thread. Compiles to
+/// nothing when VJC_STATS is 0.
+inline void record_stage(Stage stage, std::uint64_t ns) noexcept
+{
+#if VJC_STATS
+    auto& h = detail::thread_stats().stages[static_cast<std::size_t>(stage)];
+    detail::bump(h.buckets[HistogramLayout::index(ns)]);
+    detail::bump(h.sum, ns);
+    if (ns > h.max.load(std::memory_order_relaxed))
+        h.max.store(ns, std::memory_order_relaxed);
+#else
+    (void)stage;
+    (void)ns;
+#endif
+}
+
+/// Times its own scope, or up to stop(), into a stage.
+class StageTimer {
+public:
+    explicit StageTimer(Stage stage) noexcept
+#if VJC_STATS
+        : stage_(stage)
+        , start_(monotonic_ns())
+#endif
+    {
+        (void)stage;
+    }
+
+    ~StageTimer() { stop(); }
+
+    /// Records now instead of at the end of the scope.
+    void stop() noexcept
+    {
+#if VJC_STATS
+        if (start_ != 0) {
+            record_stage(stage_, monotonic_ns() - start_);
+            start_ = 0;
+        }
+#endif
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+#if VJC_STATS
+    Stage stage_;
+    std::uint64_t start_;
+#endif
+};
+
+/// Merges every thread's histograms. Takes a registry lock but never blocks
+/// the recording threads. All zero when VJC_STATS is 0.
+[[nodiscard]] StatsSnapshot stage_snapshot();
+
+} // namespace vjc
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "vjc/joystick_state.hpp"
+#include "vjc/spsc_ring.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc {
+
+enum class RingMode {
+    /// Every published state is delivered in order; publish fails when full.
+    Queue,
+    /// Only the newest state is kept; publish never fails and the writer
+    /// never sees a backlog.
+    Coalesce,
+};
+
+/// Hand-off of joystick states from one producer thread to the device writer.
+///
+/// Both modes expose the same in-place claim()/publish() interface so a
+/// producer can decode straight into the slot the writer will read.
+class StateRing {
+public:
+    static constexpr std::size_t kCapacity = 64;
+
+    explicit StateRing(RingMode mode = RingMode::Coalesce) noexcept
+        : mode_(mode)
+    {
+    }
+
+    StateRing(const StateRing&) = delete;
+    StateRing& operator=(const StateRing&) = delete;
+
+    [[nodiscard]] RingMode mode() const noexcept { return mode_; }
+
+    // Producer side.
+
+    /// Slot for the next state, or nullptr if a Queue ring is full.
+    [[nodiscard]] JoystickState* claim() noexcept
+    {
+        if (mode_ == RingMode::Coalesce)
+            return latest_.claim();
+        JoystickState* slot = queue_.claim();
+        if (!slot)
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        return slot;
+    }
+
+    void publish() noexcept
+    {
+        if (mode_ == RingMode::Queue)
+            queue_.publish();
+        else if (latest_.publish())
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool push(const JoystickState& state) noexcept
+    {
+        JoystickState* slot = claim();
+        if (!slot)
+            return false;
+        *slot = state;
+        publish();
+        return true;
+    }
+
+    // Consumer side.
+
+    /// Oldest queued state (Queue) or latest unseen state (Coalesce).
+    bool pop(JoystickState& out) noexcept
+    {
+        return mode_ == RingMode::Queue ? queue_.try_pop(out) : latest_.try_pop(out);
+    }
+
+    /// Newest available state, discarding anything older.
+    bool pop_latest(JoystickState& out) noexcept
+    {
+        if (mode_ == RingMode::Coalesce)
+            return latest_.try_pop(out);
+        const std::size_t n = queue_.pop_latest(out);
+        if (n > 1)
+            coalesced_.fetch_add(n - 1, std::memory_order_relaxed);
+        return n != 0;
+    }
+
+    /// States superseded before the writer read them.
+    [[nodiscard]] std::uint64_t coalesced() const noexcept { return coalesced_.load(std::memory_order_relaxed); }
+
+    /// Publish attempts rejected because a Queue ring was full.
+    [[nodiscard]] std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    const RingMode mode_;
+    SpscRing<JoystickState, kCapacity> queue_;
+    LatestSlot<JoystickState> latest_;
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> coalesced_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+} // namespace vjc
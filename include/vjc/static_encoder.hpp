@@ -0,0 +1,109 @@
+#pragma once
+
+#include "vjc/device_layout.hpp"
+#include "vjc/event_encoder.hpp"
+#include "vjc/virtual_joystick.hpp"
+
+#include <linux/input.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace vjc {
+
+/// EventEncoder specialized for one constexpr DeviceLayout.
+///
+/// Counts and codes are template constants, so the per-field diff loops are
+/// unrolled into straight-line compares with immediate codes and fields the
+/// layout lacks cost nothing. Output is identical to EventEncoder for the
+/// layout's descriptor(), event for event.
+template <const auto& Layout>
+class StaticEncoder {
+    using LayoutType = std::remove_cvref_t<decltype(Layout)>;
+    static_assert(Layout.valid(), "layout has a code out of range or reused");
+
+public:
+    static constexpr std::size_t kMaxEvents
+        = LayoutType::kAxes + LayoutType::kTriggers + 2 * LayoutType::kHats + LayoutType::kButtons + 1;
+    static_assert(kMaxEvents <= kMaxFrameEvents);
+
+    /// See EventEncoder::encode().
+    static std::size_t encode(const JoystickState& prev, const JoystickState& next, input_event* out) noexcept
+    {
+        return encode_impl<false>(prev, next, out);
+    }
+
+    /// See EventEncoder::encode_full().
+    static std::size_t encode_full(const JoystickState& state, input_event* out) noexcept
+    {
+        return encode_impl<true>(state, state, out);
+    }
+
+    static constexpr FrameEncoding encoding() noexcept { return {&encode, &encode_full}; }
+
+private:
+    static constexpr std::uint64_t kButtonMask
+        = LayoutType::kButtons == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << LayoutType::kButtons) - 1;
+
+    static void put(input_event*& out, std::uint16_t type, std::uint16_t code, std::int32_t value) noexcept
+    {
+        out->time = {};
+        out->type = type;
+        out->code = code;
+        out->value = value;
+        ++out;
+    }
+
+    template <bool Full>
+    static std::size_t encode_impl(const JoystickState& prev, const JoystickState& next, input_event* out) noexcept
+    {
+        input_event* const begin = out;
+
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((Full || prev.axes[I] != next.axes[I] ? put(out, EV_ABS, Layout.axes[I].code, next.axes[I]) : void()),
+             ...);
+        }(std::make_index_sequence<LayoutType::kAxes>{});
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((Full || prev.triggers[I] != next.triggers[I]
+                  ? put(out, EV_ABS, Layout.triggers[I].code, next.triggers[I])
+                  : void()),
+             ...);
+        }(std::make_index_sequence<LayoutType::kTriggers>{});
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((Full || prev.hats[I] != next.hats[I]
+                  ? put(out, EV_ABS, static_cast<std::uint16_t>(ABS_HAT0X + I), next.hats[I])
+                  : void()),
+             ...);
+        }(std::make_index_sequence<2 * LayoutType::kHats>{});
+
+        if constexpr (LayoutType::kButtons > 0) {
+            std::uint64_t changed = (Full ? ~std::uint64_t{0} : prev.buttons ^ next.buttons) & kButtonMask;
+            while (changed) {
+                const unsigned bit = static_cast<unsigned>(std::countr_zero(changed));
+                changed &= changed - 1;
+                put(out, EV_KEY, Layout.buttons[bit], next.button(bit) ? 1 : 0);
+            }
+        }
+
+        if (out == begin)
+            return 0;
+        put(out, EV_SYN, SYN_REPORT, 0);
+        return static_cast<std::size_t>(out - begin);
+    }
+};
+
+/// A VirtualJoystick for a constexpr layout, its frames encoded by
+/// StaticEncoder<Layout>. Descriptors only known at runtime (user-defined
+/// profiles) go through the plain constructor and EventEncoder.
+template <const auto& Layout>
+std::unique_ptr<VirtualJoystick> make_joystick(std::unique_ptr<DeviceBackend> backend)
+{
+    return std::make_unique<VirtualJoystick>(std::move(backend), Layout.descriptor(),
+                                             StaticEncoder<Layout>::encoding());
+}
+
+} // namespace vjc
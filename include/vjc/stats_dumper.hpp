@@ -0,0 +1,45 @@
+#pragma once
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+
+namespace vjc {
+
+enum class DumpFormat { Text, Json };
+
+/// Writes a stage_snapshot() to a file descriptor whenever a signal arrives,
+/// e.g. `kill -USR1 <pid>` on a running server.
+///
+/// The signal handler only pokes an eventfd; formatting and writing happen on
+/// a dedicated thread, so the hot path is never interrupted for longer than
+/// the handler itself. One dumper can be active per process.
+class StatsDumper {
+public:
+    /// Installs the handler. Throws std::system_error, or std::logic_error if
+    /// another dumper is active.
+    explicit StatsDumper(int fd = STDERR_FILENO, DumpFormat format = DumpFormat::Text, int signal = SIGUSR1);
+    /// Restores the previous handler and joins the thread.
+    ~StatsDumper();
+
+    StatsDumper(const StatsDumper&) = delete;
+    StatsDumper& operator=(const StatsDumper&) = delete;
+
+    /// Requests a dump as if the signal had been delivered.
+    void trigger() noexcept;
+
+private:
+    void run() noexcept;
+
+    int fd_;
+    DumpFormat format_;
+    int signal_;
+    int event_fd_ = -1;
+    struct sigaction previous_ {};
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+};
+
+} // namespace vjc
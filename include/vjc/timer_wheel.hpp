@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vjc {
+
+/// Identifies a scheduled timer; stale ids are detected by a generation count.
+using TimerId = std::uint64_t;
+inline constexpr TimerId kNoTimer = 0;
+
+/// Hierarchical timer wheel over a fixed pool of timers.
+///
+/// Time is split into ticks of `tick_ns`. Four levels of 64 slots cover 2^24
+/// ticks (28 minutes at 100 us); later deadlines wait in the last level and
+/// are re-filed as it turns. A timer lives on an intrusive list in the slot of
+/// its deadline at the coarsest level that still separates it from now, so
+/// schedule() and cancel() are O(1) and advance() only touches the timers that
+/// fire or move down a level. Timers fire on the first advance() at or after
+/// their deadline, at most one tick late relative to the advance time. The
+/// wheel is single-threaded and never allocates after construction; time is
+/// passed in by the caller.
+class TimerWheel {
+public:
+    static constexpr std::uint64_t kNoDeadline = ~std::uint64_t{0};
+
+    /// Throws std::invalid_argument if `capacity` or `tick_ns` is 0.
+    TimerWheel(std::size_t capacity, std::uint64_t tick_ns, std::uint64_t now_ns);
+
+    /// Arms a timer for `deadline_ns`, handing `cookie` back when it fires.
+    /// Returns kNoTimer when every timer of the pool is in use.
+    TimerId schedule(std::uint64_t deadline_ns, std::uint64_t cookie) noexcept;
+
+    /// Disarms `id`. Returns false if it already fired or was cancelled.
+    bool cancel(TimerId id) noexcept;
+
+    /// Fires every timer due at `now_ns`, calling `fire(id, cookie,
+    /// deadline_ns)` for each, tick by tick. `fire` may schedule and cancel
+    /// timers; one it arms for a time already passed fires within this call.
+    /// Returns the number of timers fired.
+    template <typename F>
+    std::size_t advance(std::uint64_t now_ns, F&& fire);
+
+    /// Earliest time advance() may have work to do: the deadline of the next
+    /// timer, or the time a coarser level must be re-filed. kNoDeadline when
+    /// no timer is armed.
+    [[nodiscard]] std::uint64_t next_deadline() const noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return nodes_.size(); }
+    [[nodiscard]] std::uint64_t tick_ns() const noexcept { return tick_ns_; }
+
+private:
+    static constexpr unsigned kLevels = 4;
+    static constexpr unsigned kSlotBits = 6;
+    static constexpr unsigned kSlots = 1u << kSlotBits;
+    static constexpr std::uint32_t kNil = ~std::uint32_t{0};
+    static constexpr std::uint16_t kFree = 0xffff;
+    static constexpr std::uint16_t kFiring = kLevels * kSlots; // list of timers being fired
+    static constexpr std::uint64_t kHorizon = (std::uint64_t{1} << (kLevels * kSlotBits)) - 1;
+
+    struct Node {
+        std::uint64_t deadline_ns = 0;
+        std::uint64_t cookie = 0;
+        std::uint32_t next = kNil;
+        std::uint32_t prev = kNil;
+        std::uint32_t generation = 1;
+        std::uint16_t list = kFree; // level * kSlots + slot, kFiring or kFree
+    };
+
+    [[nodiscard]] std::uint64_t tick_of(std::uint64_t deadline_ns) const noexcept
+    {
+        return deadline_ns / tick_ns_ + (deadline_ns % tick_ns_ != 0);
+    }
+
+    [[nodiscard]] static TimerId make_id(std::uint32_t index, std::uint32_t generation) noexcept
+    {
+        return static_cast<TimerId>(generation) << 32 | index;
+    }
+
+    void file(std::uint32_t index) noexcept;
+    void link(std::uint32_t index, unsigned list) noexcept;
+    void unlink(std::uint32_t index) noexcept;
+    void release(std::uint32_t index) noexcept;
+    void cascade(unsigned level) noexcept;
+
+    std::uint64_t tick_ns_;
+    std::uint64_t next_tick_; // first tick advance() has not processed yet
+    std::size_t size_ = 0;
+    std::uint32_t free_ = kNil;
+    std::vector<Node> nodes_;
+    std::array<std::uint32_t, kLevels * kSlots + 1> heads_;
+    std::array<std::uint64_t, kLevels> occupied_{}; // bit per non-empty slot
+};
+
+template <typename F>
+std::size_t TimerWheel::advance(std::uint64_t now_ns, F&& fire)
+{
+    const std::uint64_t target = now_ns / tick_ns_;
+    std::size_t fired = 0;
+    while (next_tick_ <= target) {
+        const std::uint64_t tick = next_tick_;
+        const unsigned slot = static_cast<unsigned>(tick & (kSlots - 1));
+        if (slot == 0)
+            for (unsigned level = 1; level < kLevels; ++level) {
+                cascade(level);
+                if (((tick >> (level * kSlotBits)) & (kSlots - 1)) != 0)
+                    break;
+            }
+
+        // Jump to the next occupied slot of this block, or past its end.
+        if (const std::uint64_t ahead = occupied_[0] >> slot; (ahead & 1) == 0) {
+            const std::uint64_t next = ahead ? tick + static_cast<unsigned>(std::countr_zero(ahead))
+                                             : (tick | (kSlots - 1)) + 1;
+            next_tick_ = next <= target ? next : target + 1;
+            continue;
+        }
+
+        // Move the slot to the firing list before running callbacks: timers
+        // armed by `fire` for a tick already due then land in a slot still
+        // ahead, and cancelling one that is about to fire just unlinks it.
+        std::uint32_t index = heads_[slot];
+        heads_[slot] = kNil;
+        occupied_[0] &= ~(std::uint64_t{1} << slot);
+        heads_[kFiring] = index;
+        for (; index != kNil; index = nodes_[index].next)
+            nodes_[index].list = kFiring;
+        ++next_tick_;
+        while ((index = heads_[kFiring]) != kNil) {
+            const Node& node = nodes_[index];
+            const TimerId id = make_id(index, node.generation);
+            const std::uint64_t cookie = node.cookie;
+            const std::uint64_t deadline = node.deadline_ns;
+            unlink(index);
+            release(index);
+            ++fired;
+            fire(id, cookie, deadline);
+        }
+    }
+    return fired;
+}
+
+} // namespace vjc
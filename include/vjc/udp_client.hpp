@@ -0,0 +1,53 @@
+#pragma once
+
+#include "vjc/joystick_state.hpp"
+#include "vjc/net_protocol.hpp"
+#include "vjc/wire_format.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vjc {
+
+/// Sends controller states to a UdpServer.
+///
+/// Each device's states are delta-encoded against the previous packet; every
+/// `keyframe_interval`-th packet carries every field so a lost datagram is
+/// corrected within a bounded number of packets. Packets carry a session id
+/// drawn at construction, so a server tells a new client run from a late
+/// packet of this one.
+class UdpClient {
+public:
+    /// Connects a UDP socket to `address`:`port`. Throws std::system_error or
+    /// std::invalid_argument.
+    UdpClient(const std::string& address, std::uint16_t port, unsigned keyframe_interval = 64);
+    ~UdpClient();
+
+    UdpClient(const UdpClient&) = delete;
+    UdpClient& operator=(const UdpClient&) = delete;
+
+    /// Sends one packet. Returns false if the datagram could not be sent.
+    /// The first packet for a device number above any used before allocates
+    /// its stream and may throw std::bad_alloc.
+    bool send(std::uint16_t device, const JoystickState& state);
+
+    /// Takes one force-feedback command the server sent back, without
+    /// waiting. Returns false if none is queued; other datagrams are dropped.
+    bool receive_ff(FfPacket& packet) noexcept;
+
+    [[nodiscard]] int fd() const noexcept { return fd_; }
+
+private:
+    struct Stream {
+        DeltaEncoder encoder;
+        std::uint32_t sequence = 0;
+    };
+
+    int fd_ = -1;
+    unsigned keyframe_interval_;
+    std::uint32_t session_;
+    std::vector<Stream> streams_;
+};
+
+} // namespace vjc
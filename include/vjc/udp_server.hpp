@@ -0,0 +1,128 @@
+#pragma once
+
+#include "vjc/arena.hpp"
+#include "vjc/force_feedback.hpp"
+#include "vjc/io_loop.hpp"
+#include "vjc/joystick_state.hpp"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vjc {
+
+class ControllerManager;
+
+struct UdpServerConfig {
+    std::string address = "0.0.0.0"; ///< IPv4 or IPv6 literal
+    std::uint16_t port = 0;          ///< 0 picks an ephemeral port
+    unsigned batch = 64;             ///< datagrams per recvmmsg() call
+    int receive_buffer = 1 << 20;    ///< SO_RCVBUF in bytes
+};
+
+/// Receives controller states over UDP and publishes them to a manager.
+///
+/// Datagrams (see net_protocol.hpp) are pulled `batch` at a time with
+/// recvmmsg() into buffers carved from one arena at construction, validated
+/// in place and decoded directly onto the per-device state, which is then
+/// published into the device's ring with a single cache-line copy. The
+/// server is the only producer for every device it receives packets for.
+/// As an FfSink it sends force-feedback commands back to each device's
+/// client from the same socket.
+class UdpServer final : public FfSink {
+public:
+    struct Stats {
+        std::uint64_t packets = 0;
+        std::uint64_t batches = 0;
+        std::uint64_t invalid = 0; ///< bad header or frame
+        std::uint64_t unknown_device = 0;
+        std::uint64_t stale = 0;    ///< duplicate or reordered
+        std::uint64_t gaps = 0;     ///< sequence jumps, i.e. likely loss
+        std::uint64_t restarts = 0; ///< packets that opened a new client session
+        std::uint64_t ring_full = 0;
+        std::uint64_t receive_errors = 0; ///< transient failures of a loop receive, retried
+    };
+
+    /// Binds the socket. Throws std::system_error or std::invalid_argument.
+    UdpServer(ControllerManager& manager, UdpServerConfig config = {});
+    ~UdpServer() override;
+
+    UdpServer(const UdpServer&) = delete;
+    UdpServer& operator=(const UdpServer&) = delete;
+
+    /// Port actually bound.
+    [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+    [[nodiscard]] int fd() const noexcept { return fd_; }
+
+    /// Waits up to `timeout_ms` for traffic, then drains the socket.
+    /// Returns the number of datagrams processed.
+    std::size_t poll(int timeout_ms) noexcept;
+
+    /// Drains whatever is queued without waiting.
+    std::size_t drain() noexcept;
+
+    /// Runs poll() on a background thread until stop().
+    void start();
+    void stop() noexcept;
+
+    /// Receives on `loop` instead, one datagram per completion, for a thread
+    /// that multiplexes several servers and devices. Not together with
+    /// start(); the loop must be destroyed before the server.
+    void serve(IoLoop& loop);
+
+    /// Address of the last client that sent a valid packet for `device`;
+    /// `ss_family` is AF_UNSPEC if none has. Same consistency rules as stats().
+    [[nodiscard]] sockaddr_storage peer(std::size_t device) const noexcept;
+
+    /// Sends `packet` to the last client of `packet.device` without
+    /// blocking. Safe from any thread. False if no client is known yet or
+    /// the socket buffer is full.
+    bool send_ff(const FfPacket& packet) noexcept override;
+
+    /// Counters; only consistent when read from the polling thread or after stop().
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    IoTask receive(IoLoop& loop);
+    void handle(const std::byte* data, std::size_t size, const sockaddr_storage& from, std::uint64_t now) noexcept;
+
+    static constexpr std::size_t kPeerWords = (sizeof(sockaddr_in6) + 7) / 8;
+
+    struct DeviceState {
+        JoystickState state{};
+        std::uint32_t sequence = 0;
+        std::uint32_t session = 0;
+        std::uint32_t previous_session = 0; // late packets of it are stale
+        bool seen = false;
+        sockaddr_storage peer{};
+        // Copy of `peer` for send_ff() on other threads, under a seqlock;
+        // rewritten only when the client's address changes.
+        std::atomic<std::uint32_t> peer_sequence{0};
+        std::array<std::atomic<std::uint64_t>, kPeerWords> peer_words{};
+    };
+
+    ControllerManager& manager_;
+    UdpServerConfig config_;
+    int fd_ = -1;
+    std::uint16_t port_ = 0;
+    Arena arena_; // everything below, in one block
+    std::span<std::byte> buffers_;
+    std::span<mmsghdr> messages_;
+    std::span<iovec> iovecs_;
+    std::span<sockaddr_storage> addresses_;
+    std::vector<DeviceState> devices_;
+    Stats stats_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+} // namespace vjc
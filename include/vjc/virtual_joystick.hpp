@@ -0,0 +1,72 @@
+#pragma once
+
+#include "vjc/device_backend.hpp"
+#include "vjc/device_descriptor.hpp"
+#include "vjc/event_encoder.hpp"
+#include "vjc/joystick_state.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace vjc {
+
+/// Replacement for the descriptor-driven EventEncoder, with the same
+/// contract as its encode() and encode_full(); see StaticEncoder.
+struct FrameEncoding {
+    std::size_t (*encode)(const JoystickState& prev, const JoystickState& next, input_event* out) noexcept = nullptr;
+    std::size_t (*encode_full)(const JoystickState& state, input_event* out) noexcept = nullptr;
+};
+
+/// A virtual gamepad fed with whole-frame states.
+///
+/// Each `submit()` diffs the new state against the last one written, encodes
+/// every changed axis, hat and button plus a single SYN_REPORT into a
+/// preallocated buffer and hands the frame to the backend in one write.
+/// Not thread-safe: one thread owns a device.
+class VirtualJoystick {
+public:
+    struct Stats {
+        std::uint64_t frames = 0;
+        std::uint64_t events = 0;
+        std::uint64_t failed_frames = 0;
+    };
+
+    /// Creates the device on `backend`. Throws if the descriptor is invalid or
+    /// the backend refuses it.
+    VirtualJoystick(std::unique_ptr<DeviceBackend> backend, DeviceDescriptor descriptor);
+
+    /// Same, with frames encoded by `encoding`, which must describe the same
+    /// capabilities as `descriptor`. See make_joystick().
+    VirtualJoystick(std::unique_ptr<DeviceBackend> backend, DeviceDescriptor descriptor, FrameEncoding encoding);
+
+    /// Convenience constructor for a real /dev/uinput device.
+    static std::unique_ptr<VirtualJoystick> open_uinput(DeviceDescriptor descriptor,
+                                                        const std::string& path = "/dev/uinput");
+
+    /// Emits the changes from the last written state to `state`. Returns the
+    /// number of events written, SYN_REPORT included, or 0 if nothing changed
+    /// or the write failed. A failed frame is retried on the next submit.
+    std::size_t submit(const JoystickState& state) noexcept;
+
+    /// Re-emits every field, e.g. after a consumer reported SYN_DROPPED.
+    std::size_t resync() noexcept;
+
+    [[nodiscard]] const JoystickState& state() const noexcept { return current_; }
+    [[nodiscard]] const DeviceDescriptor& descriptor() const noexcept { return descriptor_; }
+    [[nodiscard]] DeviceBackend& backend() noexcept { return *backend_; }
+    [[nodiscard]] const Stats& stats() const noexcept { return stats_; }
+
+private:
+    std::size_t flush(const JoystickState& state, std::size_t count) noexcept;
+
+    std::unique_ptr<DeviceBackend> backend_;
+    DeviceDescriptor descriptor_;
+    EventEncoder encoder_;
+    FrameEncoding encoding_;
+    JoystickState current_{};
+    EventBuffer buffer_{};
+    Stats stats_{};
+};
+
+} // namespace vjc
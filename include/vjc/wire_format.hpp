@@ -0,0 +1,60 @@
+#pragma once
+
+#include "vjc/joystick_state.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc {
+
+/// Field bits of a wire-encoded state. A frame is a little-endian u16 field
+/// mask followed by the selected fields in bit order: each axis and trigger
+/// as a u16, the hats as four bytes and the buttons as a u64. A full state is
+/// simply a frame with every bit set.
+enum StateField : std::uint16_t {
+    kFieldAxis0 = 1u << 0, // axes 0..7 occupy bits 0..7
+    kFieldTrigger0 = 1u << kMaxAxes, // triggers 0..1 occupy bits 8..9
+    kFieldHats = 1u << (kMaxAxes + kMaxTriggers),
+    kFieldButtons = 1u << (kMaxAxes + kMaxTriggers + 1),
+    kAllFields = (1u << (kMaxAxes + kMaxTriggers + 2)) - 1,
+};
+
+/// Size of a frame carrying every field.
+inline constexpr std::size_t kMaxWireStateSize = 2 + 2 * kMaxAxes + 2 * kMaxTriggers + 2 * kMaxHats + 8;
+
+/// Mask of the fields that differ between `a` and `b`.
+[[nodiscard]] std::uint16_t diff_fields(const JoystickState& a, const JoystickState& b) noexcept;
+
+/// Writes the fields of `state` selected by `mask` to `out`, which must hold
+/// kMaxWireStateSize bytes. Returns the number of bytes written.
+std::size_t encode_fields(const JoystickState& state, std::uint16_t mask, std::byte* out) noexcept;
+
+/// Applies a frame from `in` onto `state`. Returns the number of bytes
+/// consumed, or 0 if the frame is truncated or carries unknown field bits;
+/// `state` is left untouched in that case.
+std::size_t decode_fields(const std::byte* in, std::size_t size, JoystickState& state) noexcept;
+
+/// Encodes a stream of states as deltas against the previously encoded one.
+/// The first frame after construction or reset() carries every field.
+class DeltaEncoder {
+public:
+    /// Writes the delta from the last encoded state to `next` into `out`
+    /// (kMaxWireStateSize bytes). An unchanged state encodes as a bare zero
+    /// mask of two bytes.
+    std::size_t encode(const JoystickState& next, std::byte* out) noexcept
+    {
+        const std::uint16_t mask = primed_ ? diff_fields(last_, next) : std::uint16_t{kAllFields};
+        last_ = next;
+        primed_ = true;
+        return encode_fields(next, mask, out);
+    }
+
+    /// Forces the next frame to be a full state, e.g. after packet loss.
+    void reset() noexcept { primed_ = false; }
+
+private:
+    JoystickState last_{};
+    bool primed_ = false;
+};
+
+} // namespace vjc
@@ -0,0 +1,120 @@
+#include "vjc/alloc_guard.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace vjc {
+
+namespace {
+
+std::atomic<unsigned> g_armed{0};
+std::atomic<std::uint64_t> g_allocations{0};
+std::atomic<std::uint64_t> g_bytes{0};
+
+void note(std::size_t size) noexcept
+{
+    if (g_armed.load(std::memory_order_relaxed) != 0) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+void* allocate(std::size_t size, std::size_t align, bool nothrow)
+{
+    note(size);
+    if (size == 0)
+        size = 1;
+    for (;;) {
+        void* p = nullptr;
+        if (align <= alignof(std::max_align_t))
+            p = std::malloc(size);
+        else if (::posix_memalign(&p, align, size) != 0)
+            p = nullptr;
+        if (p)
+            return p;
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            if (nothrow)
+                return nullptr;
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocate_nothrow(std::size_t size, std::size_t align) noexcept
+{
+    try {
+        return allocate(size, align, true);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+AllocationGuard::AllocationGuard() noexcept
+{
+    g_armed.fetch_add(1, std::memory_order_relaxed);
+    allocations_ = g_allocations.load(std::memory_order_relaxed);
+    bytes_ = g_bytes.load(std::memory_order_relaxed);
+}
+
+AllocationGuard::~AllocationGuard() { g_armed.fetch_sub(1, std::memory_order_relaxed); }
+
+std::uint64_t AllocationGuard::allocations() const noexcept
+{
+    return g_allocations.load(std::memory_order_relaxed) - allocations_;
+}
+
+std::uint64_t AllocationGuard::bytes() const noexcept { return g_bytes.load(std::memory_order_relaxed) - bytes_; }
+
+void AllocationGuard::check(const char* what) const
+{
+    if (const std::uint64_t n = allocations(); n != 0)
+        throw std::runtime_error(std::string(what) + ": " + std::to_string(n) + " heap allocations ("
+                                 + std::to_string(bytes()) + " bytes) after warm-up");
+}
+
+} // namespace vjc
+
+// Replacement global allocation functions. Everything goes through malloc
+// and free, so every delete form can share one definition.
+
+void* operator new(std::size_t size) { return vjc::allocate(size, 0, false); }
+void* operator new[](std::size_t size) { return vjc::allocate(size, 0, false); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return vjc::allocate_nothrow(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return vjc::allocate_nothrow(size, 0); }
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    return vjc::allocate(size, static_cast<std::size_t>(align), false);
+}
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+    return vjc::allocate(size, static_cast<std::size_t>(align), false);
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return vjc::allocate_nothrow(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return vjc::allocate_nothrow(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
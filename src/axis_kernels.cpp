@@ -0,0 +1,181 @@
+// Per-ISA implementations of the fused axis shaping kernel.
+//
+// All tiers evaluate exactly the same sequence of IEEE single-precision
+// operations (no FMA contraction, round-to-nearest conversion), so their
+// outputs are bit-identical:
+//
+//   v   = raw / 32767
+//   m   = sqrt(x^2 + y^2)                                      (per stick)
+//   k   = max(m - radial_dz, 0) * radial_scale / max(m, tiny)  (scales x and y)
+//   a   = copysign(max(|v_axis| - dz, 0) * dz_scale, v_axis)
+//   e   = a + expo * (a^3 - a)
+//   out = round(clamp(e * gain, -1, 1) * 32767)
+
+#include "axis_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace vjc::detail {
+
+namespace {
+
+constexpr float kToUnit = 1.0f / 32767.0f;
+constexpr float kFromUnit = 32767.0f;
+constexpr float kTiny = 1e-9f;
+
+inline float shape_axis_scalar(float v, float dz, float dz_scale, float expo, float gain) noexcept
+{
+    const float t = std::max(std::fabs(v) - dz, 0.0f) * dz_scale;
+    const float a = std::copysign(t, v);
+    const float e = a + expo * (a * a * a - a);
+    return std::min(std::max(e * gain, -1.0f), 1.0f);
+}
+
+} // namespace
+
+void shape_axes_scalar(const AxisKernelArgs& args) noexcept
+{
+    const float* const* p = args.param;
+    for (std::size_t i = 0; i < args.count; ++i) {
+        float x = static_cast<float>(args.x[i]) * kToUnit;
+        float y = static_cast<float>(args.y[i]) * kToUnit;
+
+        const float m = std::sqrt(x * x + y * y);
+        const float k = std::max(m - p[kRadialDeadzone][i], 0.0f) * p[kRadialScale][i] / std::max(m, kTiny);
+        x *= k;
+        y *= k;
+
+        x = shape_axis_scalar(x, p[kDeadzoneX][i], p[kDeadzoneScaleX][i], p[kExpoX][i], p[kGainX][i]);
+        y = shape_axis_scalar(y, p[kDeadzoneY][i], p[kDeadzoneScaleY][i], p[kExpoY][i], p[kGainY][i]);
+
+        args.x[i] = static_cast<std::int16_t>(std::nearbyint(x * kFromUnit));
+        args.y[i] = static_cast<std::int16_t>(std::nearbyint(y * kFromUnit));
+    }
+}
+
+#if defined(__x86_64__)
+
+namespace {
+
+inline __m128 shape_axis_sse2(__m128 v, __m128 dz, __m128 dz_scale, __m128 expo, __m128 gain) noexcept
+{
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 t = _mm_mul_ps(_mm_max_ps(_mm_sub_ps(_mm_andnot_ps(sign, v), dz), _mm_setzero_ps()), dz_scale);
+    const __m128 a = _mm_or_ps(t, _mm_and_ps(v, sign));
+    const __m128 cube = _mm_mul_ps(_mm_mul_ps(a, a), a);
+    const __m128 e = _mm_add_ps(a, _mm_mul_ps(expo, _mm_sub_ps(cube, a)));
+    return _mm_min_ps(_mm_max_ps(_mm_mul_ps(e, gain), _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+}
+
+inline __m128 load_i16x4(const std::int16_t* src) noexcept
+{
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+inline void store_i16x4(std::int16_t* dst, __m128 v) noexcept
+{
+    const __m128i i = _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(kFromUnit)));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packs_epi32(i, i));
+}
+
+__attribute__((target("avx2"))) inline __m256 shape_axis_avx2(__m256 v, __m256 dz, __m256 dz_scale, __m256 expo,
+                                                               __m256 gain) noexcept
+{
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 t = _mm256_mul_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_andnot_ps(sign, v), dz), _mm256_setzero_ps()),
+                                   dz_scale);
+    const __m256 a = _mm256_or_ps(t, _mm256_and_ps(v, sign));
+    const __m256 cube = _mm256_mul_ps(_mm256_mul_ps(a, a), a);
+    const __m256 e = _mm256_add_ps(a, _mm256_mul_ps(expo, _mm256_sub_ps(cube, a)));
+    return _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(e, gain), _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+}
+
+__attribute__((target("avx2"))) inline __m256 load_i16x8(const std::int16_t* src) noexcept
+{
+    const __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(src));
+    return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v));
+}
+
+__attribute__((target("avx2"))) inline void store_i16x8(std::int16_t* dst, __m256 v) noexcept
+{
+    const __m256i i = _mm256_cvtps_epi32(_mm256_mul_ps(v, _mm256_set1_ps(kFromUnit)));
+    const __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+    _mm_store_si128(reinterpret_cast<__m128i*>(dst), packed);
+}
+
+} // namespace
+
+void shape_axes_sse2(const AxisKernelArgs& args) noexcept
+{
+    const float* const* p = args.param;
+    const __m128 to_unit = _mm_set1_ps(kToUnit);
+    for (std::size_t i = 0; i < args.count; i += 4) {
+        __m128 x = _mm_mul_ps(load_i16x4(args.x + i), to_unit);
+        __m128 y = _mm_mul_ps(load_i16x4(args.y + i), to_unit);
+
+        const __m128 m = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+        const __m128 excess = _mm_max_ps(_mm_sub_ps(m, _mm_load_ps(p[kRadialDeadzone] + i)), _mm_setzero_ps());
+        const __m128 k = _mm_div_ps(_mm_mul_ps(excess, _mm_load_ps(p[kRadialScale] + i)),
+                                    _mm_max_ps(m, _mm_set1_ps(kTiny)));
+        x = _mm_mul_ps(x, k);
+        y = _mm_mul_ps(y, k);
+
+        x = shape_axis_sse2(x, _mm_load_ps(p[kDeadzoneX] + i), _mm_load_ps(p[kDeadzoneScaleX] + i),
+                            _mm_load_ps(p[kExpoX] + i), _mm_load_ps(p[kGainX] + i));
+        y = shape_axis_sse2(y, _mm_load_ps(p[kDeadzoneY] + i), _mm_load_ps(p[kDeadzoneScaleY] + i),
+                            _mm_load_ps(p[kExpoY] + i), _mm_load_ps(p[kGainY] + i));
+
+        store_i16x4(args.x + i, x);
+        store_i16x4(args.y + i, y);
+    }
+}
+
+__attribute__((target("avx2"))) void shape_axes_avx2(const AxisKernelArgs& args) noexcept
+{
+    const float* const* p = args.param;
+    const __m256 to_unit = _mm256_set1_ps(kToUnit);
+    for (std::size_t i = 0; i < args.count; i += 8) {
+        __m256 x = _mm256_mul_ps(load_i16x8(args.x + i), to_unit);
+        __m256 y = _mm256_mul_ps(load_i16x8(args.y + i), to_unit);
+
+        const __m256 m = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+        const __m256 excess =
+            _mm256_max_ps(_mm256_sub_ps(m, _mm256_load_ps(p[kRadialDeadzone] + i)), _mm256_setzero_ps());
+        const __m256 k = _mm256_div_ps(_mm256_mul_ps(excess, _mm256_load_ps(p[kRadialScale] + i)),
+                                       _mm256_max_ps(m, _mm256_set1_ps(kTiny)));
+        x = _mm256_mul_ps(x, k);
+        y = _mm256_mul_ps(y, k);
+
+        x = shape_axis_avx2(x, _mm256_load_ps(p[kDeadzoneX] + i), _mm256_load_ps(p[kDeadzoneScaleX] + i),
+                            _mm256_load_ps(p[kExpoX] + i), _mm256_load_ps(p[kGainX] + i));
+        y = shape_axis_avx2(y, _mm256_load_ps(p[kDeadzoneY] + i), _mm256_load_ps(p[kDeadzoneScaleY] + i),
+                            _mm256_load_ps(p[kExpoY] + i), _mm256_load_ps(p[kGainY] + i));
+
+        store_i16x8(args.x + i, x);
+        store_i16x8(args.y + i, y);
+    }
+}
+
+#endif
+
+AxisKernel axis_kernel(SimdLevel level) noexcept
+{
+    switch (supported_simd_level(level)) {
+#if defined(__x86_64__)
+    case SimdLevel::Avx2:
+        return &shape_axes_avx2;
+    case SimdLevel::Sse2:
+        return &shape_axes_sse2;
+#endif
+    default:
+        return &shape_axes_scalar;
+    }
+}
+
+} // namespace vjc::detail
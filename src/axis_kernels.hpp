@@ -0,0 +1,45 @@
+#pragma once
+
+// Internal interface between AxisProcessor and its per-ISA kernels.
+
+#include "vjc/cpu_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc::detail {
+
+enum AxisParam : std::size_t {
+    kRadialDeadzone,
+    kRadialScale, ///< 1 / (1 - radial deadzone)
+    kDeadzoneX,
+    kDeadzoneScaleX, ///< 1 / (1 - deadzone)
+    kExpoX,
+    kGainX, ///< gain, negated when inverted
+    kDeadzoneY,
+    kDeadzoneScaleY,
+    kExpoY,
+    kGainY,
+    kAxisParamCount,
+};
+
+/// `count` stick lanes; every array holds `count` elements, `count` is a
+/// multiple of 8 and every pointer is 32-byte aligned.
+struct AxisKernelArgs {
+    std::int16_t* x;
+    std::int16_t* y;
+    const float* param[kAxisParamCount];
+    std::size_t count;
+};
+
+using AxisKernel = void (*)(const AxisKernelArgs&) noexcept;
+
+void shape_axes_scalar(const AxisKernelArgs& args) noexcept;
+#if defined(__x86_64__)
+void shape_axes_sse2(const AxisKernelArgs& args) noexcept;
+void shape_axes_avx2(const AxisKernelArgs& args) noexcept;
+#endif
+
+AxisKernel axis_kernel(SimdLevel level) noexcept;
+
+} // namespace vjc::detail
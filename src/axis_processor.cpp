@@ -0,0 +1,112 @@
+#include "vjc/axis_processor.hpp"
+
+#include "vjc/stage_stats.hpp"
+
+#include "axis_kernels.hpp"
+
+#include <stdexcept>
+
+namespace vjc {
+
+namespace {
+
+constexpr std::size_t kLaneAlignment = 8; // widest kernel (AVX2) processes 8 lanes
+
+void check_fraction(float value, const char* what)
+{
+    if (!(value >= 0.0f && value < 1.0f))
+        throw std::invalid_argument(what);
+}
+
+void check_curve(const AxisCurve& curve)
+{
+    check_fraction(curve.deadzone, "AxisCurve: deadzone must be in [0, 1)");
+    if (!(curve.expo >= 0.0f && curve.expo <= 1.0f))
+        throw std::invalid_argument("AxisCurve: expo must be in [0, 1]");
+    if (!(curve.gain >= 0.0f))
+        throw std::invalid_argument("AxisCurve: gain must be non-negative");
+}
+
+} // namespace
+
+AxisProcessor::AxisProcessor(std::size_t devices, SimdLevel level)
+    : devices_(devices)
+    , stride_((devices + kLaneAlignment - 1) / kLaneAlignment * kLaneAlignment)
+    , level_(supported_simd_level(level))
+    , x_(kSticks * stride_)
+    , y_(kSticks * stride_)
+    , params_(detail::kAxisParamCount * kSticks * stride_)
+{
+    if (devices == 0)
+        throw std::invalid_argument("AxisProcessor: no devices");
+    for (std::size_t d = 0; d < stride_; ++d)
+        for (std::size_t s = 0; s < kSticks; ++s)
+            configure_lane(d, s, StickCurve{});
+}
+
+void AxisProcessor::configure(std::size_t device, std::size_t stick, const StickCurve& curve)
+{
+    if (device >= devices_ || stick >= kSticks)
+        throw std::out_of_range("AxisProcessor: no such device or stick");
+    check_fraction(curve.radial_deadzone, "StickCurve: radial deadzone must be in [0, 1)");
+    check_curve(curve.x);
+    check_curve(curve.y);
+    configure_lane(device, stick, curve);
+}
+
+void AxisProcessor::configure_lane(std::size_t device, std::size_t stick, const StickCurve& curve) noexcept
+{
+    const std::size_t lanes = kSticks * stride_;
+    const std::size_t i = index(device, stick);
+    float* p = params_.data();
+    p[detail::kRadialDeadzone * lanes + i] = curve.radial_deadzone;
+    p[detail::kRadialScale * lanes + i] = 1.0f / (1.0f - curve.radial_deadzone);
+    p[detail::kDeadzoneX * lanes + i] = curve.x.deadzone;
+    p[detail::kDeadzoneScaleX * lanes + i] = 1.0f / (1.0f - curve.x.deadzone);
+    p[detail::kExpoX * lanes + i] = curve.x.expo;
+    p[detail::kGainX * lanes + i] = curve.x.invert ? -curve.x.gain : curve.x.gain;
+    p[detail::kDeadzoneY * lanes + i] = curve.y.deadzone;
+    p[detail::kDeadzoneScaleY * lanes + i] = 1.0f / (1.0f - curve.y.deadzone);
+    p[detail::kExpoY * lanes + i] = curve.y.expo;
+    p[detail::kGainY * lanes + i] = curve.y.invert ? -curve.y.gain : curve.y.gain;
+}
+
+void AxisProcessor::load(std::size_t device, const JoystickState& state) noexcept
+{
+    for (std::size_t s = 0; s < kSticks; ++s) {
+        x_[index(device, s)] = state.axes[2 * s];
+        y_[index(device, s)] = state.axes[2 * s + 1];
+    }
+}
+
+void AxisProcessor::store(std::size_t device, JoystickState& state) const noexcept
+{
+    for (std::size_t s = 0; s < kSticks; ++s) {
+        state.axes[2 * s] = x_[index(device, s)];
+        state.axes[2 * s + 1] = y_[index(device, s)];
+    }
+}
+
+void AxisProcessor::run() noexcept
+{
+    const StageTimer timer(Stage::Shape);
+    const std::size_t lanes = kSticks * stride_;
+    detail::AxisKernelArgs args{};
+    args.x = x_.data();
+    args.y = y_.data();
+    for (std::size_t k = 0; k < detail::kAxisParamCount; ++k)
+        args.param[k] = params_.data() + k * lanes;
+    args.count = lanes;
+    detail::axis_kernel(level_)(args);
+}
+
+void AxisProcessor::process(JoystickState* states, std::size_t count) noexcept
+{
+    for (std::size_t d = 0; d < count; ++d)
+        load(d, states[d]);
+    run();
+    for (std::size_t d = 0; d < count; ++d)
+        store(d, states[d]);
+}
+
+} // namespace vjc
@@ -0,0 +1,204 @@
+#include "vjc/button_sequencer.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace vjc {
+
+ButtonSequencer::ButtonSequencer(std::size_t devices, std::size_t capacity, std::uint64_t tick_ns,
+                                 std::uint64_t now_ns)
+    : wheel_(capacity, tick_ns, now_ns)
+    , patterns_(capacity)
+    , devices_(devices)
+{
+    dirty_.reserve(devices);
+    changed_.reserve(devices);
+}
+
+SequenceId ButtonSequencer::turbo(std::size_t device, std::uint64_t buttons, std::uint64_t period_ns,
+                                  std::uint64_t now_ns) noexcept
+{
+    if (device >= devices_.size() || buttons == 0 || period_ns == 0)
+        return kNoSequence;
+    const std::uint32_t index = acquire(device);
+    if (index == kNil)
+        return kNoSequence;
+    Pattern& pattern = patterns_[index];
+    pattern.buttons = buttons;
+    pattern.half_period_ns = period_ns / 2 ? period_ns / 2 : 1;
+    pattern.pressed = true;
+    if (!arm(index, now_ns + pattern.half_period_ns))
+        return kNoSequence;
+    touch(pattern.device);
+    return static_cast<SequenceId>(pattern.generation) << 32 | index;
+}
+
+SequenceId ButtonSequencer::play(std::size_t device, std::shared_ptr<const ButtonSequence> sequence,
+                                 std::uint64_t now_ns) noexcept
+{
+    if (device >= devices_.size() || !sequence || sequence->steps.empty())
+        return kNoSequence;
+    for (const SequenceStep& s : sequence->steps)
+        if (s.duration_ns == 0)
+            return kNoSequence;
+    const std::uint32_t index = acquire(device);
+    if (index == kNil)
+        return kNoSequence;
+    Pattern& pattern = patterns_[index];
+    pattern.buttons = sequence->steps[0].buttons;
+    const std::uint64_t duration = sequence->steps[0].duration_ns;
+    pattern.sequence = std::move(sequence);
+    if (!arm(index, now_ns + duration))
+        return kNoSequence;
+    touch(pattern.device);
+    return static_cast<SequenceId>(pattern.generation) << 32 | index;
+}
+
+bool ButtonSequencer::cancel(SequenceId id) noexcept
+{
+    const auto index = static_cast<std::uint32_t>(id);
+    if (index >= patterns_.capacity())
+        return false;
+    Pattern& pattern = patterns_[index];
+    if (pattern.generation != static_cast<std::uint32_t>(id >> 32) || pattern.timer == kNoTimer)
+        return false;
+    wheel_.cancel(pattern.timer);
+    touch(pattern.device);
+    release(index);
+    return true;
+}
+
+void ButtonSequencer::cancel_turbo(std::size_t device, std::uint64_t buttons) noexcept
+{
+    if (device >= devices_.size())
+        return;
+    for (std::uint32_t index = devices_[device].head; index != kNil;) {
+        Pattern& pattern = patterns_[index];
+        const std::uint32_t next = pattern.next;
+        if (!pattern.sequence && (pattern.buttons & buttons) != 0)
+            cancel(static_cast<SequenceId>(pattern.generation) << 32 | index);
+        index = next;
+    }
+}
+
+void ButtonSequencer::cancel_device(std::size_t device) noexcept
+{
+    if (device >= devices_.size())
+        return;
+    while (devices_[device].head != kNil) {
+        const std::uint32_t index = devices_[device].head;
+        cancel(static_cast<SequenceId>(patterns_[index].generation) << 32 | index);
+    }
+}
+
+std::span<const std::uint32_t> ButtonSequencer::advance(std::uint64_t now_ns) noexcept
+{
+    wheel_.advance(now_ns, [&](TimerId, std::uint64_t cookie, std::uint64_t deadline_ns) {
+        ++stats_.transitions;
+        if (now_ns > deadline_ns && now_ns - deadline_ns > stats_.max_late_ns)
+            stats_.max_late_ns = now_ns - deadline_ns;
+        step(static_cast<std::uint32_t>(cookie), now_ns);
+    });
+
+    changed_.clear();
+    for (const std::uint32_t d : dirty_) {
+        Device& device = devices_[d];
+        device.dirty = false;
+        std::uint64_t overlay = 0;
+        for (std::uint32_t index = device.head; index != kNil; index = patterns_[index].next)
+            overlay |= held(patterns_[index]);
+        if (overlay != device.overlay) {
+            device.overlay = overlay;
+            changed_.push_back(d);
+        }
+    }
+    dirty_.clear();
+    return changed_;
+}
+
+std::uint32_t ButtonSequencer::acquire(std::size_t device) noexcept
+{
+    const std::uint32_t index = patterns_.acquire();
+    if (index == kNil) {
+        ++stats_.rejected;
+        return kNil;
+    }
+    Pattern& pattern = patterns_[index];
+    pattern.device = static_cast<std::uint32_t>(device);
+    pattern.step = 0;
+    pattern.pressed = false;
+    pattern.half_period_ns = 0;
+    pattern.prev = kNil;
+    pattern.next = devices_[device].head;
+    if (pattern.next != kNil)
+        patterns_[pattern.next].prev = index;
+    devices_[device].head = index;
+    return index;
+}
+
+void ButtonSequencer::release(std::uint32_t index) noexcept
+{
+    Pattern& pattern = patterns_[index];
+    Device& device = devices_[pattern.device];
+    if (pattern.prev != kNil)
+        patterns_[pattern.prev].next = pattern.next;
+    else
+        device.head = pattern.next;
+    if (pattern.next != kNil)
+        patterns_[pattern.next].prev = pattern.prev;
+    pattern.sequence.reset();
+    pattern.timer = kNoTimer;
+    if (++pattern.generation == 0)
+        pattern.generation = 1;
+    patterns_.release(index);
+}
+
+bool ButtonSequencer::arm(std::uint32_t index, std::uint64_t deadline_ns) noexcept
+{
+    // Every pattern holds one timer and the wheel has one per pattern, so
+    // this only fails if the two pools disagree.
+    Pattern& pattern = patterns_[index];
+    pattern.deadline_ns = deadline_ns;
+    pattern.timer = wheel_.schedule(deadline_ns, index);
+    if (pattern.timer != kNoTimer)
+        return true;
+    ++stats_.rejected;
+    release(index);
+    return false;
+}
+
+void ButtonSequencer::step(std::uint32_t index, std::uint64_t now_ns) noexcept
+{
+    Pattern& pattern = patterns_[index];
+    touch(pattern.device);
+    if (!pattern.sequence) {
+        // After a stall, drop whole missed periods rather than replaying them.
+        const std::uint64_t period = 2 * pattern.half_period_ns;
+        std::uint64_t deadline = pattern.deadline_ns + pattern.half_period_ns;
+        if (deadline <= now_ns)
+            deadline += (now_ns - deadline) / period * period;
+        pattern.pressed = !pattern.pressed;
+        arm(index, deadline);
+        return;
+    }
+    const std::vector<SequenceStep>& steps = pattern.sequence->steps;
+    if (++pattern.step == steps.size()) {
+        if (!pattern.sequence->repeat) {
+            release(index);
+            return;
+        }
+        pattern.step = 0;
+    }
+    pattern.buttons = steps[pattern.step].buttons;
+    arm(index, pattern.deadline_ns + steps[pattern.step].duration_ns);
+}
+
+void ButtonSequencer::touch(std::uint32_t device) noexcept
+{
+    if (!devices_[device].dirty) {
+        devices_[device].dirty = true;
+        dirty_.push_back(device);
+    }
+}
+
+} // namespace vjc
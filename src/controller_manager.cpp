@@ -0,0 +1,323 @@
+#include "vjc/controller_manager.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/profile_store.hpp"
+#include "vjc/stage_stats.hpp"
+
+#include <sched.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace vjc {
+
+namespace {
+
+/// Increment for counters with a single writer: avoids a locked RMW.
+inline void bump(std::atomic<std::uint64_t>& counter, std::uint64_t n = 1) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/// Time from publish to the writer taking `state` off the ring.
+inline void record_pickup([[maybe_unused]] const JoystickState& state) noexcept
+{
+#if VJC_STATS
+    if (state.timestamp_ns != 0)
+        record_stage(Stage::Coalesce, monotonic_ns() - state.timestamp_ns);
+#endif
+}
+
+} // namespace
+
+ControllerManager::ControllerManager(ManagerConfig config)
+    : config_(std::move(config))
+{
+    if (config_.writer_threads == 0)
+        throw std::invalid_argument("ControllerManager: at least one writer thread is required");
+    if (config_.schedule.policy != SchedulePolicy::Passthrough) {
+        if (config_.schedule.period_ns == 0)
+            throw std::invalid_argument("ControllerManager: schedule period must be positive");
+        config_.ring_mode = RingMode::Queue;
+    }
+    if (config_.sequence_capacity != 0 && config_.sequence_tick_ns == 0)
+        throw std::invalid_argument("ControllerManager: sequence tick must be positive");
+    const int priority = config_.realtime.fifo_priority;
+    if (priority != 0
+        && (priority < ::sched_get_priority_min(SCHED_FIFO) || priority > ::sched_get_priority_max(SCHED_FIFO)))
+        throw std::invalid_argument("ControllerManager: SCHED_FIFO priority out of range");
+    for (unsigned i = 0; i < config_.writer_threads; ++i) {
+        auto writer = std::make_unique<Writer>();
+        writer->index = i;
+        if (!config_.cpus.empty())
+            writer->cpu = config_.cpus[i % config_.cpus.size()];
+        writers_.push_back(std::move(writer));
+    }
+}
+
+ControllerManager::~ControllerManager()
+{
+    stop();
+}
+
+std::size_t ControllerManager::add_device(std::unique_ptr<VirtualJoystick> joystick)
+{
+    if (running())
+        throw std::logic_error("ControllerManager: cannot add devices while running");
+    if (!joystick)
+        throw std::invalid_argument("ControllerManager: null device");
+
+    auto slot = std::make_unique<Slot>(config_.ring_mode, config_.schedule);
+    slot->joystick = std::move(joystick);
+    slot->index = slots_.size();
+    slot->writer = writers_[slot->index % writers_.size()].get();
+    slot->local = static_cast<std::uint32_t>(slot->writer->slots.size());
+    if (config_.sequence_capacity != 0)
+        slot->commands = std::make_unique<CommandRing>();
+    slot->writer->slots.push_back(slot.get());
+    slots_.push_back(std::move(slot));
+    return slots_.size() - 1;
+}
+
+void ControllerManager::attach_profile(std::size_t device, ProfileStore* store)
+{
+    if (running())
+        throw std::logic_error("ControllerManager: cannot attach profiles while running");
+    if (device >= slots_.size())
+        throw std::invalid_argument("ControllerManager: unknown device");
+    if (store && (store->device_count() <= device || store->reader_count() < writers_.size()))
+        throw std::invalid_argument("ControllerManager: profile store too small for this manager");
+    slots_[device]->profile = store;
+}
+
+std::uint32_t ControllerManager::add_sequence(ButtonSequence sequence)
+{
+    if (running())
+        throw std::logic_error("ControllerManager: cannot add sequences while running");
+    if (sequence.steps.empty())
+        throw std::invalid_argument("ControllerManager: empty sequence");
+    for (const SequenceStep& step : sequence.steps)
+        if (step.duration_ns == 0)
+            throw std::invalid_argument("ControllerManager: sequence step without a duration");
+    sequences_.push_back(std::make_shared<const ButtonSequence>(std::move(sequence)));
+    return static_cast<std::uint32_t>(sequences_.size() - 1);
+}
+
+void ControllerManager::start()
+{
+    if (running_.exchange(true))
+        return;
+    pinned_.store(0, std::memory_order_relaxed);
+    fifo_.store(0, std::memory_order_relaxed);
+    // Before the threads exist, so their stacks are locked as they map them.
+    if (config_.realtime.lock_memory && !memory_locked_)
+        memory_locked_ = lock_memory();
+    for (auto& writer : writers_) {
+        if (config_.sequence_capacity != 0)
+            writer->sequencer = std::make_unique<ButtonSequencer>(writer->slots.size(), config_.sequence_capacity,
+                                                                  config_.sequence_tick_ns, monotonic_ns());
+        Writer* w = writer.get();
+        w->thread = std::thread([this, w] { run_writer(*w); });
+    }
+}
+
+void ControllerManager::stop() noexcept
+{
+    if (!running_.exchange(false))
+        return;
+    for (auto& writer : writers_) {
+        writer->ring_doorbell();
+        writer->thread.join();
+    }
+}
+
+ControllerManager::DeviceStats ControllerManager::stats(std::size_t device) const noexcept
+{
+    const Slot& slot = *slots_[device];
+    DeviceStats s;
+    s.frames = slot.frames.load(std::memory_order_relaxed);
+    s.events = slot.events.load(std::memory_order_relaxed);
+    s.failed_frames = slot.failed.load(std::memory_order_relaxed);
+    s.coalesced = slot.ring.coalesced() + slot.scheduled.load(std::memory_order_relaxed);
+    s.dropped = slot.ring.dropped();
+    s.edge_frames = slot.edge_frames.load(std::memory_order_relaxed);
+    return s;
+}
+
+void ControllerManager::run_writer(Writer& writer) noexcept
+{
+    if (writer.cpu >= 0 && pin_current_thread(writer.cpu))
+        pinned_.fetch_add(1, std::memory_order_relaxed);
+    const bool fifo = config_.realtime.fifo_priority != 0 && set_fifo_priority(config_.realtime.fifo_priority);
+    if (fifo)
+        fifo_.fetch_add(1, std::memory_order_relaxed);
+
+    // A SCHED_FIFO spinner on the only CPU would keep the producers from
+    // running until the spin ran out.
+    const std::uint64_t spin_ns = fifo && std::thread::hardware_concurrency() <= 1 ? 0 : config_.realtime.spin_ns;
+    const bool scheduled = config_.schedule.policy != SchedulePolicy::Passthrough;
+    const bool timed = scheduled || writer.sequencer;
+    const std::size_t count = writer.slots.size();
+    std::size_t start = 0;
+    for (;;) {
+        const std::uint32_t ticket = writer.doorbell.prepare();
+        const std::uint64_t now = timed ? monotonic_ns() : 0;
+        std::uint64_t deadline = Doorbell::kForever;
+        bool any = false;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::size_t k = start + i;
+            if (k >= count)
+                k -= count;
+            Slot& slot = *writer.slots[k];
+            if (scheduled) {
+                any |= schedule(writer, slot, now);
+                deadline = std::min(deadline, slot.scheduler.deadline());
+            } else {
+                any |= service(writer, slot);
+            }
+        }
+        if (++start >= count)
+            start = 0;
+        if (writer.sequencer) {
+            any |= sequence(writer, now);
+            deadline = std::min(deadline, writer.sequencer->next_deadline());
+        }
+
+        if (!any) {
+            if (!running_.load(std::memory_order_acquire)) {
+                // Flush frames still held back by the scheduler.
+                for (Slot* slot : writer.slots)
+                    if (slot->scheduler.deadline() != OutputScheduler::kNoDeadline)
+                        schedule(writer, *slot, slot->scheduler.deadline());
+                return;
+            }
+            writer.doorbell.wait(ticket, deadline, spin_ns);
+        }
+    }
+}
+
+bool ControllerManager::service(Writer& writer, Slot& slot) noexcept
+{
+    JoystickState state;
+    if (slot.ring.mode() == RingMode::Coalesce) {
+        if (!slot.ring.pop_latest(state))
+            return false;
+        emit(writer, slot, state);
+        return true;
+    }
+    bool any = false;
+    while (slot.ring.pop(state)) {
+        emit(writer, slot, state);
+        any = true;
+    }
+    return any;
+}
+
+bool ControllerManager::schedule(Writer& writer, Slot& slot, std::uint64_t now) noexcept
+{
+    // The scheduler holds frames after the profile and the overlay, so an
+    // overlay change is paced, and its taps kept, like any other frame.
+    OutputScheduler& scheduler = slot.scheduler;
+    JoystickState state;
+    while (slot.ring.pop(state)) {
+        record_pickup(state);
+        map(writer, slot, state);
+        scheduler.push(overlaid(writer, slot));
+    }
+
+    JoystickState frames[OutputScheduler::kMaxFrames];
+    const std::size_t n = scheduler.poll(now, frames);
+    if (n == 0)
+        return false;
+    for (std::size_t i = 0; i < n; ++i)
+        write(writer, slot, frames[i]);
+    slot.scheduled.store(scheduler.coalesced(), std::memory_order_relaxed);
+    slot.edge_frames.store(scheduler.edge_frames(), std::memory_order_relaxed);
+    return true;
+}
+
+bool ControllerManager::sequence(Writer& writer, std::uint64_t now) noexcept
+{
+    ButtonSequencer& sequencer = *writer.sequencer;
+    for (Slot* slot : writer.slots) {
+        SequenceCommand cmd;
+        while (slot->commands->try_pop(cmd)) {
+            switch (cmd.kind) {
+            case SequenceCommand::Turbo:
+                sequencer.cancel_turbo(slot->local, cmd.buttons);
+                if (cmd.period_ns != 0)
+                    sequencer.turbo(slot->local, cmd.buttons, cmd.period_ns, now);
+                break;
+            case SequenceCommand::Play:
+                if (cmd.sequence < sequences_.size())
+                    sequencer.play(slot->local, sequences_[cmd.sequence], now);
+                break;
+            case SequenceCommand::Stop:
+                sequencer.cancel_device(slot->local);
+                break;
+            }
+        }
+    }
+
+    // Re-send the last mapped frame of every device whose overlay moved,
+    // paced by the scheduler when there is one.
+    const auto changed = sequencer.advance(now);
+    const bool scheduled = config_.schedule.policy != SchedulePolicy::Passthrough;
+    for (const std::uint32_t local : changed) {
+        Slot& slot = *writer.slots[local];
+        JoystickState frame = overlaid(writer, slot);
+        frame.timestamp_ns = 0;
+        if (scheduled)
+            slot.scheduler.push(frame);
+        else
+            write(writer, slot, frame);
+    }
+    return !changed.empty();
+}
+
+void ControllerManager::emit(Writer& writer, Slot& slot, const JoystickState& state) noexcept
+{
+    record_pickup(state);
+    map(writer, slot, state);
+    write(writer, slot, overlaid(writer, slot));
+}
+
+void ControllerManager::map(Writer& writer, Slot& slot, const JoystickState& state) noexcept
+{
+    // The profile is pinned for this frame only: a reload publishes for the
+    // next one and frees the old profile once no writer holds it.
+    if (slot.profile) {
+        const auto profile = slot.profile->read(writer.index);
+        if (profile) {
+            profile->apply(slot.index, state, slot.output);
+            return;
+        }
+    }
+    slot.output = state;
+}
+
+JoystickState ControllerManager::overlaid(const Writer& writer, const Slot& slot) const noexcept
+{
+    JoystickState frame = slot.output;
+    if (writer.sequencer)
+        frame.buttons |= writer.sequencer->overlay(slot.local);
+    return frame;
+}
+
+void ControllerManager::write(Writer& writer, Slot& slot, const JoystickState& frame) noexcept
+{
+    VirtualJoystick& joystick = *slot.joystick;
+    const std::uint64_t failed_before = joystick.stats().failed_frames;
+    const std::size_t events = joystick.submit(frame);
+    if (events != 0) {
+        bump(slot.frames);
+        bump(slot.events, events);
+        if (observer_)
+            observer_->on_frame(writer.index, slot.index, frame, events);
+    } else if (joystick.stats().failed_frames != failed_before) {
+        bump(slot.failed);
+    }
+}
+
+} // namespace vjc
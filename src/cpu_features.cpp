@@ -0,0 +1,56 @@
+#include "vjc/cpu_features.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace vjc {
+
+namespace {
+
+SimdLevel hardware_level() noexcept
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::Avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdLevel::Sse2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+} // namespace
+
+SimdLevel supported_simd_level(SimdLevel requested) noexcept
+{
+    static const SimdLevel hardware = hardware_level();
+    return std::min(requested, hardware);
+}
+
+SimdLevel detect_simd_level() noexcept
+{
+    SimdLevel level = SimdLevel::Avx2;
+    if (const char* env = std::getenv("VJC_SIMD")) {
+        if (std::strcmp(env, "scalar") == 0)
+            level = SimdLevel::Scalar;
+        else if (std::strcmp(env, "sse2") == 0)
+            level = SimdLevel::Sse2;
+    }
+    return supported_simd_level(level);
+}
+
+const char* to_string(SimdLevel level) noexcept
+{
+    switch (level) {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::Sse2:
+        return "sse2";
+    case SimdLevel::Avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+} // namespace vjc
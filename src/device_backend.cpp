@@ -0,0 +1,150 @@
+#include "vjc/device_backend.hpp"
+
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+namespace vjc {
+
+namespace {
+
+void xioctl(int fd, unsigned long request, unsigned long arg, const char* what)
+{
+    if (::ioctl(fd, request, arg) < 0)
+        throw std::system_error(errno, std::system_category(), what);
+}
+
+void setup_abs(int fd, const AbsAxisInfo& info)
+{
+    xioctl(fd, UI_SET_ABSBIT, info.code, "UI_SET_ABSBIT");
+    uinput_abs_setup abs{};
+    abs.code = info.code;
+    abs.absinfo.minimum = info.min;
+    abs.absinfo.maximum = info.max;
+    abs.absinfo.fuzz = info.fuzz;
+    abs.absinfo.flat = info.flat;
+    abs.absinfo.resolution = info.resolution;
+    if (::ioctl(fd, UI_ABS_SETUP, &abs) < 0)
+        throw std::system_error(errno, std::system_category(), "UI_ABS_SETUP");
+}
+
+} // namespace
+
+FdBackend::FdBackend(int fd, bool owned) noexcept
+    : fd_(fd)
+    , owned_(owned)
+{
+}
+
+FdBackend::~FdBackend()
+{
+    if (owned_ && fd_ >= 0)
+        ::close(fd_);
+}
+
+void FdBackend::create(const DeviceDescriptor& descriptor)
+{
+    descriptor.validate();
+}
+
+bool FdBackend::write_events(const input_event* events, std::size_t count) noexcept
+{
+    const std::size_t bytes = count * sizeof(input_event);
+    for (;;) {
+        const ssize_t n = ::write(fd_, events, bytes);
+        if (n == static_cast<ssize_t>(bytes))
+            return true;
+        if (n < 0 && errno == EINTR)
+            continue;
+        return false;
+    }
+}
+
+UinputBackend::UinputBackend(const std::string& path)
+    : FdBackend(::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC))
+{
+    if (fd_ < 0)
+        throw std::system_error(errno, std::system_category(), "open " + path);
+}
+
+UinputBackend::~UinputBackend()
+{
+    if (created_)
+        ::ioctl(fd_, UI_DEV_DESTROY);
+}
+
+void UinputBackend::create(const DeviceDescriptor& descriptor)
+{
+    descriptor.validate();
+
+    xioctl(fd_, UI_SET_EVBIT, EV_SYN, "UI_SET_EVBIT");
+    if (!descriptor.buttons.empty()) {
+        xioctl(fd_, UI_SET_EVBIT, EV_KEY, "UI_SET_EVBIT");
+        for (auto code : descriptor.buttons)
+            xioctl(fd_, UI_SET_KEYBIT, code, "UI_SET_KEYBIT");
+    }
+    if (!descriptor.axes.empty() || !descriptor.triggers.empty() || descriptor.hat_count) {
+        xioctl(fd_, UI_SET_EVBIT, EV_ABS, "UI_SET_EVBIT");
+        for (const auto& a : descriptor.axes)
+            setup_abs(fd_, a);
+        for (const auto& t : descriptor.triggers)
+            setup_abs(fd_, t);
+        for (unsigned h = 0; h < descriptor.hat_count; ++h) {
+            setup_abs(fd_, {static_cast<std::uint16_t>(ABS_HAT0X + 2 * h), -1, 1, 0, 0});
+            setup_abs(fd_, {static_cast<std::uint16_t>(ABS_HAT0Y + 2 * h), -1, 1, 0, 0});
+        }
+    }
+
+    if (!descriptor.misc.empty()) {
+        xioctl(fd_, UI_SET_EVBIT, EV_MSC, "UI_SET_EVBIT");
+        for (auto code : descriptor.misc)
+            xioctl(fd_, UI_SET_MSCBIT, code, "UI_SET_MSCBIT");
+    }
+    for (auto code : descriptor.properties)
+        xioctl(fd_, UI_SET_PROPBIT, code, "UI_SET_PROPBIT");
+
+    if (descriptor.ff_effects != 0) {
+        xioctl(fd_, UI_SET_EVBIT, EV_FF, "UI_SET_EVBIT");
+        for (auto code : descriptor.ff_features)
+            xioctl(fd_, UI_SET_FFBIT, code, "UI_SET_FFBIT");
+    }
+
+    uinput_setup setup{};
+    setup.id.bustype = descriptor.bustype;
+    setup.id.vendor = descriptor.vendor;
+    setup.id.product = descriptor.product;
+    setup.id.version = descriptor.version;
+    std::strncpy(setup.name, descriptor.name.c_str(), UINPUT_MAX_NAME_SIZE - 1);
+    setup.ff_effects_max = descriptor.ff_effects;
+    if (::ioctl(fd_, UI_DEV_SETUP, &setup) < 0)
+        throw std::system_error(errno, std::system_category(), "UI_DEV_SETUP");
+    xioctl(fd_, UI_DEV_CREATE, 0, "UI_DEV_CREATE");
+    created_ = true;
+}
+
+bool UinputBackend::ff_begin_upload(uinput_ff_upload& upload) noexcept
+{
+    return ::ioctl(fd_, UI_BEGIN_FF_UPLOAD, &upload) == 0;
+}
+
+bool UinputBackend::ff_end_upload(const uinput_ff_upload& upload) noexcept
+{
+    return ::ioctl(fd_, UI_END_FF_UPLOAD, &upload) == 0;
+}
+
+bool UinputBackend::ff_begin_erase(uinput_ff_erase& erase) noexcept
+{
+    return ::ioctl(fd_, UI_BEGIN_FF_ERASE, &erase) == 0;
+}
+
+bool UinputBackend::ff_end_erase(const uinput_ff_erase& erase) noexcept
+{
+    return ::ioctl(fd_, UI_END_FF_ERASE, &erase) == 0;
+}
+
+} // namespace vjc
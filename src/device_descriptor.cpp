@@ -0,0 +1,107 @@
+#include "vjc/device_descriptor.hpp"
+
+#include "vjc/joystick_state.hpp"
+
+#include <linux/input.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vjc {
+
+DeviceDescriptor DeviceDescriptor::gamepad()
+{
+    DeviceDescriptor d;
+    d.name = "VirtualJoystickController Gamepad";
+    d.axes = {
+        {ABS_X, -32768, 32767, 16, 128},
+        {ABS_Y, -32768, 32767, 16, 128},
+        {ABS_RX, -32768, 32767, 16, 128},
+        {ABS_RY, -32768, 32767, 16, 128},
+    };
+    d.triggers = {
+        {ABS_Z, 0, 65535, 0, 0},
+        {ABS_RZ, 0, 65535, 0, 0},
+    };
+    d.hat_count = 1;
+    d.buttons = {
+        BTN_SOUTH, BTN_EAST, BTN_NORTH, BTN_WEST,
+        BTN_TL, BTN_TR, BTN_SELECT, BTN_START,
+        BTN_MODE, BTN_THUMBL, BTN_THUMBR,
+    };
+    return d;
+}
+
+DeviceDescriptor DeviceDescriptor::rumble_gamepad()
+{
+    DeviceDescriptor d = gamepad();
+    d.ff_features = {FF_RUMBLE, FF_PERIODIC, FF_SINE, FF_SQUARE, FF_TRIANGLE, FF_CONSTANT, FF_GAIN};
+    d.ff_effects = 16;
+    return d;
+}
+
+DeviceDescriptor DeviceDescriptor::motion_sensor()
+{
+    DeviceDescriptor d;
+    d.name = "VirtualJoystickController Motion Sensors";
+    d.axes = {
+        {ABS_X, -32768, 32767, 16, 0, 8192},
+        {ABS_Y, -32768, 32767, 16, 0, 8192},
+        {ABS_Z, -32768, 32767, 16, 0, 8192},
+        {ABS_RX, -2097152, 2097152, 16, 0, 1024},
+        {ABS_RY, -2097152, 2097152, 16, 0, 1024},
+        {ABS_RZ, -2097152, 2097152, 16, 0, 1024},
+    };
+    d.properties = {INPUT_PROP_ACCELEROMETER};
+    d.misc = {MSC_TIMESTAMP};
+    return d;
+}
+
+void DeviceDescriptor::validate() const
+{
+    if (axes.size() > kMaxAxes)
+        throw std::invalid_argument("descriptor: too many axes");
+    if (triggers.size() > kMaxTriggers)
+        throw std::invalid_argument("descriptor: too many triggers");
+    if (hat_count > kMaxHats)
+        throw std::invalid_argument("descriptor: too many hats");
+    if (buttons.size() > kMaxButtons)
+        throw std::invalid_argument("descriptor: too many buttons");
+
+    if (ff_effects > kMaxFfEffects)
+        throw std::invalid_argument("descriptor: too many force-feedback effects");
+    if (ff_effects != 0 && ff_features.empty())
+        throw std::invalid_argument("descriptor: force-feedback effects without features");
+    for (const auto code : ff_features)
+        if (code > FF_MAX)
+            throw std::invalid_argument("descriptor: force-feedback code out of range");
+    for (const auto code : properties)
+        if (code > INPUT_PROP_MAX)
+            throw std::invalid_argument("descriptor: input property out of range");
+    for (const auto code : misc)
+        if (code > MSC_MAX)
+            throw std::invalid_argument("descriptor: misc code out of range");
+
+    std::vector<std::uint16_t> abs_codes;
+    for (const auto& a : axes)
+        abs_codes.push_back(a.code);
+    for (const auto& t : triggers)
+        abs_codes.push_back(t.code);
+    for (unsigned h = 0; h < hat_count; ++h) {
+        abs_codes.push_back(static_cast<std::uint16_t>(ABS_HAT0X + 2 * h));
+        abs_codes.push_back(static_cast<std::uint16_t>(ABS_HAT0Y + 2 * h));
+    }
+    std::vector<std::uint16_t> key_codes = buttons;
+
+    for (auto* codes : {&abs_codes, &key_codes}) {
+        std::sort(codes->begin(), codes->end());
+        if (std::adjacent_find(codes->begin(), codes->end()) != codes->end())
+            throw std::invalid_argument("descriptor: duplicate evdev code");
+    }
+    if (!abs_codes.empty() && abs_codes.back() > ABS_MAX)
+        throw std::invalid_argument("descriptor: axis code out of range");
+    if (!key_codes.empty() && key_codes.back() > KEY_MAX)
+        throw std::invalid_argument("descriptor: button code out of range");
+}
+
+} // namespace vjc
@@ -0,0 +1,69 @@
+#include "vjc/doorbell.hpp"
+
+#include "vjc/clock.hpp"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <climits>
+#include <ctime>
+
+namespace vjc {
+
+namespace {
+
+long futex(std::atomic<std::uint32_t>& word, int op, std::uint32_t value, const timespec* timeout) noexcept
+{
+    return ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), op, value, timeout, nullptr, 0);
+}
+
+} // namespace
+
+void Doorbell::ring() noexcept
+{
+    sequence_.fetch_add(1, std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_seq_cst) != 0)
+        futex(sequence_, process_shared_ ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+}
+
+bool Doorbell::wait(std::uint32_t ticket, std::uint64_t deadline_ns, std::uint64_t spin_ns) noexcept
+{
+    if (spin_ns != 0) {
+        // A spinning consumer is not counted in waiters_, so ring() stays
+        // out of the kernel too. The clock is read every 64 polls.
+        const std::uint64_t start = monotonic_ns();
+        const std::uint64_t until = start + spin_ns < deadline_ns ? start + spin_ns : deadline_ns;
+        for (unsigned i = 1; sequence_.load(std::memory_order_acquire) == ticket; ++i) {
+            cpu_relax();
+            if (i % 64 == 0 && monotonic_ns() >= until)
+                break;
+        }
+        if (sequence_.load(std::memory_order_acquire) != ticket)
+            return true;
+        if (until == deadline_ns)
+            return false;
+    }
+
+    const int op = process_shared_ ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE;
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    bool rung = true;
+    while (sequence_.load(std::memory_order_seq_cst) == ticket) {
+        if (deadline_ns == kForever) {
+            futex(sequence_, op, ticket, nullptr);
+            continue;
+        }
+        const std::uint64_t now = monotonic_ns();
+        if (now >= deadline_ns) {
+            rung = false;
+            break;
+        }
+        const std::uint64_t left = deadline_ns - now;
+        const timespec timeout{static_cast<time_t>(left / 1'000'000'000u), static_cast<long>(left % 1'000'000'000u)};
+        futex(sequence_, op, ticket, &timeout);
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return rung;
+}
+
+} // namespace vjc
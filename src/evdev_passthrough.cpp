@@ -0,0 +1,370 @@
+#include "vjc/evdev_passthrough.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+
+namespace vjc {
+
+namespace {
+
+constexpr std::size_t kMaxReadyEvents = 16;
+constexpr std::size_t kLoopReadEvents = 64; // per read() in serve()
+
+/// Default source range for a target when neither the binding nor the
+/// device provides one.
+void default_range(EvdevTarget target, std::int32_t& min, std::int32_t& max) noexcept
+{
+    switch (target) {
+    case EvdevTarget::Axis:
+        min = -32768;
+        max = 32767;
+        break;
+    case EvdevTarget::Trigger:
+        min = 0;
+        max = 65535;
+        break;
+    default:
+        min = -1;
+        max = 1;
+        break;
+    }
+}
+
+} // namespace
+
+std::vector<EvdevBinding> EvdevSource::gamepad_bindings()
+{
+    std::vector<EvdevBinding> b = {
+        {EV_ABS, ABS_X, EvdevTarget::Axis, 0},
+        {EV_ABS, ABS_Y, EvdevTarget::Axis, 1},
+        {EV_ABS, ABS_RX, EvdevTarget::Axis, 2},
+        {EV_ABS, ABS_RY, EvdevTarget::Axis, 3},
+        {EV_ABS, ABS_Z, EvdevTarget::Trigger, 0},
+        {EV_ABS, ABS_RZ, EvdevTarget::Trigger, 1},
+        {EV_ABS, ABS_HAT0X, EvdevTarget::Hat, 0},
+        {EV_ABS, ABS_HAT0Y, EvdevTarget::Hat, 1},
+    };
+    const std::uint16_t buttons[] = {BTN_SOUTH, BTN_EAST, BTN_NORTH, BTN_WEST, BTN_TL, BTN_TR,
+                                     BTN_SELECT, BTN_START, BTN_MODE, BTN_THUMBL, BTN_THUMBR};
+    for (std::uint8_t i = 0; i < std::size(buttons); ++i)
+        b.push_back({EV_KEY, buttons[i], EvdevTarget::Button, i});
+    return b;
+}
+
+EvdevPassthrough::EvdevPassthrough(ControllerManager& manager, std::vector<EvdevSource> sources, EvdevConfig config)
+    : manager_(manager)
+    , config_(config)
+    , states_(manager.device_count())
+{
+    if (config_.read_events == 0)
+        throw std::invalid_argument("EvdevPassthrough: read_events must be positive");
+    if (sources.empty())
+        throw std::invalid_argument("EvdevPassthrough: no sources");
+    buffer_.resize(config_.read_events);
+
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+        throw std::system_error(errno, std::system_category(), "epoll_create1");
+
+    sources_.reserve(sources.size());
+    try {
+        for (EvdevSource& config_source : sources) {
+            if (config_source.device >= manager.device_count())
+                throw std::invalid_argument("EvdevPassthrough: source targets an unknown device");
+
+            Source& source = sources_.emplace_back();
+            source.device = config_source.device;
+            source.curves = std::move(config_source.curves);
+            source.mapping = std::move(config_source.mapping);
+            if (source.mapping)
+                source.mapping_state.reset(*source.mapping);
+            source.abs.resize(ABS_CNT);
+            source.keys.resize(KEY_CNT);
+            if (config_source.fd >= 0) {
+                source.fd = config_source.fd;
+                ::fcntl(source.fd, F_SETFL, ::fcntl(source.fd, F_GETFL) | O_NONBLOCK);
+            } else {
+                source.fd = ::open(config_source.path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+                if (source.fd < 0)
+                    throw std::system_error(errno, std::system_category(), "open " + config_source.path);
+            }
+
+            // A real evdev node answers EVIOCGVERSION; pipes and sockets do not.
+            int version = 0;
+            source.evdev = ::ioctl(source.fd, EVIOCGVERSION, &version) == 0;
+            if (source.evdev) {
+                int clock = CLOCK_MONOTONIC;
+                ::ioctl(source.fd, EVIOCSCLOCKID, &clock);
+                if (config_source.grab) {
+                    if (::ioctl(source.fd, EVIOCGRAB, 1) < 0)
+                        throw std::system_error(errno, std::system_category(), "EVIOCGRAB");
+                    source.grabbed = true;
+                }
+            }
+
+            for (const EvdevBinding& binding : config_source.bindings) {
+                const bool abs = binding.type == EV_ABS;
+                if ((!abs && binding.type != EV_KEY) || binding.code >= (abs ? ABS_CNT : KEY_CNT))
+                    throw std::invalid_argument("EvdevPassthrough: binding code out of range");
+                const unsigned limit = binding.target == EvdevTarget::Axis      ? kMaxAxes
+                                       : binding.target == EvdevTarget::Trigger ? kMaxTriggers
+                                       : binding.target == EvdevTarget::Hat     ? 2 * kMaxHats
+                                                                                : kMaxButtons;
+                if (binding.index >= limit)
+                    throw std::invalid_argument("EvdevPassthrough: binding index out of range");
+
+                Route route{binding.target, binding.index, binding.invert, binding.min, 1};
+                std::int32_t max = binding.max;
+                if (abs && binding.min == binding.max) {
+                    input_absinfo info{};
+                    if (source.evdev && ::ioctl(source.fd, EVIOCGABS(binding.code), &info) == 0
+                        && info.maximum > info.minimum) {
+                        route.min = info.minimum;
+                        max = info.maximum;
+                    } else {
+                        default_range(binding.target, route.min, max);
+                    }
+                }
+                route.span = max > route.min ? max - route.min : 1;
+                (abs ? source.abs : source.keys)[binding.code] = route;
+            }
+
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.u64 = sources_.size() - 1;
+            if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, source.fd, &ev) < 0)
+                throw std::system_error(errno, std::system_category(), "epoll_ctl");
+            resync(source);
+        }
+    } catch (...) {
+        for (Source& source : sources_) {
+            if (source.grabbed)
+                ::ioctl(source.fd, EVIOCGRAB, 0);
+            if (source.fd >= 0)
+                ::close(source.fd);
+        }
+        for (std::size_t i = sources_.size(); i < sources.size(); ++i)
+            if (sources[i].fd >= 0)
+                ::close(sources[i].fd);
+        ::close(epoll_fd_);
+        throw;
+    }
+}
+
+EvdevPassthrough::~EvdevPassthrough()
+{
+    stop();
+    for (Source& source : sources_) {
+        if (source.grabbed)
+            ::ioctl(source.fd, EVIOCGRAB, 0);
+        ::close(source.fd);
+    }
+    ::close(epoll_fd_);
+}
+
+std::size_t EvdevPassthrough::poll(int timeout_ms) noexcept
+{
+    epoll_event ready[kMaxReadyEvents];
+    const int n = ::epoll_wait(epoll_fd_, ready, kMaxReadyEvents, timeout_ms);
+    std::size_t total = 0;
+    for (int i = 0; i < n; ++i)
+        total += drain(sources_[ready[i].data.u64]);
+    return total;
+}
+
+std::size_t EvdevPassthrough::drain(Source& source) noexcept
+{
+    auto* bytes = reinterpret_cast<char*>(buffer_.data());
+    const std::size_t capacity = buffer_.size() * sizeof(input_event);
+    std::size_t total = 0;
+    for (;;) {
+        // Evdev nodes only return whole events; other fds may split one.
+        std::size_t have = source.partial;
+        std::memcpy(bytes, source.tail, have);
+        const ssize_t n = ::read(source.fd, bytes + have, capacity - have);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR)
+                continue;
+            return total;
+        }
+        have += static_cast<std::size_t>(n);
+        total += consume(source, buffer_.data(), have);
+        if (have < capacity)
+            return total;
+    }
+}
+
+std::size_t EvdevPassthrough::consume(Source& source, const input_event* events, std::size_t bytes) noexcept
+{
+    ++stats_.reads;
+    const std::size_t count = bytes / sizeof(input_event);
+    for (std::size_t i = 0; i < count; ++i)
+        apply(source, events[i]);
+    source.partial = bytes - count * sizeof(input_event);
+    std::memcpy(source.tail, events + count, source.partial);
+    stats_.events += count;
+    return count;
+}
+
+void EvdevPassthrough::serve(IoLoop& loop)
+{
+    for (Source& source : sources_)
+        loop.spawn(receive(loop, source));
+}
+
+IoTask EvdevPassthrough::receive(IoLoop& loop, Source& source)
+{
+    // Each task reads into its own frame: with io_uring several reads are
+    // in flight at once, so the shared buffer_ cannot be used.
+    input_event events[kLoopReadEvents];
+    auto* bytes = reinterpret_cast<char*>(events);
+    for (;;) {
+        std::size_t have = source.partial;
+        std::memcpy(bytes, source.tail, have);
+        const long n = co_await loop.read(source.fd, bytes + have, sizeof events - have);
+        if (n <= 0) {
+            if (io_result_fatal(n))
+                co_return; // end of file, or the source went away
+            // Transient, such as a full submission ring: drain() would
+            // retry on its next poll, so retry on the loop's next turn.
+            if (n != -EINTR)
+                ++stats_.read_errors;
+            co_await loop.yield();
+            continue;
+        }
+        consume(source, events, have + static_cast<std::size_t>(n));
+    }
+}
+
+void EvdevPassthrough::apply(Source& source, const input_event& event) noexcept
+{
+    if (event.type == EV_SYN) {
+        if (event.code == SYN_DROPPED) {
+            ++stats_.dropped_syncs;
+            source.dropping = true;
+        } else if (event.code == SYN_REPORT) {
+            if (source.dropping) {
+                source.dropping = false;
+                resync(source);
+            }
+            publish(source);
+        }
+        return;
+    }
+    if (source.dropping)
+        return;
+
+    const Route* route = nullptr;
+    if (event.type == EV_ABS && event.code < source.abs.size())
+        route = &source.abs[event.code];
+    else if (event.type == EV_KEY && event.code < source.keys.size())
+        route = &source.keys[event.code];
+    if (!route || route->target == EvdevTarget::None) {
+        ++stats_.unmapped;
+        return;
+    }
+
+    JoystickState& state = states_[source.device];
+    const std::int64_t offset = static_cast<std::int64_t>(event.value) - route->min;
+    switch (route->target) {
+    case EvdevTarget::Axis: {
+        std::int64_t v = offset * 65535 / route->span - 32768;
+        v = v < -32768 ? -32768 : v > 32767 ? 32767 : v;
+        if (route->invert)
+            v = v == -32768 ? 32767 : -v;
+        state.axes[route->index] = static_cast<std::int16_t>(v);
+        break;
+    }
+    case EvdevTarget::Trigger: {
+        std::int64_t v = offset * 65535 / route->span;
+        v = v < 0 ? 0 : v > 65535 ? 65535 : v;
+        if (route->invert)
+            v = 65535 - v;
+        state.triggers[route->index] = static_cast<std::uint16_t>(v);
+        break;
+    }
+    case EvdevTarget::Hat: {
+        // Hats are centred whatever the source range; only the side matters.
+        const std::int64_t centred = 2 * offset - route->span;
+        std::int8_t v = centred < 0 ? -1 : centred > 0 ? 1 : 0;
+        state.hats[route->index] = static_cast<std::int8_t>(route->invert ? -v : v);
+        break;
+    }
+    case EvdevTarget::Button:
+        state.set_button(route->index, (event.value != 0) != route->invert);
+        break;
+    case EvdevTarget::None:
+        break;
+    }
+}
+
+void EvdevPassthrough::publish(Source& source) noexcept
+{
+    JoystickState* out = manager_.claim(source.device);
+    if (!out) {
+        ++stats_.ring_full;
+        return;
+    }
+    if (source.mapping)
+        source.mapping->apply(states_[source.device], source.mapping_state, *out);
+    else
+        *out = states_[source.device];
+    source.curves.apply(*out);
+    out->timestamp_ns = monotonic_ns();
+    out->sequence = static_cast<std::uint32_t>(++stats_.frames);
+    manager_.commit(source.device);
+}
+
+void EvdevPassthrough::resync(Source& source) noexcept
+{
+    if (!source.evdev)
+        return;
+    JoystickState& state = states_[source.device];
+    for (std::uint16_t code = 0; code < source.abs.size(); ++code) {
+        if (source.abs[code].target == EvdevTarget::None)
+            continue;
+        input_absinfo info{};
+        if (::ioctl(source.fd, EVIOCGABS(code), &info) == 0) {
+            const input_event event{{}, EV_ABS, code, info.value};
+            apply(source, event);
+        }
+    }
+    unsigned char keys[KEY_CNT / 8]{};
+    if (::ioctl(source.fd, EVIOCGKEY(sizeof keys), keys) < 0)
+        return;
+    for (std::uint16_t code = 0; code < source.keys.size(); ++code) {
+        const Route& route = source.keys[code];
+        if (route.target == EvdevTarget::Button)
+            state.set_button(route.index, ((keys[code / 8] >> (code % 8)) & 1) != route.invert);
+    }
+}
+
+void EvdevPassthrough::start()
+{
+    if (running_.exchange(true))
+        return;
+    thread_ = std::thread([this] {
+        while (running_.load(std::memory_order_relaxed))
+            poll(50);
+    });
+}
+
+void EvdevPassthrough::stop() noexcept
+{
+    if (!running_.exchange(false))
+        return;
+    thread_.join();
+}
+
+} // namespace vjc
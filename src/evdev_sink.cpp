@@ -0,0 +1,235 @@
+#include "vjc/evdev_sink.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/platform.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <thread>
+
+namespace vjc {
+
+namespace {
+
+// evdev_compute_buffer_size(): room for this many packets, at least this
+// many events.
+constexpr std::size_t kBufferPackets = 8;
+constexpr std::size_t kMinBufferSize = 64;
+
+/// input_defuzz_abs_event(): a value within fuzz of the current one is
+/// pulled towards it, within fuzz/2 it is discarded.
+std::int32_t defuzz(std::int32_t value, std::int32_t old, std::int32_t fuzz) noexcept
+{
+    if (fuzz) {
+        if (value > old - fuzz / 2 && value < old + fuzz / 2)
+            return old;
+        if (value > old - fuzz && value < old + fuzz)
+            return (old * 3 + value) / 4;
+        if (value > old - fuzz * 2 && value < old + fuzz * 2)
+            return (old + value) / 2;
+    }
+    return value;
+}
+
+} // namespace
+
+EvdevSink::EvdevSink(std::size_t capacity) noexcept
+    : requested_capacity_(capacity)
+{
+}
+
+void EvdevSink::create(const DeviceDescriptor& descriptor)
+{
+    if (created_)
+        throw std::logic_error("EvdevSink: device already created");
+    descriptor.validate();
+
+    auto add_abs = [this](const AbsAxisInfo& info) {
+        abs_bits_.set(info.code);
+        fuzz_[info.code] = info.fuzz;
+    };
+    for (const auto& a : descriptor.axes)
+        add_abs(a);
+    for (const auto& t : descriptor.triggers)
+        add_abs(t);
+    for (unsigned h = 0; h < descriptor.hat_count; ++h) {
+        add_abs({static_cast<std::uint16_t>(ABS_HAT0X + 2 * h), -1, 1, 0, 0});
+        add_abs({static_cast<std::uint16_t>(ABS_HAT0Y + 2 * h), -1, 1, 0, 0});
+    }
+    for (const auto code : descriptor.buttons)
+        key_bits_.set(code);
+    for (const auto code : descriptor.misc)
+        msc_bits_.set(code);
+
+    // input_estimate_events_per_packet(): every axis, plus room for keys
+    // and misc events.
+    const std::size_t estimate = kBufferPackets * (abs_bits_.count() + 7);
+    queue_.resize(std::bit_ceil(std::max(requested_capacity_ ? requested_capacity_ : estimate, kMinBufferSize)));
+    mask_ = queue_.size() - 1;
+    created_ = true;
+}
+
+void EvdevSink::lock() const noexcept
+{
+    // Held for a handful of stores; yield so a preempted holder on the same
+    // core gets to finish.
+    while (busy_.test_and_set(std::memory_order_acquire)) {
+        cpu_relax();
+        std::this_thread::yield();
+    }
+}
+
+void EvdevSink::unlock() const noexcept
+{
+    busy_.clear(std::memory_order_release);
+}
+
+void EvdevSink::push(const input_event& event) noexcept
+{
+    // __pass_event(): on overflow keep only SYN_DROPPED and the newest
+    // event, and hide both until the next SYN_REPORT.
+    queue_[head_] = event;
+    head_ = (head_ + 1) & mask_;
+    if (head_ == tail_) {
+        tail_ = (head_ - 2) & mask_;
+        input_event& dropped = queue_[tail_];
+        dropped = event;
+        dropped.type = EV_SYN;
+        dropped.code = SYN_DROPPED;
+        dropped.value = 0;
+        packet_head_ = tail_;
+        ++stats_.dropped;
+    }
+}
+
+bool EvdevSink::accept(input_event& event) noexcept
+{
+    // input_get_disposition() for the event types a descriptor can declare.
+    const std::uint16_t code = event.code;
+    switch (event.type) {
+    case EV_ABS:
+        if (code < ABS_CNT && abs_bits_.test(code)) {
+            const std::int32_t value = defuzz(event.value, abs_[code], fuzz_[code]);
+            if (value == abs_[code])
+                break;
+            abs_[code] = event.value = value;
+            return true;
+        }
+        ++stats_.ignored;
+        return false;
+    case EV_KEY:
+        if (code < KEY_CNT && key_bits_.test(code)) {
+            if (event.value == 2)
+                return true;
+            if (keys_.test(code) == (event.value != 0))
+                break;
+            keys_.flip(code);
+            return true;
+        }
+        ++stats_.ignored;
+        return false;
+    case EV_MSC:
+        if (code < MSC_CNT && msc_bits_.test(code))
+            return true;
+        ++stats_.ignored;
+        return false;
+    default:
+        ++stats_.ignored;
+        return false;
+    }
+    ++stats_.duplicates;
+    return false;
+}
+
+bool EvdevSink::write_events(const input_event* events, std::size_t count) noexcept
+{
+    if (!created_)
+        return false;
+    const std::uint64_t now = monotonic_ns();
+    bool readable = false;
+
+    lock();
+    stats_.written += count;
+    for (std::size_t i = 0; i < count; ++i) {
+        input_event e = events[i];
+        e.input_event_sec = static_cast<decltype(e.input_event_sec)>(now / 1'000'000'000u);
+        e.input_event_usec = static_cast<decltype(e.input_event_usec)>(now % 1'000'000'000u / 1'000u);
+        if (e.type == EV_SYN && e.code == SYN_REPORT) {
+            if (pending_ == 0) {
+                ++stats_.ignored;
+                continue;
+            }
+            push(e);
+            packet_head_ = head_;
+            pending_ = 0;
+            ++stats_.packets;
+            readable = true;
+        } else if (accept(e)) {
+            push(e);
+            ++pending_;
+        }
+    }
+    unlock();
+
+    if (readable)
+        readable_.ring();
+    return true;
+}
+
+std::size_t EvdevSink::read(input_event* out, std::size_t max) noexcept
+{
+    lock();
+    std::size_t n = 0;
+    while (n < max && tail_ != packet_head_) {
+        out[n++] = queue_[tail_];
+        tail_ = (tail_ + 1) & mask_;
+    }
+    stats_.read += n;
+    unlock();
+    return n;
+}
+
+bool EvdevSink::wait(std::uint64_t deadline_ns) noexcept
+{
+    for (;;) {
+        const std::uint32_t ticket = readable_.prepare();
+        lock();
+        const bool ready = tail_ != packet_head_;
+        unlock();
+        if (ready)
+            return true;
+        if (!readable_.wait(ticket, deadline_ns))
+            return false;
+    }
+}
+
+std::int32_t EvdevSink::abs_value(std::uint16_t code) const noexcept
+{
+    if (code >= ABS_CNT)
+        return 0;
+    lock();
+    const std::int32_t value = abs_[code];
+    unlock();
+    return value;
+}
+
+bool EvdevSink::key_down(std::uint16_t code) const noexcept
+{
+    if (code >= KEY_CNT)
+        return false;
+    lock();
+    const bool down = keys_.test(code);
+    unlock();
+    return down;
+}
+
+EvdevSink::Stats EvdevSink::stats() const noexcept
+{
+    lock();
+    const Stats stats = stats_;
+    unlock();
+    return stats;
+}
+
+} // namespace vjc
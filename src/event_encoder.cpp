@@ -0,0 +1,74 @@
+#include "vjc/event_encoder.hpp"
+
+#include <bit>
+
+namespace vjc {
+
+namespace {
+
+inline void put(input_event*& out, std::uint16_t type, std::uint16_t code, std::int32_t value) noexcept
+{
+    out->time = {};
+    out->type = type;
+    out->code = code;
+    out->value = value;
+    ++out;
+}
+
+} // namespace
+
+EventEncoder::EventEncoder(const DeviceDescriptor& descriptor)
+{
+    descriptor.validate();
+    axis_count_ = static_cast<std::uint8_t>(descriptor.axes.size());
+    for (std::size_t i = 0; i < descriptor.axes.size(); ++i)
+        axis_codes_[i] = descriptor.axes[i].code;
+    trigger_count_ = static_cast<std::uint8_t>(descriptor.triggers.size());
+    for (std::size_t i = 0; i < descriptor.triggers.size(); ++i)
+        trigger_codes_[i] = descriptor.triggers[i].code;
+    hat_count_ = static_cast<std::uint8_t>(descriptor.hat_count);
+    for (std::size_t i = 0; i < descriptor.buttons.size(); ++i) {
+        button_codes_[i] = descriptor.buttons[i];
+        button_mask_ |= std::uint64_t{1} << i;
+    }
+}
+
+template <bool Full>
+std::size_t EventEncoder::encode_impl(const JoystickState& prev, const JoystickState& next, input_event* out) const noexcept
+{
+    input_event* const begin = out;
+
+    for (unsigned i = 0; i < axis_count_; ++i)
+        if (Full || prev.axes[i] != next.axes[i])
+            put(out, EV_ABS, axis_codes_[i], next.axes[i]);
+    for (unsigned i = 0; i < trigger_count_; ++i)
+        if (Full || prev.triggers[i] != next.triggers[i])
+            put(out, EV_ABS, trigger_codes_[i], next.triggers[i]);
+    for (unsigned i = 0; i < hat_count_ * 2u; ++i)
+        if (Full || prev.hats[i] != next.hats[i])
+            put(out, EV_ABS, static_cast<std::uint16_t>(ABS_HAT0X + i), next.hats[i]);
+
+    std::uint64_t changed = (Full ? ~std::uint64_t{0} : prev.buttons ^ next.buttons) & button_mask_;
+    while (changed) {
+        const unsigned bit = static_cast<unsigned>(std::countr_zero(changed));
+        changed &= changed - 1;
+        put(out, EV_KEY, button_codes_[bit], next.button(bit) ? 1 : 0);
+    }
+
+    if (out == begin)
+        return 0;
+    put(out, EV_SYN, SYN_REPORT, 0);
+    return static_cast<std::size_t>(out - begin);
+}
+
+std::size_t EventEncoder::encode(const JoystickState& prev, const JoystickState& next, input_event* out) const noexcept
+{
+    return encode_impl<false>(prev, next, out);
+}
+
+std::size_t EventEncoder::encode_full(const JoystickState& state, input_event* out) const noexcept
+{
+    return encode_impl<true>(state, state, out);
+}
+
+} // namespace vjc
@@ -0,0 +1,252 @@
+// Per-ISA implementations of the input filter kernel.
+//
+// Every lane evaluates both filters and keeps the one its mode selects, so
+// lanes with different filters share one pass. All tiers evaluate exactly
+// the same sequence of IEEE single-precision operations (no FMA
+// contraction, round-to-nearest conversion), so their outputs are
+// bit-identical:
+//
+//   z  = raw / 32767
+//   One Euro (Casiez et al.), cutoffs as angular frequencies:
+//     y  = z - p
+//     ad = cd / (cd + 1/dt)
+//     vo = v + ad * (y / dt - v)
+//     c  = cut + beta * |vo|
+//     po = p + c / (c + 1/dt) * y
+//   Constant-velocity Kalman, white-noise acceleration q, measurement
+//   variance r:
+//     pp = p + dt v
+//     P' = F P F^T + q [dt^3/3 dt^2/2; dt^2/2 dt]
+//     k  = P'[.,0] / (P'00 + r)
+//     pk = pp + k0 (z - pp),  vk = v + k1 (z - pp)
+//     P  = (I - k H) P'
+//   out = round(clamp(p + v * lead, -1, 1) * 32767)
+
+#include "filter_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace vjc::detail {
+
+namespace {
+
+constexpr float kToUnit = 1.0f / 32767.0f;
+constexpr float kFromUnit = 32767.0f;
+
+} // namespace
+
+void filter_axes_scalar(const FilterKernelArgs& args) noexcept
+{
+    const float* const* k = args.param;
+    float* const* s = args.state;
+    const float dt = args.dt;
+    const float inv_dt = args.inv_dt;
+    for (std::size_t i = 0; i < args.count; ++i) {
+        const float z = static_cast<float>(args.x[i]) * kToUnit;
+        const float p = s[kPosition][i];
+        const float v = s[kVelocity][i];
+
+        const float y = z - p;
+        const float cd = k[kDerivative][i];
+        const float ad = cd / (cd + inv_dt);
+        const float vo = v + ad * (y * inv_dt - v);
+        const float c = k[kCutoff][i] + k[kBeta][i] * std::fabs(vo);
+        const float po = p + c / (c + inv_dt) * y;
+
+        const float q = k[kProcessNoise][i];
+        const float c00 = s[kCov00][i];
+        const float c01 = s[kCov01][i];
+        const float c11 = s[kCov11][i];
+        const float pp = p + dt * v;
+        const float p00 = c00 + dt * (c01 + c01 + dt * c11) + q * args.dt3_third;
+        const float p01 = c01 + dt * c11 + q * args.dt2_half;
+        const float p11 = c11 + q * dt;
+        const float inv_s = 1.0f / (p00 + k[kMeasurementNoise][i]);
+        const float k0 = p00 * inv_s;
+        const float k1 = p01 * inv_s;
+        const float yk = z - pp;
+        const float pk = pp + k0 * yk;
+        const float vk = v + k1 * yk;
+
+        float pn = z;
+        float vn = 0.0f;
+        if (args.mode[i] == kFilterKalman) {
+            pn = pk;
+            vn = vk;
+            s[kCov00][i] = (1.0f - k0) * p00;
+            s[kCov01][i] = (1.0f - k0) * p01;
+            s[kCov11][i] = p11 - k1 * p01;
+        } else if (args.mode[i] == kFilterSmooth) {
+            pn = po;
+            vn = vo;
+        }
+        s[kPosition][i] = pn;
+        s[kVelocity][i] = vn;
+
+        const float out = std::min(std::max(pn + vn * k[kLead][i], -1.0f), 1.0f);
+        args.x[i] = static_cast<std::int16_t>(std::nearbyint(out * kFromUnit));
+    }
+}
+
+#if defined(__x86_64__)
+
+namespace {
+
+inline __m128 select_sse2(__m128 mask, __m128 a, __m128 b) noexcept
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+__attribute__((target("avx2"))) inline __m256 select_avx2(__m256 mask, __m256 a, __m256 b) noexcept
+{
+    return _mm256_blendv_ps(b, a, mask);
+}
+
+} // namespace
+
+void filter_axes_sse2(const FilterKernelArgs& args) noexcept
+{
+    const float* const* k = args.param;
+    float* const* s = args.state;
+    const __m128 dt = _mm_set1_ps(args.dt);
+    const __m128 inv_dt = _mm_set1_ps(args.inv_dt);
+    const __m128 dt2_half = _mm_set1_ps(args.dt2_half);
+    const __m128 dt3_third = _mm_set1_ps(args.dt3_third);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128i smooth = _mm_set1_epi32(kFilterSmooth);
+    const __m128i kalman = _mm_set1_epi32(kFilterKalman);
+    for (std::size_t i = 0; i < args.count; i += 4) {
+        const __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(args.x + i));
+        const __m128 z = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16)),
+                                    _mm_set1_ps(kToUnit));
+        const __m128 p = _mm_load_ps(s[kPosition] + i);
+        const __m128 v = _mm_load_ps(s[kVelocity] + i);
+
+        const __m128 y = _mm_sub_ps(z, p);
+        const __m128 cd = _mm_load_ps(k[kDerivative] + i);
+        const __m128 ad = _mm_div_ps(cd, _mm_add_ps(cd, inv_dt));
+        const __m128 vo = _mm_add_ps(v, _mm_mul_ps(ad, _mm_sub_ps(_mm_mul_ps(y, inv_dt), v)));
+        const __m128 c = _mm_add_ps(_mm_load_ps(k[kCutoff] + i),
+                                    _mm_mul_ps(_mm_load_ps(k[kBeta] + i), _mm_andnot_ps(sign, vo)));
+        const __m128 po = _mm_add_ps(p, _mm_mul_ps(_mm_div_ps(c, _mm_add_ps(c, inv_dt)), y));
+
+        const __m128 q = _mm_load_ps(k[kProcessNoise] + i);
+        const __m128 c00 = _mm_load_ps(s[kCov00] + i);
+        const __m128 c01 = _mm_load_ps(s[kCov01] + i);
+        const __m128 c11 = _mm_load_ps(s[kCov11] + i);
+        const __m128 pp = _mm_add_ps(p, _mm_mul_ps(dt, v));
+        const __m128 p00 = _mm_add_ps(
+            _mm_add_ps(c00, _mm_mul_ps(dt, _mm_add_ps(_mm_add_ps(c01, c01), _mm_mul_ps(dt, c11)))),
+            _mm_mul_ps(q, dt3_third));
+        const __m128 p01 = _mm_add_ps(_mm_add_ps(c01, _mm_mul_ps(dt, c11)), _mm_mul_ps(q, dt2_half));
+        const __m128 p11 = _mm_add_ps(c11, _mm_mul_ps(q, dt));
+        const __m128 inv_s = _mm_div_ps(one, _mm_add_ps(p00, _mm_load_ps(k[kMeasurementNoise] + i)));
+        const __m128 k0 = _mm_mul_ps(p00, inv_s);
+        const __m128 k1 = _mm_mul_ps(p01, inv_s);
+        const __m128 yk = _mm_sub_ps(z, pp);
+        const __m128 pk = _mm_add_ps(pp, _mm_mul_ps(k0, yk));
+        const __m128 vk = _mm_add_ps(v, _mm_mul_ps(k1, yk));
+
+        const __m128i mode = _mm_load_si128(reinterpret_cast<const __m128i*>(args.mode + i));
+        const __m128 is_kalman = _mm_castsi128_ps(_mm_cmpeq_epi32(mode, kalman));
+        const __m128 is_smooth = _mm_castsi128_ps(_mm_cmpeq_epi32(mode, smooth));
+        const __m128 pn = select_sse2(is_kalman, pk, select_sse2(is_smooth, po, z));
+        const __m128 vn = select_sse2(is_kalman, vk, _mm_and_ps(is_smooth, vo));
+        _mm_store_ps(s[kPosition] + i, pn);
+        _mm_store_ps(s[kVelocity] + i, vn);
+        _mm_store_ps(s[kCov00] + i, select_sse2(is_kalman, _mm_mul_ps(_mm_sub_ps(one, k0), p00), c00));
+        _mm_store_ps(s[kCov01] + i, select_sse2(is_kalman, _mm_mul_ps(_mm_sub_ps(one, k0), p01), c01));
+        _mm_store_ps(s[kCov11] + i, select_sse2(is_kalman, _mm_sub_ps(p11, _mm_mul_ps(k1, p01)), c11));
+
+        const __m128 lead = _mm_add_ps(pn, _mm_mul_ps(vn, _mm_load_ps(k[kLead] + i)));
+        const __m128 out = _mm_min_ps(_mm_max_ps(lead, _mm_set1_ps(-1.0f)), one);
+        const __m128i packed = _mm_cvtps_epi32(_mm_mul_ps(out, _mm_set1_ps(kFromUnit)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(args.x + i), _mm_packs_epi32(packed, packed));
+    }
+}
+
+__attribute__((target("avx2"))) void filter_axes_avx2(const FilterKernelArgs& args) noexcept
+{
+    const float* const* k = args.param;
+    float* const* s = args.state;
+    const __m256 dt = _mm256_set1_ps(args.dt);
+    const __m256 inv_dt = _mm256_set1_ps(args.inv_dt);
+    const __m256 dt2_half = _mm256_set1_ps(args.dt2_half);
+    const __m256 dt3_third = _mm256_set1_ps(args.dt3_third);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256i smooth = _mm256_set1_epi32(kFilterSmooth);
+    const __m256i kalman = _mm256_set1_epi32(kFilterKalman);
+    for (std::size_t i = 0; i < args.count; i += 8) {
+        const __m128i raw = _mm_load_si128(reinterpret_cast<const __m128i*>(args.x + i));
+        const __m256 z = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(raw)), _mm256_set1_ps(kToUnit));
+        const __m256 p = _mm256_load_ps(s[kPosition] + i);
+        const __m256 v = _mm256_load_ps(s[kVelocity] + i);
+
+        const __m256 y = _mm256_sub_ps(z, p);
+        const __m256 cd = _mm256_load_ps(k[kDerivative] + i);
+        const __m256 ad = _mm256_div_ps(cd, _mm256_add_ps(cd, inv_dt));
+        const __m256 vo = _mm256_add_ps(v, _mm256_mul_ps(ad, _mm256_sub_ps(_mm256_mul_ps(y, inv_dt), v)));
+        const __m256 c = _mm256_add_ps(_mm256_load_ps(k[kCutoff] + i),
+                                       _mm256_mul_ps(_mm256_load_ps(k[kBeta] + i), _mm256_andnot_ps(sign, vo)));
+        const __m256 po = _mm256_add_ps(p, _mm256_mul_ps(_mm256_div_ps(c, _mm256_add_ps(c, inv_dt)), y));
+
+        const __m256 q = _mm256_load_ps(k[kProcessNoise] + i);
+        const __m256 c00 = _mm256_load_ps(s[kCov00] + i);
+        const __m256 c01 = _mm256_load_ps(s[kCov01] + i);
+        const __m256 c11 = _mm256_load_ps(s[kCov11] + i);
+        const __m256 pp = _mm256_add_ps(p, _mm256_mul_ps(dt, v));
+        const __m256 p00 = _mm256_add_ps(
+            _mm256_add_ps(c00, _mm256_mul_ps(dt, _mm256_add_ps(_mm256_add_ps(c01, c01), _mm256_mul_ps(dt, c11)))),
+            _mm256_mul_ps(q, dt3_third));
+        const __m256 p01 = _mm256_add_ps(_mm256_add_ps(c01, _mm256_mul_ps(dt, c11)), _mm256_mul_ps(q, dt2_half));
+        const __m256 p11 = _mm256_add_ps(c11, _mm256_mul_ps(q, dt));
+        const __m256 inv_s = _mm256_div_ps(one, _mm256_add_ps(p00, _mm256_load_ps(k[kMeasurementNoise] + i)));
+        const __m256 k0 = _mm256_mul_ps(p00, inv_s);
+        const __m256 k1 = _mm256_mul_ps(p01, inv_s);
+        const __m256 yk = _mm256_sub_ps(z, pp);
+        const __m256 pk = _mm256_add_ps(pp, _mm256_mul_ps(k0, yk));
+        const __m256 vk = _mm256_add_ps(v, _mm256_mul_ps(k1, yk));
+
+        const __m256i mode = _mm256_load_si256(reinterpret_cast<const __m256i*>(args.mode + i));
+        const __m256 is_kalman = _mm256_castsi256_ps(_mm256_cmpeq_epi32(mode, kalman));
+        const __m256 is_smooth = _mm256_castsi256_ps(_mm256_cmpeq_epi32(mode, smooth));
+        const __m256 pn = select_avx2(is_kalman, pk, select_avx2(is_smooth, po, z));
+        const __m256 vn = select_avx2(is_kalman, vk, _mm256_and_ps(is_smooth, vo));
+        _mm256_store_ps(s[kPosition] + i, pn);
+        _mm256_store_ps(s[kVelocity] + i, vn);
+        _mm256_store_ps(s[kCov00] + i, select_avx2(is_kalman, _mm256_mul_ps(_mm256_sub_ps(one, k0), p00), c00));
+        _mm256_store_ps(s[kCov01] + i, select_avx2(is_kalman, _mm256_mul_ps(_mm256_sub_ps(one, k0), p01), c01));
+        _mm256_store_ps(s[kCov11] + i, select_avx2(is_kalman, _mm256_sub_ps(p11, _mm256_mul_ps(k1, p01)), c11));
+
+        const __m256 lead = _mm256_add_ps(pn, _mm256_mul_ps(vn, _mm256_load_ps(k[kLead] + i)));
+        const __m256 out = _mm256_min_ps(_mm256_max_ps(lead, _mm256_set1_ps(-1.0f)), one);
+        const __m256i packed = _mm256_cvtps_epi32(_mm256_mul_ps(out, _mm256_set1_ps(kFromUnit)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(args.x + i),
+                        _mm_packs_epi32(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1)));
+    }
+}
+
+#endif
+
+FilterKernel filter_kernel(SimdLevel level) noexcept
+{
+    switch (supported_simd_level(level)) {
+#if defined(__x86_64__)
+    case SimdLevel::Avx2:
+        return &filter_axes_avx2;
+    case SimdLevel::Sse2:
+        return &filter_axes_sse2;
+#endif
+    default:
+        return &filter_axes_scalar;
+    }
+}
+
+} // namespace vjc::detail
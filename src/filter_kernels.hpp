@@ -0,0 +1,63 @@
+#pragma once
+
+// Internal interface between InputFilter and its per-ISA kernels.
+
+#include "vjc/cpu_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc::detail {
+
+/// Per-lane filter selector.
+enum FilterMode : std::int32_t {
+    kFilterPass,
+    kFilterSmooth, ///< One Euro; an EMA is One Euro with beta = 0
+    kFilterKalman,
+};
+
+enum FilterParam : std::size_t {
+    kCutoff,     ///< 2 pi min_cutoff
+    kBeta,       ///< 2 pi beta
+    kDerivative, ///< 2 pi derivative_cutoff
+    kProcessNoise,
+    kMeasurementNoise,
+    kLead, ///< seconds
+    kFilterParamCount,
+};
+
+enum FilterStateField : std::size_t {
+    kPosition, ///< full-scale units
+    kVelocity, ///< full-scale units per second
+    kCov00,
+    kCov01,
+    kCov11,
+    kFilterStateCount,
+};
+
+/// `count` axis lanes; every array holds `count` elements, `count` is a
+/// multiple of 8 and every pointer is 32-byte aligned. The frame constants
+/// are computed once by the caller so every tier sees the same values.
+struct FilterKernelArgs {
+    std::int16_t* x;
+    const std::int32_t* mode;
+    const float* param[kFilterParamCount];
+    float* state[kFilterStateCount];
+    std::size_t count;
+    float dt;
+    float inv_dt;
+    float dt2_half;  ///< dt^2 / 2
+    float dt3_third; ///< dt^3 / 3
+};
+
+using FilterKernel = void (*)(const FilterKernelArgs&) noexcept;
+
+void filter_axes_scalar(const FilterKernelArgs& args) noexcept;
+#if defined(__x86_64__)
+void filter_axes_sse2(const FilterKernelArgs& args) noexcept;
+void filter_axes_avx2(const FilterKernelArgs& args) noexcept;
+#endif
+
+FilterKernel filter_kernel(SimdLevel level) noexcept;
+
+} // namespace vjc::detail
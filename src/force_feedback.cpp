@@ -0,0 +1,232 @@
+#include "vjc/force_feedback.hpp"
+
+#include "vjc/controller_manager.hpp"
+#include "vjc/device_backend.hpp"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+namespace vjc {
+
+namespace {
+
+constexpr std::size_t kMaxReadyEvents = 16;
+constexpr std::size_t kReadEvents = 64;
+
+/// The command a client needs to reproduce `effect`.
+FfPacket describe(const ff_effect& effect) noexcept
+{
+    FfPacket packet;
+    packet.type = effect.type;
+    packet.length_ms = effect.replay.length;
+    packet.delay_ms = effect.replay.delay;
+    switch (effect.type) {
+    case FF_RUMBLE:
+        packet.strong = effect.u.rumble.strong_magnitude;
+        packet.weak = effect.u.rumble.weak_magnitude;
+        break;
+    case FF_PERIODIC:
+        packet.waveform = effect.u.periodic.waveform;
+        packet.period_ms = effect.u.periodic.period;
+        packet.strong = static_cast<std::uint16_t>(effect.u.periodic.magnitude);
+        packet.weak = static_cast<std::uint16_t>(effect.u.periodic.offset);
+        break;
+    case FF_CONSTANT:
+        packet.strong = static_cast<std::uint16_t>(effect.u.constant.level);
+        break;
+    default:
+        break;
+    }
+    return packet;
+}
+
+} // namespace
+
+ForceFeedback::ForceFeedback(ControllerManager& manager, FfSink& sink)
+    : sink_(sink)
+    , by_index_(manager.device_count(), -1)
+{
+    if (manager.running())
+        throw std::logic_error("ForceFeedback: manager already running");
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+        throw std::system_error(errno, std::system_category(), "epoll_create1");
+
+    for (std::size_t i = 0; i < manager.device_count(); ++i) {
+        VirtualJoystick& joystick = manager.device(i);
+        if (joystick.descriptor().ff_effects != 0 && joystick.backend().fd() >= 0) {
+            Device& device = devices_.emplace_back();
+            device.backend = &joystick.backend();
+            device.index = static_cast<std::uint16_t>(i);
+            device.slots.resize(joystick.descriptor().ff_effects);
+            by_index_[i] = static_cast<std::int32_t>(devices_.size() - 1);
+        }
+    }
+    for (std::size_t d = 0; d < devices_.size(); ++d) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = d;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, devices_[d].backend->fd(), &ev) < 0) {
+            const int err = errno;
+            ::close(epoll_fd_);
+            throw std::system_error(err, std::system_category(), "epoll_ctl");
+        }
+    }
+}
+
+ForceFeedback::~ForceFeedback()
+{
+    stop();
+    ::close(epoll_fd_);
+}
+
+std::size_t ForceFeedback::poll(int timeout_ms) noexcept
+{
+    epoll_event ready[kMaxReadyEvents];
+    const int n = ::epoll_wait(epoll_fd_, ready, kMaxReadyEvents, timeout_ms);
+    std::size_t total = 0;
+    for (int i = 0; i < n; ++i)
+        total += drain(devices_[ready[i].data.u64]);
+    return total;
+}
+
+std::size_t ForceFeedback::drain(Device& device) noexcept
+{
+    // One read per readiness: the fd may be blocking (the writers share it),
+    // and level-triggered epoll reports it again while more is queued.
+    input_event events[kReadEvents];
+    ssize_t n;
+    do
+        n = ::read(device.backend->fd(), events, sizeof events);
+    while (n < 0 && errno == EINTR);
+    if (n <= 0)
+        return 0;
+    const std::size_t count = static_cast<std::size_t>(n) / sizeof(input_event);
+    for (std::size_t i = 0; i < count; ++i) {
+        const input_event& event = events[i];
+        if (event.type == EV_UINPUT && event.code == UI_FF_UPLOAD)
+            upload(device, static_cast<std::uint32_t>(event.value));
+        else if (event.type == EV_UINPUT && event.code == UI_FF_ERASE)
+            erase(device, static_cast<std::uint32_t>(event.value));
+        else if (event.type == EV_FF)
+            play(device, event.code, event.value);
+    }
+    return count;
+}
+
+void ForceFeedback::upload(Device& device, std::uint32_t request) noexcept
+{
+    uinput_ff_upload upload{};
+    upload.request_id = request;
+    if (!device.backend->ff_begin_upload(upload)) {
+        ++stats_.failed;
+        return;
+    }
+    const auto id = static_cast<std::size_t>(upload.effect.id);
+    if (upload.effect.id < 0 || id >= device.slots.size()) {
+        ++stats_.rejected;
+        upload.retval = -EINVAL;
+    } else {
+        // An update of a playing effect keeps playing with the new parameters.
+        Slot& slot = device.slots[id];
+        slot.effect = upload.effect;
+        slot.loaded = true;
+        upload.retval = 0;
+        ++stats_.uploads;
+    }
+    if (!device.backend->ff_end_upload(upload))
+        ++stats_.failed;
+}
+
+void ForceFeedback::erase(Device& device, std::uint32_t request) noexcept
+{
+    uinput_ff_erase erase{};
+    erase.request_id = request;
+    if (!device.backend->ff_begin_erase(erase)) {
+        ++stats_.failed;
+        return;
+    }
+    if (erase.effect_id >= device.slots.size() || !device.slots[erase.effect_id].loaded) {
+        ++stats_.rejected;
+        erase.retval = -EINVAL;
+    } else {
+        Slot& slot = device.slots[erase.effect_id];
+        if (slot.playing) {
+            FfPacket packet;
+            packet.command = kFfStop;
+            packet.device = device.index;
+            packet.effect = static_cast<std::uint16_t>(erase.effect_id);
+            packet.type = slot.effect.type;
+            forward(packet);
+        }
+        slot = {};
+        erase.retval = 0;
+        ++stats_.erases;
+    }
+    if (!device.backend->ff_end_erase(erase))
+        ++stats_.failed;
+}
+
+void ForceFeedback::play(Device& device, std::uint16_t code, std::int32_t value) noexcept
+{
+    if (code == FF_GAIN) {
+        FfPacket packet;
+        packet.command = kFfGain;
+        packet.device = device.index;
+        packet.value = static_cast<std::uint32_t>(value);
+        forward(packet);
+        return;
+    }
+    if (code >= device.slots.size() || !device.slots[code].loaded) {
+        ++stats_.unknown;
+        return;
+    }
+    Slot& slot = device.slots[code];
+    FfPacket packet = describe(slot.effect);
+    packet.command = value > 0 ? kFfPlay : kFfStop;
+    packet.device = device.index;
+    packet.effect = code;
+    packet.value = static_cast<std::uint32_t>(value);
+    slot.playing = value > 0;
+    ++(value > 0 ? stats_.plays : stats_.stops);
+    forward(packet);
+}
+
+void ForceFeedback::forward(const FfPacket& packet) noexcept
+{
+    if (!sink_.send_ff(packet))
+        ++stats_.undelivered;
+}
+
+const ff_effect* ForceFeedback::effect(std::size_t device, int id) const noexcept
+{
+    if (device >= by_index_.size() || by_index_[device] < 0)
+        return nullptr;
+    const Device& d = devices_[static_cast<std::size_t>(by_index_[device])];
+    if (id < 0 || static_cast<std::size_t>(id) >= d.slots.size() || !d.slots[static_cast<std::size_t>(id)].loaded)
+        return nullptr;
+    return &d.slots[static_cast<std::size_t>(id)].effect;
+}
+
+void ForceFeedback::start()
+{
+    if (running_.exchange(true))
+        return;
+    thread_ = std::thread([this] {
+        while (running_.load(std::memory_order_relaxed))
+            poll(50);
+    });
+}
+
+void ForceFeedback::stop() noexcept
+{
+    if (!running_.exchange(false))
+        return;
+    thread_.join();
+}
+
+} // namespace vjc
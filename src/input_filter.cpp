@@ -0,0 +1,157 @@
+#include "vjc/input_filter.hpp"
+
+#include "vjc/stage_stats.hpp"
+
+#include "filter_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace vjc {
+
+namespace {
+
+constexpr std::size_t kLaneAlignment = 8; // widest kernel (AVX2) processes 8 lanes
+constexpr float kTwoPi = 2.0f * std::numbers::pi_v<float>;
+constexpr float kToUnit = 1.0f / 32767.0f;
+
+// Step bounds: the first run and a clock that did not move still make
+// progress, and 10 kHz is faster than any source.
+constexpr float kFirstStep = 1e-3f;
+constexpr float kMinStep = 1e-4f;
+
+// Kalman velocity variance on restart: the stick may already be moving at
+// up to ten full scales per second.
+constexpr float kInitialVelocityVariance = 100.0f;
+
+void check_positive(float value, const char* what)
+{
+    if (!(value > 0.0f && std::isfinite(value)))
+        throw std::invalid_argument(what);
+}
+
+} // namespace
+
+InputFilter::InputFilter(std::size_t devices, SimdLevel level)
+    : devices_(devices)
+    , stride_((devices + kLaneAlignment - 1) / kLaneAlignment * kLaneAlignment)
+    , level_(supported_simd_level(level))
+    , x_(kMaxAxes * stride_)
+    , mode_(kMaxAxes * stride_)
+    , restart_(kMaxAxes * stride_)
+    , params_(detail::kFilterParamCount * kMaxAxes * stride_)
+    , state_(detail::kFilterStateCount * kMaxAxes * stride_)
+{
+    if (devices == 0)
+        throw std::invalid_argument("InputFilter: no devices");
+    for (std::size_t lane = 0; lane < kMaxAxes * stride_; ++lane)
+        configure_lane(lane, AxisFilter{});
+}
+
+void InputFilter::configure(std::size_t device, std::size_t axis, const AxisFilter& filter)
+{
+    if (device >= devices_ || axis >= kMaxAxes)
+        throw std::out_of_range("InputFilter: no such device or axis");
+    check_positive(filter.min_cutoff, "AxisFilter: min_cutoff must be positive");
+    check_positive(filter.derivative_cutoff, "AxisFilter: derivative_cutoff must be positive");
+    check_positive(filter.measurement_noise, "AxisFilter: measurement_noise must be positive");
+    if (!(filter.beta >= 0.0f && std::isfinite(filter.beta)))
+        throw std::invalid_argument("AxisFilter: beta must be non-negative");
+    if (!(filter.process_noise >= 0.0f && std::isfinite(filter.process_noise)))
+        throw std::invalid_argument("AxisFilter: process_noise must be non-negative");
+    if (!(filter.lead_ms >= 0.0f && filter.lead_ms <= 100.0f))
+        throw std::invalid_argument("AxisFilter: lead_ms must be in [0, 100]");
+    configure_lane(index(device, axis), filter);
+}
+
+void InputFilter::configure_lane(std::size_t lane, const AxisFilter& filter) noexcept
+{
+    const std::size_t lanes = kMaxAxes * stride_;
+    float* p = params_.data();
+    switch (filter.kind) {
+    case FilterKind::None:
+        mode_[lane] = detail::kFilterPass;
+        break;
+    case FilterKind::Ema:
+    case FilterKind::OneEuro:
+        mode_[lane] = detail::kFilterSmooth;
+        break;
+    case FilterKind::Kalman:
+        mode_[lane] = detail::kFilterKalman;
+        break;
+    }
+    p[detail::kCutoff * lanes + lane] = kTwoPi * filter.min_cutoff;
+    p[detail::kBeta * lanes + lane] = filter.kind == FilterKind::OneEuro ? kTwoPi * filter.beta : 0.0f;
+    p[detail::kDerivative * lanes + lane] = kTwoPi * filter.derivative_cutoff;
+    p[detail::kProcessNoise * lanes + lane] = filter.process_noise;
+    p[detail::kMeasurementNoise * lanes + lane] = filter.measurement_noise;
+    p[detail::kLead * lanes + lane] = filter.lead_ms * 1e-3f;
+    restart_[lane] = 1;
+}
+
+void InputFilter::reset(std::size_t device) noexcept
+{
+    for (std::size_t a = 0; a < kMaxAxes; ++a)
+        restart_[index(device, a)] = 1;
+}
+
+void InputFilter::load(std::size_t device, const JoystickState& state) noexcept
+{
+    const std::size_t lanes = kMaxAxes * stride_;
+    float* s = state_.data();
+    for (std::size_t a = 0; a < kMaxAxes; ++a) {
+        const std::size_t i = index(device, a);
+        x_[i] = state.axes[a];
+        if (restart_[i]) {
+            restart_[i] = 0;
+            s[detail::kPosition * lanes + i] = static_cast<float>(state.axes[a]) * kToUnit;
+            s[detail::kVelocity * lanes + i] = 0.0f;
+            s[detail::kCov00 * lanes + i] = params_[detail::kMeasurementNoise * lanes + i];
+            s[detail::kCov01 * lanes + i] = 0.0f;
+            s[detail::kCov11 * lanes + i] = kInitialVelocityVariance;
+        }
+    }
+}
+
+void InputFilter::store(std::size_t device, JoystickState& state) const noexcept
+{
+    for (std::size_t a = 0; a < kMaxAxes; ++a)
+        state.axes[a] = x_[index(device, a)];
+}
+
+void InputFilter::run(std::uint64_t now_ns) noexcept
+{
+    const StageTimer timer(Stage::Filter);
+    float dt = last_ns_ == 0 ? kFirstStep : kMinStep;
+    if (last_ns_ != 0 && now_ns > last_ns_)
+        dt = std::max(static_cast<float>(static_cast<double>(now_ns - last_ns_) * 1e-9), kMinStep);
+    last_ns_ = now_ns;
+
+    const std::size_t lanes = kMaxAxes * stride_;
+    detail::FilterKernelArgs args{};
+    args.x = x_.data();
+    args.mode = mode_.data();
+    for (std::size_t k = 0; k < detail::kFilterParamCount; ++k)
+        args.param[k] = params_.data() + k * lanes;
+    for (std::size_t k = 0; k < detail::kFilterStateCount; ++k)
+        args.state[k] = state_.data() + k * lanes;
+    args.count = lanes;
+    args.dt = dt;
+    args.inv_dt = 1.0f / dt;
+    args.dt2_half = dt * dt * 0.5f;
+    args.dt3_third = dt * dt * dt * (1.0f / 3.0f);
+    detail::filter_kernel(level_)(args);
+}
+
+void InputFilter::process(JoystickState* states, std::size_t count, std::uint64_t now_ns) noexcept
+{
+    for (std::size_t d = 0; d < count; ++d)
+        load(d, states[d]);
+    run(now_ns);
+    for (std::size_t d = 0; d < count; ++d)
+        store(d, states[d]);
+}
+
+} // namespace vjc
@@ -0,0 +1,433 @@
+#include "vjc/io_loop.hpp"
+
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace vjc {
+
+IoTask::promise_type::~promise_type()
+{
+    if (!loop)
+        return;
+    (prev ? prev->next : loop->head_) = next;
+    if (next)
+        next->prev = prev;
+    --loop->tasks_;
+}
+
+IoLoop::~IoLoop() = default;
+
+void IoLoop::spawn(IoTask task) noexcept
+{
+    const std::coroutine_handle<IoTask::promise_type> handle = task.handle_;
+    task.handle_ = nullptr;
+    IoTask::promise_type& promise = handle.promise();
+    promise.loop = this;
+    promise.next = head_;
+    if (head_)
+        head_->prev = &promise;
+    head_ = &promise;
+    ++tasks_;
+    handle.resume();
+}
+
+void IoLoop::destroy_tasks() noexcept
+{
+    yielded_ = nullptr;
+    yielded_tail_ = &yielded_;
+    while (head_)
+        std::coroutine_handle<IoTask::promise_type>::from_promise(*head_).destroy();
+}
+
+void IoLoop::defer(IoOp& op) noexcept
+{
+    op.next = nullptr;
+    *yielded_tail_ = &op;
+    yielded_tail_ = &op.next;
+}
+
+std::size_t IoLoop::resume_yielded() noexcept
+{
+    // Detach first: a resumed task may yield again, for the next turn.
+    IoOp* op = yielded_;
+    yielded_ = nullptr;
+    yielded_tail_ = &yielded_;
+    std::size_t resumed = 0;
+    while (op) {
+        IoOp* next = op->next;
+        op->result = 0;
+        op->waiter.resume();
+        op = next;
+        ++resumed;
+    }
+    return resumed;
+}
+
+const char* to_string(IoBackend backend) noexcept
+{
+    switch (backend) {
+    case IoBackend::Auto:
+        return "auto";
+    case IoBackend::Uring:
+        return "io_uring";
+    case IoBackend::Epoll:
+        return "epoll";
+    }
+    return "?";
+}
+
+namespace {
+
+/// The plain syscall for `op`, without blocking: bytes, or -errno.
+long attempt(IoOp& op) noexcept
+{
+    for (;;) {
+        ssize_t n = -1;
+        switch (op.kind) {
+        case IoOp::Read:
+            n = ::read(op.fd, op.buffer, op.length);
+            break;
+        case IoOp::Write:
+            n = ::write(op.fd, op.buffer, op.length);
+            break;
+        case IoOp::RecvMsg:
+            n = ::recvmsg(op.fd, op.message, MSG_DONTWAIT);
+            break;
+        case IoOp::Yield: // handled by IoAwaitable, never started
+            return 0;
+        }
+        if (n >= 0)
+            return n;
+        if (errno != EINTR)
+            return -errno;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// io_uring
+
+int uring_setup(unsigned entries, io_uring_params& params) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+}
+
+int uring_enter(int fd, unsigned submit, unsigned wait, unsigned flags, const void* arg, std::size_t size) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, submit, wait, flags, arg, size));
+}
+
+class UringLoop final : public IoLoop {
+public:
+    explicit UringLoop(unsigned entries)
+    {
+        io_uring_params params{};
+        // Completions are only reaped by this thread from io_uring_enter(),
+        // so the kernel need not interrupt it to run task work.
+        params.flags = IORING_SETUP_COOP_TASKRUN;
+        fd_ = uring_setup(entries, params);
+        if (fd_ < 0 && errno == EINVAL) {
+            params = {};
+            fd_ = uring_setup(entries, params);
+        }
+        if (fd_ < 0)
+            throw std::system_error(errno, std::system_category(), "io_uring_setup");
+        if (!(params.features & IORING_FEAT_EXT_ARG)) {
+            ::close(fd_);
+            throw std::system_error(ENOSYS, std::system_category(), "io_uring without IORING_FEAT_EXT_ARG");
+        }
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(std::uint32_t);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single)
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        sq_ring_ = map(sq_size_, IORING_OFF_SQ_RING);
+        cq_ring_ = single ? sq_ring_ : map(cq_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqes_size_, IORING_OFF_SQES));
+
+        auto* sq = static_cast<std::byte*>(sq_ring_);
+        sq_head_ = reinterpret_cast<std::uint32_t*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<std::uint32_t*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<std::uint32_t*>(sq + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        auto* array = reinterpret_cast<std::uint32_t*>(sq + params.sq_off.array);
+        for (std::uint32_t i = 0; i < sq_entries_; ++i)
+            array[i] = i;
+        auto* cq = static_cast<std::byte*>(cq_ring_);
+        cq_head_ = reinterpret_cast<std::uint32_t*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<std::uint32_t*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<std::uint32_t*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        tail_ = *sq_tail_;
+    }
+
+    // Operations on non-blocking fds complete or fail with EAGAIN when
+    // submitted, and the polls that wait for readiness touch no buffer, so
+    // nothing is written into a task frame once the ring is closed.
+    ~UringLoop() override
+    {
+        release();
+        destroy_tasks();
+    }
+
+    [[nodiscard]] IoBackend backend() const noexcept override { return IoBackend::Uring; }
+
+    std::size_t run_once(int timeout_ms) noexcept override
+    {
+        const bool ready = std::atomic_ref(*cq_tail_).load(std::memory_order_acquire) != *cq_head_;
+        __kernel_timespec ts{timeout_ms / 1000, static_cast<long long>(timeout_ms % 1000) * 1'000'000};
+        io_uring_getevents_arg arg{};
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = timeout_ms < 0 ? 0 : reinterpret_cast<std::uint64_t>(&ts);
+        const unsigned wait = ready || yielded() || timeout_ms == 0 ? 0 : 1;
+        const int n = uring_enter(fd_, pending_, wait, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg,
+                                  sizeof arg);
+        if (n > 0)
+            pending_ -= std::min(pending_, static_cast<unsigned>(n));
+        const std::size_t resumed = reap();
+        return resumed + resume_yielded();
+    }
+
+protected:
+    bool start(IoOp& op) noexcept override
+    {
+        if (push(op))
+            return false;
+        op.result = -EBUSY;
+        return true;
+    }
+
+private:
+    void* map(std::size_t size, std::uint64_t offset)
+    {
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                         static_cast<off_t>(offset));
+        if (p == MAP_FAILED) {
+            const int err = errno;
+            release();
+            throw std::system_error(err, std::system_category(), "mmap io_uring");
+        }
+        return p;
+    }
+
+    void release() noexcept
+    {
+        ::close(fd_);
+        if (sqes_)
+            ::munmap(sqes_, sqes_size_);
+        if (cq_ring_ && cq_ring_ != sq_ring_)
+            ::munmap(cq_ring_, cq_size_);
+        if (sq_ring_)
+            ::munmap(sq_ring_, sq_size_);
+    }
+
+    /// Queues `op`, or a poll for its fd while `op.polling`; submission
+    /// waits for the next run_once(). False if the ring stays full.
+    bool push(IoOp& op) noexcept
+    {
+        if (tail_ - std::atomic_ref(*sq_head_).load(std::memory_order_acquire) == sq_entries_) {
+            const int n = uring_enter(fd_, pending_, 0, 0, nullptr, 0);
+            if (n > 0)
+                pending_ -= std::min(pending_, static_cast<unsigned>(n));
+            if (tail_ - std::atomic_ref(*sq_head_).load(std::memory_order_acquire) == sq_entries_)
+                return false;
+        }
+        io_uring_sqe& sqe = sqes_[tail_ & sq_mask_];
+        std::memset(&sqe, 0, sizeof sqe);
+        sqe.fd = op.fd;
+        sqe.user_data = reinterpret_cast<std::uint64_t>(&op);
+        if (op.polling) {
+            sqe.opcode = IORING_OP_POLL_ADD;
+            sqe.poll32_events = op.kind == IoOp::Write ? POLLOUT : POLLIN;
+        } else if (op.kind == IoOp::RecvMsg) {
+            sqe.opcode = IORING_OP_RECVMSG;
+            sqe.addr = reinterpret_cast<std::uint64_t>(op.message);
+            sqe.len = 1;
+        } else {
+            sqe.opcode = op.kind == IoOp::Read ? IORING_OP_READ : IORING_OP_WRITE;
+            sqe.addr = reinterpret_cast<std::uint64_t>(op.buffer);
+            sqe.len = static_cast<std::uint32_t>(op.length);
+            sqe.off = ~std::uint64_t{0}; // current position; streams have none
+        }
+        std::atomic_ref(*sq_tail_).store(++tail_, std::memory_order_release);
+        ++pending_;
+        return true;
+    }
+
+    std::size_t reap() noexcept
+    {
+        std::size_t resumed = 0;
+        std::uint32_t head = *cq_head_;
+        while (head != std::atomic_ref(*cq_tail_).load(std::memory_order_acquire)) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            IoOp& op = *reinterpret_cast<IoOp*>(cqe.user_data);
+            const int res = cqe.res;
+            // Release the slot before resuming: the task may queue more.
+            std::atomic_ref(*cq_head_).store(++head, std::memory_order_release);
+
+            if (op.polling ? res >= 0 : res == -EAGAIN) {
+                // Would have blocked: wait for readiness; ready: retry.
+                op.polling = !op.polling;
+                if (push(op))
+                    continue;
+                op.result = -EBUSY;
+            } else {
+                op.result = res;
+            }
+            op.polling = false;
+            ++resumed;
+            op.waiter.resume();
+        }
+        return resumed;
+    }
+
+    int fd_ = -1;
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sq_size_ = 0;
+    std::size_t cq_size_ = 0;
+    std::size_t sqes_size_ = 0;
+    std::uint32_t* sq_head_ = nullptr;
+    std::uint32_t* sq_tail_ = nullptr;
+    std::uint32_t sq_mask_ = 0;
+    std::uint32_t sq_entries_ = 0;
+    std::uint32_t* cq_head_ = nullptr;
+    std::uint32_t* cq_tail_ = nullptr;
+    std::uint32_t cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    std::uint32_t tail_ = 0;  // local copy of the SQ tail
+    unsigned pending_ = 0;    // queued, not yet submitted
+};
+
+// ---------------------------------------------------------------------------
+// epoll
+
+class EpollLoop final : public IoLoop {
+public:
+    EpollLoop()
+        : fd_(::epoll_create1(EPOLL_CLOEXEC))
+    {
+        if (fd_ < 0)
+            throw std::system_error(errno, std::system_category(), "epoll_create1");
+    }
+
+    // Parked operations have done nothing yet; dropping them is enough.
+    ~EpollLoop() override
+    {
+        ::close(fd_);
+        destroy_tasks();
+    }
+
+    [[nodiscard]] IoBackend backend() const noexcept override { return IoBackend::Epoll; }
+
+    std::size_t run_once(int timeout_ms) noexcept override
+    {
+        epoll_event events[64];
+        const int n = ::epoll_wait(fd_, events, 64, yielded() ? 0 : timeout_ms);
+        std::size_t resumed = 0;
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            const std::uint32_t mask = events[i].events;
+            if (mask & (EPOLLIN | EPOLLERR | EPOLLHUP))
+                resumed += retry(fd, &Parked::reader);
+            if (mask & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+                resumed += retry(fd, &Parked::writer);
+        }
+        return resumed + resume_yielded();
+    }
+
+protected:
+    bool start(IoOp& op) noexcept override
+    {
+        op.result = attempt(op);
+        return op.result != -EAGAIN || !park(op);
+    }
+
+private:
+    struct Parked {
+        IoOp* reader = nullptr;
+        IoOp* writer = nullptr;
+    };
+
+    /// Waits for `op`'s fd to become ready. False, with op.result set, if
+    /// it cannot.
+    bool park(IoOp& op) noexcept
+    {
+        if (static_cast<std::size_t>(op.fd) >= parked_.size()) {
+            try {
+                parked_.resize(static_cast<std::size_t>(op.fd) + 1);
+            } catch (...) {
+                op.result = -ENOMEM;
+                return false;
+            }
+        }
+        IoOp*& slot = op.kind == IoOp::Write ? parked_[op.fd].writer : parked_[op.fd].reader;
+        if (slot) {
+            op.result = -EBUSY; // one reader and one writer per fd
+            return false;
+        }
+        // Registering every time costs a syscall on the would-block path
+        // only, and stays right when an fd is closed and its number reused.
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        event.data.fd = op.fd;
+        if (::epoll_ctl(fd_, EPOLL_CTL_ADD, op.fd, &event) < 0 && errno != EEXIST) {
+            op.result = -errno;
+            return false;
+        }
+        slot = &op;
+        return true;
+    }
+
+    std::size_t retry(int fd, IoOp* Parked::*which) noexcept
+    {
+        if (static_cast<std::size_t>(fd) >= parked_.size())
+            return 0;
+        IoOp* op = std::exchange(parked_[fd].*which, nullptr);
+        if (!op)
+            return 0;
+        op->result = attempt(*op);
+        if (op->result == -EAGAIN) {
+            parked_[fd].*which = op;
+            return 0;
+        }
+        op->waiter.resume();
+        return 1;
+    }
+
+    int fd_;
+    std::vector<Parked> parked_; // by fd
+};
+
+} // namespace
+
+std::unique_ptr<IoLoop> IoLoop::create(IoBackend backend, unsigned entries)
+{
+    if (backend != IoBackend::Epoll) {
+        try {
+            return std::make_unique<UringLoop>(entries);
+        } catch (const std::system_error&) {
+            if (backend == IoBackend::Uring)
+                throw;
+        }
+    }
+    return std::make_unique<EpollLoop>();
+}
+
+} // namespace vjc
@@ -0,0 +1,418 @@
+#include "vjc/mapping.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace vjc {
+
+namespace {
+
+[[noreturn]] void fail(std::size_t line, const std::string& what)
+{
+    throw std::invalid_argument("mapping line " + std::to_string(line) + ": " + what);
+}
+
+std::vector<std::string_view> split(std::string_view text, char separator)
+{
+    std::vector<std::string_view> out;
+    std::size_t pos = 0;
+    while (pos <= text.size()) {
+        std::size_t end = text.find(separator, pos);
+        if (end == std::string_view::npos)
+            end = text.size();
+        out.push_back(text.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    return out;
+}
+
+std::vector<std::string_view> tokens(std::string_view line)
+{
+    std::vector<std::string_view> out;
+    std::size_t pos = 0;
+    while (pos < line.size()) {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r'))
+            ++pos;
+        std::size_t end = pos;
+        while (end < line.size() && line[end] != ' ' && line[end] != '\t' && line[end] != '\r')
+            ++end;
+        if (end > pos)
+            out.push_back(line.substr(pos, end - pos));
+        pos = end;
+    }
+    return out;
+}
+
+long number(std::string_view text, long min, long max, std::size_t line)
+{
+    long value = 0;
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size() || value < min || value > max)
+        fail(line, "bad number '" + std::string(text) + "'");
+    return value;
+}
+
+/// Parses `<prefix><index>` such as b12 or a3.
+bool indexed(std::string_view token, std::string_view prefix, long limit, std::size_t line, std::uint8_t& out)
+{
+    if (token.size() <= prefix.size() || token.substr(0, prefix.size()) != prefix)
+        return false;
+    out = static_cast<std::uint8_t>(number(token.substr(prefix.size()), 0, limit - 1, line));
+    return true;
+}
+
+std::uint64_t buttons(std::string_view token, std::size_t line)
+{
+    std::uint64_t mask = 0;
+    for (std::string_view part : split(token, '+')) {
+        std::uint8_t b = 0;
+        if (!indexed(part, "b", kMaxButtons, line, b))
+            fail(line, "expected a button, got '" + std::string(token) + "'");
+        mask |= std::uint64_t{1} << b;
+    }
+    return mask;
+}
+
+bool is_axis(std::string_view token) noexcept
+{
+    return token.size() > 1 && token[0] == 'a';
+}
+
+MappingRule parse_rule(const std::vector<std::string_view>& t, std::size_t line)
+{
+    MappingRule rule;
+    const auto arrow = [&](std::size_t i) {
+        if (i >= t.size() || t[i] != "->")
+            fail(line, "expected '->'");
+    };
+
+    if (t[0] == "toggle" || t[0] == "turbo") {
+        rule.kind = t[0] == "toggle" ? RuleKind::Toggle : RuleKind::Turbo;
+        if (t.size() < 4)
+            fail(line, "expected '" + std::string(t[0]) + " bN -> bM'");
+        rule.inputs = buttons(t[1], line);
+        if (std::popcount(rule.inputs) != 1)
+            fail(line, "toggle and turbo take a single source button");
+        arrow(2);
+        rule.outputs = buttons(t[3], line);
+        std::size_t next = 4;
+        if (rule.kind == RuleKind::Turbo && next < t.size()) {
+            if (t[next] != "every" || next + 1 >= t.size())
+                fail(line, "expected 'every N'");
+            rule.period = static_cast<std::uint16_t>(number(t[next + 1], 1, 65535, line));
+            next += 2;
+        }
+        if (next != t.size())
+            fail(line, "unexpected '" + std::string(t[next]) + "'");
+        return rule;
+    }
+
+    if (is_axis(t[0])) {
+        if (t.size() >= 4 && is_axis(t[1])) {
+            rule.kind = RuleKind::AxisToHat;
+            indexed(t[0], "a", kMaxAxes, line, rule.axis);
+            indexed(t[1], "a", kMaxAxes, line, rule.axis_y);
+            arrow(2);
+            if (!indexed(t[3], "hat", kMaxHats, line, rule.target))
+                fail(line, "expected a hat");
+            if (t.size() == 6 && t[4] == "deadzone")
+                rule.threshold = static_cast<std::int16_t>(number(t[5], 0, 32767, line));
+            else if (t.size() != 4)
+                fail(line, "expected 'deadzone N'");
+            return rule;
+        }
+        if (!indexed(t[0], "a", kMaxAxes, line, rule.axis))
+            fail(line, "expected an axis");
+        arrow(1);
+        if (t.size() < 3)
+            fail(line, "missing target");
+        if (indexed(t[2], "a", kMaxAxes, line, rule.target)) {
+            rule.kind = RuleKind::Axis;
+            if (t.size() == 4 && t[3] == "invert")
+                rule.invert = true;
+            else if (t.size() != 3)
+                fail(line, "expected 'invert'");
+            return rule;
+        }
+        rule.kind = RuleKind::AxisToButton;
+        rule.outputs = buttons(t[2], line);
+        if (t.size() != 6 || t[3] != "when" || (t[4] != ">" && t[4] != "<"))
+            fail(line, "expected 'when > N' or 'when < N'");
+        rule.below = t[4] == "<";
+        rule.threshold = static_cast<std::int16_t>(number(t[5], -32768, 32767, line));
+        return rule;
+    }
+
+    rule.inputs = buttons(t[0], line);
+    arrow(1);
+    if (t.size() < 3)
+        fail(line, "missing target");
+    if (t[2] == "macro") {
+        rule.kind = RuleKind::Macro;
+        for (std::size_t i = 3; i < t.size(); ++i) {
+            const std::size_t colon = t[i].find(':');
+            if (colon == std::string_view::npos)
+                fail(line, "macro steps are 'buttons:frames'");
+            MacroStep step;
+            if (t[i].substr(0, colon) != "-")
+                step.buttons = buttons(t[i].substr(0, colon), line);
+            step.frames = static_cast<std::uint16_t>(number(t[i].substr(colon + 1), 1, 65535, line));
+            rule.steps.push_back(step);
+        }
+        if (rule.steps.empty())
+            fail(line, "empty macro");
+        return rule;
+    }
+    rule.kind = std::popcount(rule.inputs) > 1 ? RuleKind::Chord : RuleKind::Button;
+    for (std::size_t i = 2; i < t.size(); ++i)
+        rule.outputs |= buttons(t[i], line);
+    return rule;
+}
+
+} // namespace
+
+MappingProfile MappingProfile::parse(std::string_view text)
+{
+    MappingProfile profile;
+    std::size_t line_number = 0;
+    for (std::string_view line : split(text, '\n')) {
+        ++line_number;
+        if (const std::size_t hash = line.find('#'); hash != std::string_view::npos)
+            line = line.substr(0, hash);
+        const std::vector<std::string_view> t = tokens(line);
+        if (t.empty())
+            continue;
+        profile.rules.push_back(parse_rule(t, line_number));
+    }
+    return profile;
+}
+
+void MappingState::reset(const CompiledMapping& mapping)
+{
+    previous = 0;
+    latched = 0;
+    turbo.fill(0);
+    chord_held.assign(mapping.chords_.size(), 0);
+    macros.assign(mapping.macros_.size(), Macro{});
+    running = 0;
+}
+
+CompiledMapping::CompiledMapping(const MappingProfile& profile)
+    : rules_(profile.rules.size())
+{
+    std::array<std::uint64_t, kMaxButtons> targets{};
+    std::uint64_t remapped = 0;
+    std::uint8_t axis_sources = 0;
+    std::uint8_t axis_targets = 0;
+    std::uint64_t toggled = 0;
+    std::array<std::vector<Chord>, kMaxButtons> buckets;
+    std::array<std::optional<AxisOp>, kMaxAxes + kMaxHats> slots;
+    std::array<std::vector<Threshold>, kMaxAxes> above;
+    std::array<std::vector<Threshold>, kMaxAxes> below;
+
+    for (const MappingRule& rule : profile.rules) {
+        const unsigned source = rule.inputs ? static_cast<unsigned>(std::countr_zero(rule.inputs)) : 0;
+        switch (rule.kind) {
+        case RuleKind::Button:
+            for (std::uint64_t m = rule.inputs; m; m &= m - 1)
+                targets[static_cast<unsigned>(std::countr_zero(m))] |= rule.outputs;
+            remapped |= rule.inputs;
+            break;
+        case RuleKind::Chord:
+            buckets[source].push_back({rule.inputs, rule.outputs, -1});
+            break;
+        case RuleKind::Macro:
+            buckets[source].push_back({rule.inputs, 0, static_cast<std::int32_t>(macros_.size())});
+            macros_.push_back({static_cast<std::uint32_t>(steps_.size()), static_cast<std::uint32_t>(rule.steps.size())});
+            steps_.insert(steps_.end(), rule.steps.begin(), rule.steps.end());
+            break;
+        case RuleKind::Toggle:
+            if (toggled & rule.outputs)
+                throw std::invalid_argument("mapping: two toggles drive the same button");
+            toggled |= rule.outputs;
+            toggle_sources_ |= rule.inputs;
+            toggle_outputs_[source] |= rule.outputs;
+            break;
+        case RuleKind::Turbo:
+            if ((turbo_sources_ & rule.inputs) && turbo_period_[source] != rule.period)
+                throw std::invalid_argument("mapping: conflicting turbo periods for one button");
+            turbo_sources_ |= rule.inputs;
+            turbo_outputs_[source] |= rule.outputs;
+            turbo_period_[source] = rule.period ? rule.period : 1;
+            break;
+        case RuleKind::Axis:
+            axis_sources |= static_cast<std::uint8_t>(1u << rule.axis);
+            axis_targets |= static_cast<std::uint8_t>(1u << rule.target);
+            slots[rule.target] = {rule.kind, rule.axis, 0, rule.target, rule.invert, 0};
+            break;
+        case RuleKind::AxisToHat:
+            axis_sources |= static_cast<std::uint8_t>(1u << rule.axis | 1u << rule.axis_y);
+            slots[kMaxAxes + rule.target] = {rule.kind, rule.axis, rule.axis_y, rule.target, false, rule.threshold};
+            break;
+        case RuleKind::AxisToButton:
+            axis_sources |= static_cast<std::uint8_t>(1u << rule.axis);
+            (rule.below ? below : above)[rule.axis].push_back({rule.threshold, rule.outputs});
+            break;
+        }
+    }
+    if ((toggle_sources_ & turbo_sources_) != 0)
+        throw std::invalid_argument("mapping: a button cannot be both a toggle and a turbo source");
+    consumed_ = toggle_sources_ | turbo_sources_;
+    cleared_axes_ = static_cast<std::uint8_t>(axis_sources & ~axis_targets);
+    for (const auto& slot : slots)
+        if (slot)
+            axis_ops_.push_back(*slot);
+
+    const auto add_thresholds = [this](std::vector<Threshold>& list, Range& range, bool ascending) {
+        std::stable_sort(list.begin(), list.end(), [ascending](const Threshold& a, const Threshold& b) {
+            return ascending ? a.value < b.value : a.value > b.value;
+        });
+        range.first = static_cast<std::uint32_t>(thresholds_.size());
+        range.count = static_cast<std::uint32_t>(list.size());
+        std::uint64_t buttons = 0;
+        for (const Threshold& t : list) {
+            buttons |= t.buttons;
+            thresholds_.push_back({t.value, buttons});
+        }
+    };
+    for (unsigned a = 0; a < kMaxAxes; ++a) {
+        add_thresholds(above[a], above_[a], true);
+        add_thresholds(below[a], below_[a], false);
+    }
+
+    for (unsigned b = 0; b < kMaxButtons; ++b)
+        if (!((remapped >> b) & 1))
+            targets[b] = std::uint64_t{1} << b;
+    for (unsigned k = 0; k < 8; ++k)
+        for (unsigned v = 0; v < 256; ++v) {
+            std::uint64_t mask = 0;
+            for (unsigned bit = 0; bit < 8; ++bit)
+                if ((v >> bit) & 1)
+                    mask |= targets[8 * k + bit];
+            buttons_[k][v] = mask;
+        }
+
+    for (unsigned b = 0; b < kMaxButtons; ++b) {
+        chord_start_[b] = static_cast<std::uint32_t>(chords_.size());
+        if (!buckets[b].empty())
+            chord_keys_ |= std::uint64_t{1} << b;
+        chords_.insert(chords_.end(), buckets[b].begin(), buckets[b].end());
+    }
+    chord_start_[kMaxButtons] = static_cast<std::uint32_t>(chords_.size());
+}
+
+void CompiledMapping::apply(const JoystickState& in, MappingState& state, JoystickState& out) const noexcept
+{
+    const std::uint64_t pressed = in.buttons;
+    const std::uint64_t previous = state.previous;
+    std::uint64_t held = 0;
+    std::uint64_t emitted = 0;
+
+    // Chords keyed on a button that is or was down: the latter so a release
+    // clears the held flag used for macro edge detection.
+    for (std::uint64_t keys = (pressed | previous) & chord_keys_; keys; keys &= keys - 1) {
+        const unsigned key = static_cast<unsigned>(std::countr_zero(keys));
+        for (std::uint32_t c = chord_start_[key]; c < chord_start_[key + 1]; ++c) {
+            const Chord& chord = chords_[c];
+            const bool down = (pressed & chord.mask) == chord.mask;
+            if (down) {
+                held |= chord.mask;
+                emitted |= chord.outputs;
+                if (chord.macro >= 0 && !state.chord_held[c]) {
+                    MappingState::Macro& macro = state.macros[static_cast<std::size_t>(chord.macro)];
+                    if (macro.step < 0)
+                        ++state.running;
+                    macro.step = 0;
+                    macro.left = steps_[macros_[static_cast<std::size_t>(chord.macro)].first].frames;
+                }
+            }
+            state.chord_held[c] = down;
+        }
+    }
+
+    for (std::uint64_t m = pressed & ~previous & toggle_sources_; m; m &= m - 1)
+        state.latched ^= toggle_outputs_[static_cast<unsigned>(std::countr_zero(m))];
+    emitted |= state.latched;
+    for (std::uint64_t m = pressed & turbo_sources_; m; m &= m - 1) {
+        const unsigned b = static_cast<unsigned>(std::countr_zero(m));
+        const std::uint32_t n = state.turbo[b]++;
+        if (((n / turbo_period_[b]) & 1) == 0)
+            emitted |= turbo_outputs_[b];
+    }
+    for (std::uint64_t m = previous & ~pressed & turbo_sources_; m; m &= m - 1)
+        state.turbo[static_cast<unsigned>(std::countr_zero(m))] = 0;
+
+    const std::uint64_t rest = pressed & ~(held | consumed_);
+    for (unsigned k = 0; k < 8; ++k)
+        emitted |= buttons_[k][(rest >> (8 * k)) & 0xff];
+
+    if (state.running != 0) {
+        for (std::size_t i = 0; i < state.macros.size(); ++i) {
+            MappingState::Macro& macro = state.macros[i];
+            if (macro.step < 0)
+                continue;
+            const MacroRange& range = macros_[i];
+            emitted |= steps_[range.first + static_cast<std::uint32_t>(macro.step)].buttons;
+            if (--macro.left == 0) {
+                if (static_cast<std::uint32_t>(++macro.step) == range.count) {
+                    macro.step = -1;
+                    --state.running;
+                } else {
+                    macro.left = steps_[range.first + static_cast<std::uint32_t>(macro.step)].frames;
+                }
+            }
+        }
+    }
+
+    out = in;
+    out.buttons = emitted;
+    for (unsigned m = cleared_axes_; m; m &= m - 1)
+        out.axes[static_cast<unsigned>(std::countr_zero(m))] = 0;
+    for (unsigned a = 0; a < kMaxAxes; ++a) {
+        const std::int16_t x = in.axes[a];
+        // Thresholds passed form a prefix: count those < x above, > x below.
+        if (const Range r = above_[a]; r.count != 0) {
+            const Threshold* first = thresholds_.data() + r.first;
+            const Threshold* last = std::lower_bound(first, first + r.count, x,
+                                                     [](const Threshold& t, std::int16_t v) { return t.value < v; });
+            if (last != first)
+                out.buttons |= last[-1].buttons;
+        }
+        if (const Range r = below_[a]; r.count != 0) {
+            const Threshold* first = thresholds_.data() + r.first;
+            const Threshold* last = std::lower_bound(first, first + r.count, x,
+                                                     [](const Threshold& t, std::int16_t v) { return t.value > v; });
+            if (last != first)
+                out.buttons |= last[-1].buttons;
+        }
+    }
+    for (const AxisOp& op : axis_ops_) {
+        const std::int32_t x = in.axes[op.axis];
+        if (op.kind == RuleKind::Axis) {
+            out.axes[op.target] = static_cast<std::int16_t>(op.invert ? (x == -32768 ? 32767 : -x) : x);
+            continue;
+        }
+        const std::int32_t y = in.axes[op.axis_y];
+        const std::int64_t ax = x < 0 ? -x : x;
+        const std::int64_t ay = y < 0 ? -y : y;
+        std::int8_t hx = 0;
+        std::int8_t hy = 0;
+        if (ax * ax + ay * ay > std::int64_t{op.deadzone} * op.deadzone) {
+            // 45-degree sectors: a component counts once it is above
+            // tan(22.5 deg) ~ 0.4142 of the other.
+            if (ax * 10000 > ay * 4142)
+                hx = x < 0 ? -1 : 1;
+            if (ay * 10000 > ax * 4142)
+                hy = y < 0 ? -1 : 1;
+        }
+        out.hats[2 * op.target] = hx;
+        out.hats[2 * op.target + 1] = hy;
+    }
+    state.previous = pressed;
+}
+
+} // namespace vjc
@@ -0,0 +1,138 @@
+// Per-ISA implementations of the motion-sensor calibration kernel.
+//
+// Integer arithmetic only, so every tier is exact and the outputs are
+// bit-identical:
+//
+//   d   = saturate16(raw - bias)                              (per axis)
+//   out = (m[r][0] d.x + m[r][1] d.y + m[r][2] d.z + 2^11) >> 12
+//
+// |d| <= 2^15 and |m| <= 2^14, so the sum stays below 2^31. The SIMD tiers
+// interleave (d.x, d.y) and (d.z, 1) pairs and take each row with two
+// pmaddwd: the second pair's constant carries the rounding term.
+
+#include "motion_kernels.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace vjc::detail {
+
+namespace {
+
+constexpr std::int32_t kRound = 1 << (kMotionMatrixShift - 1);
+
+} // namespace
+
+void calibrate_motion_scalar(const MotionKernelArgs& args) noexcept
+{
+    const std::int16_t* m = args.matrix;
+    for (std::size_t i = 0; i < args.count; ++i) {
+        std::int32_t d[3];
+        for (std::size_t a = 0; a < 3; ++a)
+            d[a] = std::clamp<std::int32_t>(args.raw[a][i] - args.bias[a], -32768, 32767);
+        for (std::size_t r = 0; r < 3; ++r)
+            args.out[r][i] = (m[3 * r] * d[0] + m[3 * r + 1] * d[1] + m[3 * r + 2] * d[2] + kRound)
+                >> kMotionMatrixShift;
+    }
+}
+
+#if defined(__x86_64__)
+
+namespace {
+
+/// Two int16 coefficients in every 32-bit lane, `lo` first.
+inline std::int32_t pair(std::int32_t lo, std::int32_t hi) noexcept
+{
+    return static_cast<std::int32_t>(static_cast<std::uint16_t>(lo) | static_cast<std::uint32_t>(hi) << 16);
+}
+
+} // namespace
+
+void calibrate_motion_sse2(const MotionKernelArgs& args) noexcept
+{
+    __m128i xy_coef[3], z_coef[3];
+    for (std::size_t r = 0; r < 3; ++r) {
+        xy_coef[r] = _mm_set1_epi32(pair(args.matrix[3 * r], args.matrix[3 * r + 1]));
+        z_coef[r] = _mm_set1_epi32(pair(args.matrix[3 * r + 2], kRound));
+    }
+    const __m128i bias_x = _mm_set1_epi16(args.bias[0]);
+    const __m128i bias_y = _mm_set1_epi16(args.bias[1]);
+    const __m128i bias_z = _mm_set1_epi16(args.bias[2]);
+    const __m128i one = _mm_set1_epi16(1);
+
+    for (std::size_t i = 0; i < args.count; i += 8) {
+        const __m128i x = _mm_subs_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(args.raw[0] + i)), bias_x);
+        const __m128i y = _mm_subs_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(args.raw[1] + i)), bias_y);
+        const __m128i z = _mm_subs_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(args.raw[2] + i)), bias_z);
+        const __m128i xy_lo = _mm_unpacklo_epi16(x, y);
+        const __m128i xy_hi = _mm_unpackhi_epi16(x, y);
+        const __m128i z_lo = _mm_unpacklo_epi16(z, one);
+        const __m128i z_hi = _mm_unpackhi_epi16(z, one);
+        for (std::size_t r = 0; r < 3; ++r) {
+            const __m128i lo = _mm_add_epi32(_mm_madd_epi16(xy_lo, xy_coef[r]), _mm_madd_epi16(z_lo, z_coef[r]));
+            const __m128i hi = _mm_add_epi32(_mm_madd_epi16(xy_hi, xy_coef[r]), _mm_madd_epi16(z_hi, z_coef[r]));
+            _mm_store_si128(reinterpret_cast<__m128i*>(args.out[r] + i), _mm_srai_epi32(lo, kMotionMatrixShift));
+            _mm_store_si128(reinterpret_cast<__m128i*>(args.out[r] + i + 4), _mm_srai_epi32(hi, kMotionMatrixShift));
+        }
+    }
+}
+
+__attribute__((target("avx2"))) void calibrate_motion_avx2(const MotionKernelArgs& args) noexcept
+{
+    __m256i xy_coef[3], z_coef[3];
+    for (std::size_t r = 0; r < 3; ++r) {
+        xy_coef[r] = _mm256_set1_epi32(pair(args.matrix[3 * r], args.matrix[3 * r + 1]));
+        z_coef[r] = _mm256_set1_epi32(pair(args.matrix[3 * r + 2], kRound));
+    }
+    const __m256i bias_x = _mm256_set1_epi16(args.bias[0]);
+    const __m256i bias_y = _mm256_set1_epi16(args.bias[1]);
+    const __m256i bias_z = _mm256_set1_epi16(args.bias[2]);
+    const __m256i one = _mm256_set1_epi16(1);
+
+    for (std::size_t i = 0; i < args.count; i += 16) {
+        const __m256i x
+            = _mm256_subs_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(args.raw[0] + i)), bias_x);
+        const __m256i y
+            = _mm256_subs_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(args.raw[1] + i)), bias_y);
+        const __m256i z
+            = _mm256_subs_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(args.raw[2] + i)), bias_z);
+        // Unpacks work per 128-bit half: lo holds samples 0-3 and 8-11, hi
+        // 4-7 and 12-15, put back in order by the permutes below.
+        const __m256i xy_lo = _mm256_unpacklo_epi16(x, y);
+        const __m256i xy_hi = _mm256_unpackhi_epi16(x, y);
+        const __m256i z_lo = _mm256_unpacklo_epi16(z, one);
+        const __m256i z_hi = _mm256_unpackhi_epi16(z, one);
+        for (std::size_t r = 0; r < 3; ++r) {
+            const __m256i lo = _mm256_srai_epi32(
+                _mm256_add_epi32(_mm256_madd_epi16(xy_lo, xy_coef[r]), _mm256_madd_epi16(z_lo, z_coef[r])),
+                kMotionMatrixShift);
+            const __m256i hi = _mm256_srai_epi32(
+                _mm256_add_epi32(_mm256_madd_epi16(xy_hi, xy_coef[r]), _mm256_madd_epi16(z_hi, z_coef[r])),
+                kMotionMatrixShift);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(args.out[r] + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(args.out[r] + i + 8),
+                               _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+    }
+}
+
+#endif
+
+MotionKernel motion_kernel(SimdLevel level) noexcept
+{
+    switch (supported_simd_level(level)) {
+#if defined(__x86_64__)
+    case SimdLevel::Avx2:
+        return &calibrate_motion_avx2;
+    case SimdLevel::Sse2:
+        return &calibrate_motion_sse2;
+#endif
+    default:
+        return &calibrate_motion_scalar;
+    }
+}
+
+} // namespace vjc::detail
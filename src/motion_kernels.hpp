@@ -0,0 +1,36 @@
+#pragma once
+
+// Internal interface between MotionCalibrator and its per-ISA kernels.
+
+#include "vjc/cpu_features.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vjc::detail {
+
+/// Fraction bits of a calibration matrix entry (Q12, entries in [-4, 4]).
+inline constexpr int kMotionMatrixShift = 12;
+inline constexpr std::int32_t kMotionMatrixOne = 1 << kMotionMatrixShift;
+
+/// `count` samples of one 3-axis sensor; every array holds `count` elements,
+/// `count` is a multiple of 16 and every pointer is 32-byte aligned.
+struct MotionKernelArgs {
+    const std::int16_t* raw[3];
+    std::int32_t* out[3];
+    std::int16_t bias[3];
+    std::int16_t matrix[9]; ///< row-major, Q12
+    std::size_t count;
+};
+
+using MotionKernel = void (*)(const MotionKernelArgs&) noexcept;
+
+void calibrate_motion_scalar(const MotionKernelArgs& args) noexcept;
+#if defined(__x86_64__)
+void calibrate_motion_sse2(const MotionKernelArgs& args) noexcept;
+void calibrate_motion_avx2(const MotionKernelArgs& args) noexcept;
+#endif
+
+MotionKernel motion_kernel(SimdLevel level) noexcept;
+
+} // namespace vjc::detail
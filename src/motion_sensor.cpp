@@ -0,0 +1,156 @@
+#include "vjc/motion_sensor.hpp"
+
+#include "vjc/stage_stats.hpp"
+
+#include "motion_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace vjc {
+
+namespace {
+
+constexpr std::size_t kLaneAlignment = 16; // widest kernel (AVX2) processes 16 samples
+
+void to_fixed(const SensorCalibration& calibration, std::int16_t* bias, std::int16_t* matrix)
+{
+    for (std::size_t i = 0; i < 9; ++i) {
+        const float m = calibration.matrix[i];
+        if (!(m >= -4.0f && m <= 4.0f))
+            throw std::invalid_argument("SensorCalibration: matrix entries must be in [-4, 4]");
+        matrix[i] = static_cast<std::int16_t>(std::lrint(m * detail::kMotionMatrixOne));
+    }
+    std::copy(calibration.bias.begin(), calibration.bias.end(), bias);
+}
+
+inline void put(input_event*& out, std::uint16_t type, std::uint16_t code, std::int32_t value) noexcept
+{
+    out->time = {};
+    out->type = type;
+    out->code = code;
+    out->value = value;
+    ++out;
+}
+
+} // namespace
+
+MotionCalibrator::MotionCalibrator(SimdLevel level)
+    : level_(supported_simd_level(level))
+    , raw_(6 * kBlock)
+    , out_(6 * kBlock)
+{
+    configure(MotionCalibration{});
+}
+
+void MotionCalibrator::configure(const MotionCalibration& calibration)
+{
+    std::int16_t bias[2][3];
+    std::int16_t matrix[2][9];
+    to_fixed(calibration.accel, bias[0], matrix[0]);
+    to_fixed(calibration.gyro, bias[1], matrix[1]);
+    std::copy_n(&bias[0][0], 6, &bias_[0][0]);
+    std::copy_n(&matrix[0][0], 18, &matrix_[0][0]);
+}
+
+void MotionCalibrator::apply(const MotionSample* in, std::size_t count, MotionReading* out) noexcept
+{
+    const detail::MotionKernel kernel = detail::motion_kernel(level_);
+    std::int16_t* raw = raw_.data();
+    std::int32_t* calibrated = out_.data();
+
+    while (count > 0) {
+        const std::size_t n = std::min(count, kBlock);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t a = 0; a < 3; ++a) {
+                raw[a * kBlock + i] = in[i].accel[a];
+                raw[(3 + a) * kBlock + i] = in[i].gyro[a];
+            }
+        }
+
+        for (std::size_t sensor = 0; sensor < 2; ++sensor) {
+            detail::MotionKernelArgs args{};
+            for (std::size_t a = 0; a < 3; ++a) {
+                args.raw[a] = raw + (3 * sensor + a) * kBlock;
+                args.out[a] = calibrated + (3 * sensor + a) * kBlock;
+                args.bias[a] = bias_[sensor][a];
+            }
+            std::copy_n(matrix_[sensor], 9, args.matrix);
+            args.count = (n + kLaneAlignment - 1) / kLaneAlignment * kLaneAlignment;
+            kernel(args);
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t a = 0; a < 3; ++a) {
+                out[i].accel[a] = calibrated[a * kBlock + i];
+                out[i].gyro[a] = calibrated[(3 + a) * kBlock + i];
+            }
+            out[i].timestamp_ns = in[i].timestamp_ns;
+        }
+        in += n;
+        out += n;
+        count -= n;
+    }
+}
+
+MotionSensor::MotionSensor(std::unique_ptr<DeviceBackend> backend, DeviceDescriptor descriptor, SimdLevel level)
+    : backend_(std::move(backend))
+    , descriptor_(std::move(descriptor))
+    , calibrator_(level)
+    , readings_(kMaxBatch)
+    , buffer_(kMaxBatch * kMotionReportEvents)
+{
+    if (!backend_)
+        throw std::invalid_argument("MotionSensor: null backend");
+    const auto& d = descriptor_;
+    if (d.axes.size() != codes_.size() || !d.triggers.empty() || d.hat_count != 0 || !d.buttons.empty())
+        throw std::invalid_argument("MotionSensor: descriptor must have exactly six axes");
+    if (std::find(d.misc.begin(), d.misc.end(), MSC_TIMESTAMP) == d.misc.end())
+        throw std::invalid_argument("MotionSensor: descriptor must declare MSC_TIMESTAMP");
+    for (std::size_t a = 0; a < codes_.size(); ++a)
+        codes_[a] = d.axes[a].code;
+    backend_->create(descriptor_);
+}
+
+std::unique_ptr<MotionSensor> MotionSensor::open_uinput(DeviceDescriptor descriptor, const std::string& path)
+{
+    return std::make_unique<MotionSensor>(std::make_unique<UinputBackend>(path), std::move(descriptor));
+}
+
+std::size_t MotionSensor::submit(std::span<const MotionSample> samples) noexcept
+{
+    const StageTimer timer(Stage::Write);
+    std::size_t written = 0;
+    while (!samples.empty()) {
+        const std::size_t n = std::min(samples.size(), kMaxBatch);
+        calibrator_.apply(samples.data(), n, readings_.data());
+
+        input_event* e = buffer_.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            const MotionReading& r = readings_[i];
+            for (std::size_t a = 0; a < 3; ++a)
+                put(e, EV_ABS, codes_[a], r.accel[a]);
+            for (std::size_t a = 0; a < 3; ++a)
+                put(e, EV_ABS, codes_[3 + a], r.gyro[a]);
+            // Microseconds, wrapping at 32 bits as drivers report it.
+            put(e, EV_MSC, MSC_TIMESTAMP, static_cast<std::int32_t>(static_cast<std::uint32_t>(r.timestamp_ns / 1000)));
+            put(e, EV_SYN, SYN_REPORT, 0);
+        }
+
+        const std::size_t count = n * kMotionReportEvents;
+        ++stats_.writes;
+        if (backend_->write_events(buffer_.data(), count)) {
+            stats_.samples += n;
+            stats_.events += count;
+            written += count;
+        } else {
+            ++stats_.failed_writes;
+        }
+        samples = samples.subspan(n);
+    }
+    return written;
+}
+
+} // namespace vjc
@@ -0,0 +1,94 @@
+#include "vjc/net_protocol.hpp"
+
+namespace vjc {
+
+namespace {
+
+inline std::uint16_t load_u16(const std::byte* in) noexcept
+{
+    return static_cast<std::uint16_t>(std::to_integer<unsigned>(in[0]) | std::to_integer<unsigned>(in[1]) << 8);
+}
+
+inline void store_u16(std::byte* out, std::uint16_t v) noexcept
+{
+    out[0] = static_cast<std::byte>(v);
+    out[1] = static_cast<std::byte>(v >> 8);
+}
+
+inline std::uint32_t load_u32(const std::byte* in) noexcept
+{
+    return std::to_integer<std::uint32_t>(in[0]) | std::to_integer<std::uint32_t>(in[1]) << 8
+        | std::to_integer<std::uint32_t>(in[2]) << 16 | std::to_integer<std::uint32_t>(in[3]) << 24;
+}
+
+inline void store_u32(std::byte* out, std::uint32_t v) noexcept
+{
+    for (int i = 0; i < 4; ++i)
+        out[i] = static_cast<std::byte>(v >> (8 * i));
+}
+
+} // namespace
+
+void encode_packet_header(const PacketHeader& header, std::byte* out) noexcept
+{
+    store_u32(out, kPacketMagic);
+    out[4] = static_cast<std::byte>(kProtocolVersion);
+    out[5] = static_cast<std::byte>(header.flags);
+    out[6] = static_cast<std::byte>(header.device);
+    out[7] = static_cast<std::byte>(header.device >> 8);
+    store_u32(out + 8, header.sequence);
+    store_u32(out + 12, header.session);
+}
+
+bool decode_packet_header(const std::byte* in, std::size_t size, PacketHeader& header) noexcept
+{
+    if (size < kPacketHeaderSize || load_u32(in) != kPacketMagic
+        || std::to_integer<std::uint8_t>(in[4]) != kProtocolVersion)
+        return false;
+    header.flags = std::to_integer<std::uint8_t>(in[5]);
+    header.device = static_cast<std::uint16_t>(std::to_integer<unsigned>(in[6]) | std::to_integer<unsigned>(in[7]) << 8);
+    header.sequence = load_u32(in + 8);
+    header.session = load_u32(in + 12);
+    return true;
+}
+
+void encode_ff_packet(const FfPacket& packet, std::byte* out) noexcept
+{
+    store_u32(out, kFfPacketMagic);
+    out[4] = static_cast<std::byte>(kProtocolVersion);
+    out[5] = static_cast<std::byte>(packet.command);
+    store_u16(out + 6, packet.device);
+    store_u16(out + 8, packet.effect);
+    store_u16(out + 10, packet.type);
+    store_u32(out + 12, packet.value);
+    store_u16(out + 16, packet.length_ms);
+    store_u16(out + 18, packet.delay_ms);
+    store_u16(out + 20, packet.waveform);
+    store_u16(out + 22, packet.period_ms);
+    store_u16(out + 24, packet.strong);
+    store_u16(out + 26, packet.weak);
+}
+
+bool decode_ff_packet(const std::byte* in, std::size_t size, FfPacket& packet) noexcept
+{
+    if (size != kFfPacketSize || load_u32(in) != kFfPacketMagic
+        || std::to_integer<std::uint8_t>(in[4]) != kProtocolVersion)
+        return false;
+    const auto command = std::to_integer<std::uint8_t>(in[5]);
+    if (command < kFfPlay || command > kFfGain)
+        return false;
+    packet.command = command;
+    packet.device = load_u16(in + 6);
+    packet.effect = load_u16(in + 8);
+    packet.type = load_u16(in + 10);
+    packet.value = load_u32(in + 12);
+    packet.length_ms = load_u16(in + 16);
+    packet.delay_ms = load_u16(in + 18);
+    packet.waveform = load_u16(in + 20);
+    packet.period_ms = load_u16(in + 22);
+    packet.strong = load_u16(in + 24);
+    packet.weak = load_u16(in + 26);
+    return true;
+}
+
+} // namespace vjc
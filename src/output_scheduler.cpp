@@ -0,0 +1,58 @@
+#include "vjc/output_scheduler.hpp"
+
+namespace vjc {
+
+std::uint64_t OutputScheduler::deadline() const noexcept
+{
+    if (!dirty_)
+        return kNoDeadline;
+    switch (config_.policy) {
+    case SchedulePolicy::Passthrough:
+        return 0;
+    case SchedulePolicy::FixedRate:
+        return started_ ? next_tick_ : 0;
+    case SchedulePolicy::Adaptive:
+        return started_ ? last_emit_ + config_.period_ns : 0;
+    }
+    return 0;
+}
+
+std::size_t OutputScheduler::poll(std::uint64_t now_ns, JoystickState* out) noexcept
+{
+    if (!dirty_ || now_ns < deadline())
+        return 0;
+
+    if (config_.policy == SchedulePolicy::FixedRate) {
+        // Next tick on the grid strictly after now; a long idle gap does not
+        // cause a burst of catch-up ticks.
+        const std::uint64_t period = config_.period_ns ? config_.period_ns : 1;
+        if (!started_)
+            next_tick_ = now_ns;
+        next_tick_ += ((now_ns - next_tick_) / period + 1) * period;
+    }
+    started_ = true;
+    last_emit_ = now_ns;
+
+    const std::uint64_t before = last_frame_.buttons;
+    const std::uint64_t after = pending_.buttons;
+    const std::uint64_t tapped = pressed_ & ~before & ~after;     // down and up again
+    const std::uint64_t blipped = released_ & before & after;     // up and down again
+
+    std::size_t n = 0;
+    if (tapped | blipped) {
+        out[n] = pending_;
+        out[n].buttons = (after | tapped) & ~blipped;
+        ++n;
+        ++edge_frames_;
+    }
+    out[n++] = pending_;
+
+    last_frame_ = pending_;
+    pressed_ = 0;
+    released_ = 0;
+    dirty_ = false;
+    ++emits_;
+    return n;
+}
+
+} // namespace vjc
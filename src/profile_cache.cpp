@@ -0,0 +1,405 @@
+#include "vjc/profile_cache.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace vjc {
+
+namespace {
+
+constexpr CurvePreset kPresets[] = {CurvePreset::Linear, CurvePreset::Gamma15, CurvePreset::Quadratic,
+                                    CurvePreset::Cubic, CurvePreset::Expo50};
+constexpr std::uint32_t kCustomCurve = ~std::uint32_t{0};
+
+/// 64-bit multiply-xorshift hash over whole words, then the tail bytes.
+/// Catches damage and edits, not adversaries.
+std::uint64_t hash_bytes(const void* data, std::size_t size) noexcept
+{
+    constexpr std::uint64_t kMul = 0x9e3779b97f4a7c15ull;
+    const auto* p = static_cast<const unsigned char*>(data);
+    std::uint64_t h = 0x243f6a8885a308d3ull ^ (size * kMul);
+    for (; size >= 8; p += 8, size -= 8) {
+        std::uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ w) * kMul;
+        h ^= h >> 29;
+    }
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, p, size);
+    h = (h ^ tail) * kMul;
+    return h ^ (h >> 32);
+}
+
+struct Header {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t reserved;
+    std::uint64_t layout;
+    std::uint64_t source_hash;
+    std::uint64_t source_size;
+    std::uint64_t payload_size;
+    std::uint64_t payload_hash;
+    std::uint64_t padding[2];
+};
+static_assert(sizeof(Header) == kProfileCacheHeaderSize);
+
+/// Appends values and arrays, each aligned for its type within the payload.
+class Writer {
+public:
+    template <typename T>
+    void put(const T& value)
+    {
+        array(&value, 1);
+    }
+
+    template <typename T>
+    void array(const T* values, std::size_t count, std::size_t align = alignof(T))
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        bytes_.resize((bytes_.size() + align - 1) / align * align);
+        const auto* p = reinterpret_cast<const std::byte*>(values);
+        bytes_.insert(bytes_.end(), p, p + count * sizeof(T));
+    }
+
+    template <typename T>
+    void vector(const std::vector<T>& values)
+    {
+        put(static_cast<std::uint64_t>(values.size()));
+        array(values.data(), values.size());
+    }
+
+    [[nodiscard]] std::vector<std::byte>& bytes() noexcept { return bytes_; }
+
+private:
+    std::vector<std::byte> bytes_;
+};
+
+/// Reads back what Writer wrote; every read is bounds-checked and a short
+/// payload makes ok() false instead of reading past the end.
+class Reader {
+public:
+    Reader(const std::byte* data, std::size_t size) noexcept
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    template <typename T>
+    [[nodiscard]] const T* array(std::size_t count, std::size_t align = alignof(T)) noexcept
+    {
+        const std::size_t at = (pos_ + align - 1) / align * align;
+        if (!ok_ || at > size_ || count > (size_ - at) / sizeof(T)) {
+            ok_ = false;
+            return nullptr;
+        }
+        pos_ = at + count * sizeof(T);
+        return reinterpret_cast<const T*>(data_ + at);
+    }
+
+    template <typename T>
+    void get(T& value) noexcept
+    {
+        if (const T* p = array<T>(1))
+            std::memcpy(&value, p, sizeof(T));
+    }
+
+    template <typename T, std::size_t N>
+    void get(std::array<T, N>& values) noexcept
+    {
+        if (const T* p = array<T>(N))
+            std::memcpy(values.data(), p, sizeof(T) * N);
+    }
+
+    template <typename T>
+    void vector(std::vector<T>& values)
+    {
+        std::uint64_t count = 0;
+        get(count);
+        if (const T* p = array<T>(count))
+            values.assign(p, p + count);
+    }
+
+    [[nodiscard]] bool ok() const noexcept { return ok_; }
+    [[nodiscard]] bool done() const noexcept { return ok_ && pos_ == size_; }
+
+private:
+    const std::byte* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+/// Read-only mapping of a cache file, shared by the curves that point into it.
+struct Mapping {
+    void* data = MAP_FAILED;
+    std::size_t size = 0;
+
+    ~Mapping()
+    {
+        if (data != MAP_FAILED)
+            ::munmap(data, size);
+    }
+};
+
+void write_all(int fd, const void* data, std::size_t size, const std::string& path)
+{
+    const auto* p = static_cast<const std::byte*>(data);
+    while (size > 0) {
+        const ssize_t n = ::write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::system_category(), "write " + path);
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+} // namespace
+
+std::uint64_t ProfileCache::layout() noexcept
+{
+    // Any change to the compiled tables or to what is stored for them must
+    // show up here, or an old cache would be read with the new layout.
+    std::uint64_t v = kProfileCacheVersion;
+    for (const std::uint64_t size :
+         {sizeof(CompiledMapping::Chord), sizeof(CompiledMapping::MacroRange), sizeof(MacroStep),
+          sizeof(CompiledMapping::AxisOp), sizeof(CompiledMapping::Threshold), sizeof(CompiledMapping::Range),
+          sizeof(AbsAxisInfo), std::uint64_t{kMaxAxes}, std::uint64_t{kMaxButtons}, sizeof(CurveTable)})
+        v = v * 1'000'003 + size;
+    return v;
+}
+
+ProfileCache::ProfileCache(std::string path)
+    : path_(std::move(path))
+{
+}
+
+std::unique_ptr<Profile> ProfileCache::load(std::string_view source, std::uint64_t version, std::size_t devices,
+                                            std::vector<DeviceDescriptor>* descriptors)
+{
+    status_ = Status::Missing;
+    const int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    struct stat st {};
+    auto mapping = std::make_shared<Mapping>();
+    if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(Header)) {
+        mapping->size = static_cast<std::size_t>(st.st_size);
+        mapping->data = ::mmap(nullptr, mapping->size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    }
+    ::close(fd);
+    status_ = Status::Corrupt;
+    if (mapping->data == MAP_FAILED)
+        return nullptr;
+
+    const auto* base = static_cast<const std::byte*>(mapping->data);
+    Header header;
+    std::memcpy(&header, base, sizeof header);
+    if (header.magic != kProfileCacheMagic)
+        return nullptr;
+    status_ = Status::Stale;
+    if (header.version != kProfileCacheVersion || header.layout != layout()
+        || header.source_size != source.size() || header.source_hash != hash_bytes(source.data(), source.size()))
+        return nullptr;
+    status_ = Status::Corrupt;
+    const std::byte* payload = base + sizeof(Header);
+    if (header.payload_size != mapping->size - sizeof(Header)
+        || header.payload_hash != hash_bytes(payload, header.payload_size))
+        return nullptr;
+
+    Reader in(payload, header.payload_size);
+    CompiledMapping m;
+    std::uint64_t rules = 0;
+    in.get(rules);
+    m.rules_ = rules;
+    for (auto& table : m.buttons_)
+        in.get(table);
+    in.get(m.consumed_);
+    in.get(m.chord_start_);
+    in.get(m.chord_keys_);
+    in.vector(m.chords_);
+    in.vector(m.macros_);
+    in.vector(m.steps_);
+    in.get(m.toggle_sources_);
+    in.get(m.toggle_outputs_);
+    in.get(m.turbo_sources_);
+    in.get(m.turbo_outputs_);
+    in.get(m.turbo_period_);
+    in.get(m.cleared_axes_);
+    in.vector(m.axis_ops_);
+    in.get(m.above_);
+    in.get(m.below_);
+    in.vector(m.thresholds_);
+
+    CurveSet curves;
+    std::uint32_t active = 0;
+    in.get(active);
+    for (std::size_t axis = 0; axis < kMaxAxes && in.ok(); ++axis) {
+        if (!((active >> axis) & 1u))
+            continue;
+        std::uint32_t kind = 0;
+        in.get(kind);
+        if (kind == kCustomCurve) {
+            const std::int16_t* table = in.array<std::int16_t>(std::tuple_size_v<CurveTable>, kCacheLineSize);
+            if (table)
+                curves.set(axis, ResponseCurve::from_table(std::shared_ptr<const CurveTable>(
+                                     mapping, reinterpret_cast<const CurveTable*>(table))));
+        } else if (kind < std::size(kPresets)) {
+            curves.set(axis, ResponseCurve::preset(kPresets[kind]));
+        } else {
+            return nullptr;
+        }
+    }
+
+    std::uint32_t count = 0;
+    in.get(count);
+    std::vector<DeviceDescriptor> stored(in.ok() ? count : 0);
+    for (DeviceDescriptor& d : stored) {
+        std::uint64_t length = 0;
+        in.get(length);
+        if (const char* name = in.array<char>(length))
+            d.name.assign(name, length);
+        in.get(d.bustype);
+        in.get(d.vendor);
+        in.get(d.product);
+        in.get(d.version);
+        in.vector(d.axes);
+        in.vector(d.triggers);
+        in.get(d.hat_count);
+        in.vector(d.buttons);
+        in.vector(d.ff_features);
+        in.get(d.ff_effects);
+        in.vector(d.properties);
+        in.vector(d.misc);
+    }
+    if (!in.done())
+        return nullptr;
+
+    status_ = Status::Hit;
+    if (descriptors)
+        *descriptors = std::move(stored);
+    return std::make_unique<Profile>(version, std::move(m), std::move(curves), devices);
+}
+
+void ProfileCache::store(std::string_view source, const Profile& profile,
+                         std::span<const DeviceDescriptor> descriptors) const
+{
+    const CompiledMapping& m = profile.mapping;
+    Writer out;
+    out.put(static_cast<std::uint64_t>(m.rules_));
+    for (const auto& table : m.buttons_)
+        out.put(table);
+    out.put(m.consumed_);
+    out.put(m.chord_start_);
+    out.put(m.chord_keys_);
+    out.vector(m.chords_);
+    out.vector(m.macros_);
+    out.vector(m.steps_);
+    out.put(m.toggle_sources_);
+    out.put(m.toggle_outputs_);
+    out.put(m.turbo_sources_);
+    out.put(m.turbo_outputs_);
+    out.put(m.turbo_period_);
+    out.put(m.cleared_axes_);
+    out.vector(m.axis_ops_);
+    out.put(m.above_);
+    out.put(m.below_);
+    out.vector(m.thresholds_);
+
+    std::uint32_t active = 0;
+    for (std::size_t axis = 0; axis < kMaxAxes; ++axis)
+        if (profile.curves.has_curve(axis))
+            active |= 1u << axis;
+    out.put(active);
+    for (std::size_t axis = 0; axis < kMaxAxes; ++axis) {
+        if (!profile.curves.has_curve(axis))
+            continue;
+        const std::int16_t* table = profile.curves.curve(axis).table();
+        std::uint32_t kind = kCustomCurve;
+        for (std::uint32_t i = 0; i < std::size(kPresets); ++i)
+            if (ResponseCurve::preset(kPresets[i]).table() == table)
+                kind = i;
+        out.put(kind);
+        if (kind == kCustomCurve)
+            out.array(table, std::tuple_size_v<CurveTable>, kCacheLineSize);
+    }
+
+    out.put(static_cast<std::uint32_t>(descriptors.size()));
+    for (const DeviceDescriptor& d : descriptors) {
+        out.put(static_cast<std::uint64_t>(d.name.size()));
+        out.array(d.name.data(), d.name.size());
+        out.put(d.bustype);
+        out.put(d.vendor);
+        out.put(d.product);
+        out.put(d.version);
+        out.vector(d.axes);
+        out.vector(d.triggers);
+        out.put(d.hat_count);
+        out.vector(d.buttons);
+        out.vector(d.ff_features);
+        out.put(d.ff_effects);
+        out.vector(d.properties);
+        out.vector(d.misc);
+    }
+
+    // Payload offsets above are relative to a cache-line-aligned start, so
+    // the header must keep the payload on a cache line too.
+    static_assert(sizeof(Header) % kCacheLineSize == 0);
+    const std::vector<std::byte>& payload = out.bytes();
+    Header header{};
+    header.magic = kProfileCacheMagic;
+    header.version = kProfileCacheVersion;
+    header.layout = layout();
+    header.source_hash = hash_bytes(source.data(), source.size());
+    header.source_size = source.size();
+    header.payload_size = payload.size();
+    header.payload_hash = hash_bytes(payload.data(), payload.size());
+
+    const std::string temp = path_ + ".tmp";
+    const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        throw std::system_error(errno, std::system_category(), "open " + temp);
+    try {
+        write_all(fd, &header, sizeof header, temp);
+        write_all(fd, payload.data(), payload.size(), temp);
+    } catch (...) {
+        ::close(fd);
+        ::unlink(temp.c_str());
+        throw;
+    }
+    ::close(fd);
+    if (::rename(temp.c_str(), path_.c_str()) < 0) {
+        const int err = errno;
+        ::unlink(temp.c_str());
+        throw std::system_error(err, std::system_category(), "rename " + path_);
+    }
+}
+
+const char* to_string(ProfileCache::Status status) noexcept
+{
+    switch (status) {
+    case ProfileCache::Status::Hit:
+        return "hit";
+    case ProfileCache::Status::Missing:
+        return "missing";
+    case ProfileCache::Status::Stale:
+        return "stale";
+    case ProfileCache::Status::Corrupt:
+        return "corrupt";
+    }
+    return "unknown";
+}
+
+} // namespace vjc
@@ -0,0 +1,233 @@
+#include "vjc/profile_store.hpp"
+
+#include "vjc/profile_cache.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace vjc {
+
+namespace {
+
+/// How often the loader retries freeing retired profiles a reader still held.
+constexpr auto kReclaimInterval = std::chrono::milliseconds(10);
+
+[[noreturn]] void fail(std::size_t line, const std::string& what)
+{
+    throw std::invalid_argument("profile line " + std::to_string(line) + ": " + what);
+}
+
+std::vector<std::string_view> words(std::string_view line)
+{
+    std::vector<std::string_view> out;
+    std::size_t pos = 0;
+    while (pos < line.size()) {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r'))
+            ++pos;
+        std::size_t end = pos;
+        while (end < line.size() && line[end] != ' ' && line[end] != '\t' && line[end] != '\r')
+            ++end;
+        if (end > pos)
+            out.push_back(line.substr(pos, end - pos));
+        pos = end;
+    }
+    return out;
+}
+
+ResponseCurve parse_curve(const std::vector<std::string_view>& w, std::size_t line)
+{
+    static constexpr std::pair<std::string_view, CurvePreset> kPresets[] = {
+        {"linear", CurvePreset::Linear}, {"gamma15", CurvePreset::Gamma15},
+        {"quadratic", CurvePreset::Quadratic}, {"cubic", CurvePreset::Cubic},
+        {"expo50", CurvePreset::Expo50},
+    };
+    if (w.size() == 3)
+        for (const auto& [name, preset] : kPresets)
+            if (w[2] == name)
+                return ResponseCurve::preset(preset);
+    if (w.size() == 4 && w[2] == "gamma") {
+        float exponent = 0.0f;
+        const auto [ptr, ec] = std::from_chars(w[3].data(), w[3].data() + w[3].size(), exponent);
+        if (ec != std::errc{} || ptr != w[3].data() + w[3].size() || !(exponent > 0.0f))
+            fail(line, "bad gamma '" + std::string(w[3]) + "'");
+        return ResponseCurve::gamma(exponent);
+    }
+    fail(line, "expected 'curve aN <preset>' or 'curve aN gamma X'");
+}
+
+} // namespace
+
+Profile::Profile(std::uint64_t version, const MappingProfile& rules, CurveSet curves, std::size_t devices)
+    : version(version)
+    , mapping(rules)
+    , curves(std::move(curves))
+    , states(devices, MappingState(mapping))
+{
+}
+
+Profile::Profile(std::uint64_t version, CompiledMapping mapping, CurveSet curves, std::size_t devices)
+    : version(version)
+    , mapping(std::move(mapping))
+    , curves(std::move(curves))
+    , states(devices, MappingState(this->mapping))
+{
+}
+
+Profile Profile::parse(std::string_view text, std::uint64_t version, std::size_t devices)
+{
+    // Curve lines are blanked rather than removed so mapping errors still
+    // report the line number of the original text.
+    std::string rules;
+    rules.reserve(text.size());
+    CurveSet curves;
+    std::size_t line_number = 0;
+    std::size_t pos = 0;
+    while (pos <= text.size()) {
+        std::size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos)
+            end = text.size();
+        const std::string_view line = text.substr(pos, end - pos);
+        ++line_number;
+        const std::vector<std::string_view> w = words(line.substr(0, line.find('#')));
+        if (!w.empty() && w[0] == "curve") {
+            if (w.size() < 3 || w[1].size() != 2 || w[1][0] != 'a' || w[1][1] < '0'
+                || w[1][1] >= static_cast<char>('0' + kMaxAxes))
+                fail(line_number, "expected 'curve aN ...'");
+            curves.set(static_cast<std::size_t>(w[1][1] - '0'), parse_curve(w, line_number));
+        } else {
+            rules.append(line);
+        }
+        rules.push_back('\n');
+        pos = end + 1;
+    }
+    return Profile(version, MappingProfile::parse(rules), std::move(curves), devices);
+}
+
+ProfileStore::ProfileStore(std::size_t devices, unsigned readers)
+    : devices_(devices)
+    , cell_(readers)
+{
+    loader_ = std::thread([this] { run_loader(); });
+}
+
+ProfileStore::~ProfileStore()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    loader_.join();
+}
+
+std::uint64_t ProfileStore::load(std::string_view text)
+{
+    std::lock_guard load_lock(load_mutex_);
+    const std::uint64_t next = version() + 1;
+    auto profile = std::make_unique<Profile>(Profile::parse(text, next, devices_));
+    cell_.publish(std::move(profile));
+    std::lock_guard lock(mutex_);
+    version_ = next;
+    return next;
+}
+
+std::uint64_t ProfileStore::load(std::string_view text, ProfileCache& cache)
+{
+    std::lock_guard load_lock(load_mutex_);
+    const std::uint64_t next = version() + 1;
+    std::unique_ptr<Profile> profile = cache.load(text, next, devices_);
+    if (!profile) {
+        profile = std::make_unique<Profile>(Profile::parse(text, next, devices_));
+        try {
+            cache.store(text, *profile);
+        } catch (const std::system_error&) {
+            // The cache only saves time; the profile itself is fine.
+        }
+    }
+    cell_.publish(std::move(profile));
+    std::lock_guard lock(mutex_);
+    version_ = next;
+    return next;
+}
+
+void ProfileStore::load_async(std::string text)
+{
+    {
+        std::lock_guard lock(mutex_);
+        queue_.push_back(std::move(text));
+    }
+    wake_.notify_one();
+}
+
+void ProfileStore::flush()
+{
+    std::unique_lock lock(mutex_);
+    idle_.wait(lock, [this] { return queue_.empty() && !busy_; });
+}
+
+std::uint64_t ProfileStore::version() const noexcept
+{
+    std::lock_guard lock(mutex_);
+    return version_;
+}
+
+std::uint64_t ProfileStore::failed_loads() const noexcept
+{
+    std::lock_guard lock(mutex_);
+    return failed_;
+}
+
+std::string ProfileStore::last_error() const
+{
+    std::lock_guard lock(mutex_);
+    return last_error_;
+}
+
+void ProfileStore::run_loader() noexcept
+{
+    bool pending = false; // retired profiles a reader still held at the last try
+    std::unique_lock lock(mutex_);
+    for (;;) {
+        if (pending)
+            wake_.wait_for(lock, kReclaimInterval, [this] { return stopping_ || !queue_.empty(); });
+        else
+            wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_)
+            return;
+        if (queue_.empty()) {
+            lock.unlock();
+            pending = cell_.reclaim() != 0;
+            lock.lock();
+            continue;
+        }
+        // Only the newest queued text matters: older ones would be replaced
+        // before any frame could use them.
+        std::string text = std::move(queue_.back());
+        queue_.clear();
+        busy_ = true;
+        lock.unlock();
+        std::string error;
+        try {
+            load(text);
+        } catch (const std::exception& e) {
+            error = e.what();
+        } catch (...) {
+            error = "unknown error";
+        }
+        pending = cell_.reclaim() != 0;
+        lock.lock();
+        if (!error.empty()) {
+            ++failed_;
+            last_error_ = std::move(error);
+        }
+        busy_ = false;
+        if (queue_.empty())
+            idle_.notify_all();
+    }
+}
+
+} // namespace vjc
@@ -0,0 +1,31 @@
+#include "vjc/realtime.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace vjc {
+
+bool pin_current_thread(int cpu) noexcept
+{
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof set, &set) == 0;
+}
+
+bool set_fifo_priority(int priority) noexcept
+{
+    sched_param param{};
+    param.sched_priority = priority;
+    return ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+bool lock_memory() noexcept
+{
+    return ::mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+}
+
+} // namespace vjc
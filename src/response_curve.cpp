@@ -0,0 +1,133 @@
+#include "vjc/response_curve.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace vjc {
+
+namespace {
+
+// Built-in presets, evaluated by the compiler and stored in .rodata.
+constexpr CurveTable kLinear = make_curve_table([](double x) { return x; });
+constexpr CurveTable kGamma15 = make_curve_table([](double x) { return x * detail::constexpr_sqrt(x); });
+constexpr CurveTable kQuadratic = make_curve_table([](double x) { return x * x; });
+constexpr CurveTable kCubic = make_curve_table([](double x) { return x * x * x; });
+constexpr CurveTable kExpo50 = make_curve_table([](double x) { return 0.5 * x + 0.5 * x * x * x; });
+
+double bezier_coordinate(double t, double p1, double p2) noexcept
+{
+    const double u = 1.0 - t;
+    return 3.0 * u * u * t * p1 + 3.0 * u * t * t * p2 + t * t * t;
+}
+
+/// Parameter t at which the Bezier's x coordinate equals `x`; x(t) is
+/// monotonic because both control x values lie in [0, 1].
+double bezier_solve(double x, double x1, double x2) noexcept
+{
+    double lo = 0.0;
+    double hi = 1.0;
+    double t = x;
+    for (int i = 0; i < 8; ++i) {
+        const double err = bezier_coordinate(t, x1, x2) - x;
+        const double u = 1.0 - t;
+        const double slope = 3.0 * u * u * x1 + 6.0 * u * t * (x2 - x1) + 3.0 * t * t * (1.0 - x2);
+        if (std::fabs(err) < 1e-12)
+            return t;
+        if (err > 0)
+            hi = t;
+        else
+            lo = t;
+        const double next = slope > 1e-9 ? t - err / slope : -1.0;
+        t = (next > lo && next < hi) ? next : 0.5 * (lo + hi);
+    }
+    for (int i = 0; i < 64 && hi - lo > 1e-12; ++i) {
+        t = 0.5 * (lo + hi);
+        (bezier_coordinate(t, x1, x2) < x ? lo : hi) = t;
+    }
+    return t;
+}
+
+} // namespace
+
+ResponseCurve::ResponseCurve() noexcept
+    : ResponseCurve(kLinear)
+{
+}
+
+ResponseCurve::ResponseCurve(const CurveTable& table) noexcept
+    : table_(table.data())
+{
+}
+
+ResponseCurve::ResponseCurve(std::shared_ptr<const CurveTable> owned) noexcept
+    : table_(owned->data())
+    , owned_(std::move(owned))
+{
+}
+
+ResponseCurve ResponseCurve::preset(CurvePreset preset) noexcept
+{
+    switch (preset) {
+    case CurvePreset::Linear:
+        return ResponseCurve(kLinear);
+    case CurvePreset::Gamma15:
+        return ResponseCurve(kGamma15);
+    case CurvePreset::Quadratic:
+        return ResponseCurve(kQuadratic);
+    case CurvePreset::Cubic:
+        return ResponseCurve(kCubic);
+    case CurvePreset::Expo50:
+        return ResponseCurve(kExpo50);
+    }
+    return ResponseCurve(kLinear);
+}
+
+ResponseCurve ResponseCurve::piecewise_linear(std::span<const CurvePoint> points)
+{
+    std::vector<CurvePoint> p;
+    p.reserve(points.size() + 2);
+    if (points.empty() || points.front().x > 0.0f)
+        p.push_back({0.0f, 0.0f});
+    p.insert(p.end(), points.begin(), points.end());
+    if (p.back().x < 1.0f)
+        p.push_back({1.0f, 1.0f});
+
+    for (std::size_t i = 0; i < p.size(); ++i) {
+        if (!(p[i].x >= 0.0f && p[i].x <= 1.0f && p[i].y >= 0.0f && p[i].y <= 1.0f))
+            throw std::invalid_argument("piecewise_linear: points must lie in [0, 1]");
+        if (i > 0 && !(p[i].x > p[i - 1].x))
+            throw std::invalid_argument("piecewise_linear: x must be strictly increasing");
+    }
+    if (p.front().y != 0.0f)
+        throw std::invalid_argument("piecewise_linear: a centred stick must map to 0");
+
+    return from_function([&p](double x) {
+        const auto it = std::upper_bound(p.begin() + 1, p.end() - 1, x,
+                                         [](double v, const CurvePoint& c) { return v < c.x; });
+        const CurvePoint& b = *it;
+        const CurvePoint& a = *(it - 1);
+        const double t = (x - a.x) / (static_cast<double>(b.x) - a.x);
+        return a.y + t * (static_cast<double>(b.y) - a.y);
+    });
+}
+
+ResponseCurve ResponseCurve::bezier(float x1, float y1, float x2, float y2)
+{
+    if (!(x1 >= 0.0f && x1 <= 1.0f && x2 >= 0.0f && x2 <= 1.0f))
+        throw std::invalid_argument("bezier: control x values must lie in [0, 1]");
+    return from_function([=](double x) {
+        const double y = bezier_coordinate(bezier_solve(x, x1, x2), y1, y2);
+        return std::clamp(y, 0.0, 1.0);
+    });
+}
+
+ResponseCurve ResponseCurve::gamma(float exponent)
+{
+    if (!(exponent > 0.0f))
+        throw std::invalid_argument("gamma: exponent must be positive");
+    return from_function([e = static_cast<double>(exponent)](double x) { return std::pow(x, e); });
+}
+
+} // namespace vjc
@@ -0,0 +1,211 @@
+#include "vjc/session_log.hpp"
+
+#include "vjc/platform.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace vjc {
+
+namespace {
+
+inline std::uint64_t load_le(const std::byte* in, int bytes) noexcept
+{
+    std::uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i)
+        v |= std::to_integer<std::uint64_t>(in[i]) << (8 * i);
+    return v;
+}
+
+inline void store_le(std::byte* out, std::uint64_t v, int bytes) noexcept
+{
+    for (int i = 0; i < bytes; ++i)
+        out[i] = static_cast<std::byte>(v >> (8 * i));
+}
+
+} // namespace
+
+SessionRecorder::SessionRecorder(const std::string& path, std::size_t devices)
+    : encoders_(devices)
+{
+    if (devices == 0 || devices > 0xffff)
+        throw std::invalid_argument("SessionRecorder: device count must be in 1..65535");
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0)
+        throw std::system_error(errno, std::system_category(), "open " + path);
+    if (::ftruncate(fd_, static_cast<off_t>(kGrowBytes)) < 0) {
+        const int err = errno;
+        ::close(fd_);
+        throw std::system_error(err, std::system_category(), "ftruncate");
+    }
+    void* map = ::mmap(nullptr, kGrowBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        const int err = errno;
+        ::close(fd_);
+        throw std::system_error(err, std::system_category(), "mmap");
+    }
+    map_ = static_cast<std::byte*>(map);
+    mapped_ = kGrowBytes;
+
+    store_le(map_, kSessionMagic, 4);
+    store_le(map_ + 4, kSessionVersion, 2);
+    store_le(map_ + 6, devices, 2);
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    close();
+}
+
+bool SessionRecorder::grow() noexcept
+{
+    const std::size_t size = mapped_ + kGrowBytes;
+    if (::ftruncate(fd_, static_cast<off_t>(size)) < 0)
+        return false;
+    void* map = ::mremap(map_, mapped_, size, MREMAP_MAYMOVE);
+    if (map == MAP_FAILED)
+        return false;
+    map_ = static_cast<std::byte*>(map);
+    mapped_ = size;
+    return true;
+}
+
+bool SessionRecorder::record(std::size_t device, const JoystickState& state, std::uint64_t time_ns) noexcept
+{
+    while (busy_.test_and_set(std::memory_order_acquire))
+        cpu_relax();
+    bool ok = false;
+    if (map_ && device < encoders_.size() && (used_ + kMaxSessionRecordSize <= mapped_ || grow())) {
+        if (!started_) {
+            start_ns_ = time_ns;
+            started_ = true;
+        }
+        // Writer threads read the clock before taking the lock, so a later
+        // record can carry an earlier time; keep the log monotonic.
+        const std::uint64_t offset = time_ns > start_ns_ ? time_ns - start_ns_ : 0;
+        last_offset_ = std::max(last_offset_, offset);
+        std::byte* out = map_ + used_;
+        const std::size_t size = encoders_[device].encode(state, out + kSessionRecordHeaderSize);
+        store_le(out + 1, device, 2);
+        store_le(out + 3, last_offset_, 8);
+        // Size goes last, as a release store so neither the compiler nor
+        // the CPU moves it ahead of the body: a reader of a crashed log never
+        // sees a record whose body is missing.
+        std::atomic_ref<std::byte>(out[0]).store(static_cast<std::byte>(size), std::memory_order_release);
+        used_ += kSessionRecordHeaderSize + size;
+        ++frames_;
+        ok = true;
+    } else {
+        ++dropped_;
+    }
+    busy_.clear(std::memory_order_release);
+    return ok;
+}
+
+void SessionRecorder::on_frame(unsigned, std::size_t device, const JoystickState& state, std::size_t) noexcept
+{
+    record(device, state);
+}
+
+void SessionRecorder::close() noexcept
+{
+    while (busy_.test_and_set(std::memory_order_acquire))
+        cpu_relax();
+    if (map_) {
+        store_le(map_ + 8, used_ - kSessionHeaderSize, 8);
+        ::munmap(map_, mapped_);
+        map_ = nullptr;
+        // Failing to trim only leaves zero padding behind, which readers skip.
+        (void)::ftruncate(fd_, static_cast<off_t>(used_));
+        ::close(fd_);
+        fd_ = -1;
+    }
+    busy_.clear(std::memory_order_release);
+}
+
+SessionReader::SessionReader(const std::string& path)
+{
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0)
+        throw std::system_error(errno, std::system_category(), "open " + path);
+    struct stat st {};
+    if (::fstat(fd_, &st) < 0) {
+        const int err = errno;
+        ::close(fd_);
+        throw std::system_error(err, std::system_category(), "fstat");
+    }
+    length_ = static_cast<std::size_t>(st.st_size);
+    if (length_ < kSessionHeaderSize) {
+        ::close(fd_);
+        throw std::runtime_error("SessionReader: " + path + " is not a session log");
+    }
+    void* map = ::mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        const int err = errno;
+        ::close(fd_);
+        throw std::system_error(err, std::system_category(), "mmap");
+    }
+    map_ = static_cast<const std::byte*>(map);
+    ::madvise(map, length_, MADV_SEQUENTIAL);
+
+    const std::uint64_t data_size = load_le(map_ + 8, 8);
+    if (load_le(map_, 4) != kSessionMagic || load_le(map_ + 4, 2) != kSessionVersion || load_le(map_ + 6, 2) == 0
+        || data_size > length_ - kSessionHeaderSize) {
+        ::munmap(map, length_);
+        ::close(fd_);
+        throw std::runtime_error("SessionReader: " + path + " is not a session log");
+    }
+    end_ = data_size != 0 ? kSessionHeaderSize + data_size : length_;
+    states_.resize(load_le(map_ + 6, 2));
+}
+
+SessionReader::~SessionReader()
+{
+    ::munmap(const_cast<std::byte*>(map_), length_);
+    ::close(fd_);
+}
+
+bool SessionReader::next(SessionFrame& frame) noexcept
+{
+    if (end_ - offset_ < kSessionRecordHeaderSize)
+        return false;
+    const std::byte* in = map_ + offset_;
+    const std::size_t size = std::to_integer<std::size_t>(in[0]);
+    const std::size_t device = load_le(in + 1, 2);
+    if (size == 0 || device >= states_.size() || end_ - offset_ - kSessionRecordHeaderSize < size)
+        return false;
+    if (decode_fields(in + kSessionRecordHeaderSize, size, states_[device]) != size)
+        return false;
+
+    frame.time_ns = load_le(in + 3, 8);
+    frame.device = static_cast<std::uint16_t>(device);
+    frame.state = states_[device];
+    offset_ += kSessionRecordHeaderSize + size;
+
+    if (offset_ - released_ >= kReleaseBytes) {
+        const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const std::size_t upto = offset_ / page * page;
+        ::madvise(const_cast<std::byte*>(map_) + released_, upto - released_, MADV_DONTNEED);
+        released_ = upto;
+    }
+    return true;
+}
+
+void SessionReader::rewind() noexcept
+{
+    offset_ = kSessionHeaderSize;
+    released_ = 0;
+    for (JoystickState& state : states_)
+        state = JoystickState{};
+}
+
+} // namespace vjc
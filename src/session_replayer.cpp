@@ -0,0 +1,67 @@
+#include "vjc/session_replayer.hpp"
+
+#include "vjc/clock.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace vjc {
+
+SessionReplayer::SessionReplayer(SessionReader& reader, std::vector<VirtualJoystick*> devices, ReplayConfig config)
+    : reader_(reader)
+    , devices_(std::move(devices))
+    , config_(config)
+{
+    if (!(config_.speed > 0.0))
+        throw std::invalid_argument("SessionReplayer: speed must be positive");
+}
+
+SessionReplayer::Stats SessionReplayer::run() noexcept
+{
+    Stats stats;
+    stop_.store(false, std::memory_order_relaxed);
+    SessionFrame frame;
+    bool started = false;
+    std::uint64_t base = 0;
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+    while (!stop_.load(std::memory_order_relaxed) && reader_.next(frame)) {
+        VirtualJoystick* device = frame.device < devices_.size() ? devices_[frame.device] : nullptr;
+        if (!device) {
+            ++stats.skipped;
+            continue;
+        }
+        if (!started) {
+            base = monotonic_ns();
+            first = frame.time_ns;
+            last = first;
+            started = true;
+        }
+        // Never schedule before the previous frame, even if the log has a
+        // time that went backwards.
+        last = std::max(last, frame.time_ns);
+        const double offset = static_cast<double>(last - first) / config_.speed;
+        const std::uint64_t deadline = base + static_cast<std::uint64_t>(offset);
+
+        std::uint64_t now = monotonic_ns();
+        if (deadline > now + config_.spin_ns) {
+            sleep_until_ns(deadline - config_.spin_ns);
+            now = monotonic_ns();
+        }
+        while (now < deadline)
+            now = monotonic_ns();
+
+        const std::uint64_t late = now - deadline;
+        stats.total_late_ns += late;
+        if (late > stats.max_late_ns)
+            stats.max_late_ns = late;
+
+        frame.state.timestamp_ns = deadline;
+        device->submit(frame.state);
+        ++stats.frames;
+    }
+    return stats;
+}
+
+} // namespace vjc
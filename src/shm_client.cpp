@@ -0,0 +1,92 @@
+#include "vjc/shm_client.hpp"
+
+#include "vjc/clock.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace vjc {
+
+ShmClient::ShmClient(const std::string& name)
+{
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0)
+        throw std::system_error(errno, std::system_category(), "shm_open " + name);
+    try {
+        map(fd);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+}
+
+ShmClient::ShmClient(int fd)
+{
+    map(fd);
+}
+
+ShmClient::~ShmClient()
+{
+    if (base_)
+        ::munmap(base_, layout_.size());
+}
+
+void ShmClient::map(int fd)
+{
+    struct stat st {};
+    if (::fstat(fd, &st) < 0)
+        throw std::system_error(errno, std::system_category(), "fstat");
+    if (static_cast<std::size_t>(st.st_size) < sizeof(ShmHeader))
+        throw std::runtime_error("ShmClient: segment too small");
+
+    ShmHeader header;
+    if (::pread(fd, &header, sizeof header, 0) != static_cast<ssize_t>(sizeof header))
+        throw std::system_error(errno, std::system_category(), "pread");
+    if (header.magic != kShmMagic || header.version != kShmVersion)
+        throw std::runtime_error("ShmClient: not a vjc channel or unsupported version");
+    const ShmLayout layout{header.devices};
+    if (header.size != layout.size() || static_cast<std::size_t>(st.st_size) < layout.size())
+        throw std::runtime_error("ShmClient: segment size does not match its header");
+
+    void* base = ::mmap(nullptr, layout.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+        throw std::system_error(errno, std::system_category(), "mmap");
+    base_ = base;
+    layout_ = layout;
+    auto* bytes = static_cast<std::byte*>(base);
+    doorbell_ = reinterpret_cast<Doorbell*>(bytes + ShmLayout::doorbell());
+    dirty_ = reinterpret_cast<std::atomic<std::uint64_t>*>(bytes + ShmLayout::dirty());
+    slots_ = reinterpret_cast<ShmSlot*>(bytes + layout.slots());
+}
+
+bool ShmClient::send(std::uint16_t device, const JoystickState& state) noexcept
+{
+    if (device >= layout_.devices)
+        return false;
+    JoystickState stamped = state;
+    stamped.timestamp_ns = monotonic_ns();
+    std::uint64_t words[kShmStateWords];
+    std::memcpy(words, &stamped, sizeof words);
+
+    ShmSlot& slot = slots_[device];
+    const std::uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < kShmStateWords; ++i)
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    dirty_[device / 64].fetch_or(std::uint64_t{1} << (device % 64), std::memory_order_release);
+    doorbell_->ring();
+    return true;
+}
+
+} // namespace vjc
@@ -0,0 +1,172 @@
+#include "vjc/shm_server.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/stage_stats.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+namespace vjc {
+
+namespace {
+
+/// Attempts at a consistent read before the slot is left for the next scan.
+constexpr unsigned kReadAttempts = 16;
+
+/// Wait before a device whose ring was full is tried again. Nothing rings
+/// the doorbell for it, and the writer frees ring space within this time.
+constexpr std::uint64_t kRetryNs = 100'000;
+
+} // namespace
+
+ShmServer::ShmServer(ControllerManager& manager, ShmServerConfig config)
+    : manager_(manager)
+    , config_(std::move(config))
+    , layout_{manager.device_count()}
+{
+    if (layout_.devices == 0 || layout_.devices > 0xffff)
+        throw std::invalid_argument("ShmServer: manager must have between 1 and 65535 devices");
+
+    if (config_.name.empty()) {
+        fd_ = ::memfd_create("vjc-shm", MFD_CLOEXEC);
+        if (fd_ < 0)
+            throw std::system_error(errno, std::system_category(), "memfd_create");
+    } else {
+        if (config_.replace)
+            ::shm_unlink(config_.name.c_str());
+        fd_ = ::shm_open(config_.name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd_ < 0)
+            throw std::system_error(errno, std::system_category(), "shm_open " + config_.name);
+    }
+
+    const auto fail = [this](const char* what) {
+        const int err = errno;
+        if (base_)
+            ::munmap(base_, layout_.size());
+        ::close(fd_);
+        if (!config_.name.empty())
+            ::shm_unlink(config_.name.c_str());
+        throw std::system_error(err, std::system_category(), what);
+    };
+    if (::ftruncate(fd_, static_cast<off_t>(layout_.size())) < 0)
+        fail("ftruncate");
+    base_ = ::mmap(nullptr, layout_.size(), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, 0);
+    if (base_ == MAP_FAILED) {
+        base_ = nullptr;
+        fail("mmap");
+    }
+
+    // The file starts zeroed, which is a valid state for every slot and the
+    // bitmap; only the header and the doorbell need constructing.
+    auto* bytes = static_cast<std::byte*>(base_);
+    doorbell_ = new (bytes + ShmLayout::doorbell()) Doorbell(true);
+    dirty_ = reinterpret_cast<std::atomic<std::uint64_t>*>(bytes + ShmLayout::dirty());
+    slots_ = reinterpret_cast<ShmSlot*>(bytes + layout_.slots());
+    ShmHeader header{};
+    header.magic = kShmMagic;
+    header.version = kShmVersion;
+    header.devices = static_cast<std::uint16_t>(layout_.devices);
+    header.size = layout_.size();
+    std::memcpy(bytes, &header, sizeof header);
+}
+
+ShmServer::~ShmServer()
+{
+    stop();
+    ::munmap(base_, layout_.size());
+    ::close(fd_);
+    if (!config_.name.empty())
+        ::shm_unlink(config_.name.c_str());
+}
+
+std::size_t ShmServer::poll(int timeout_ms) noexcept
+{
+    const std::uint32_t ticket = doorbell_->prepare();
+    if (const std::size_t n = drain(); n != 0)
+        return n;
+    const std::uint64_t timeout_ns = static_cast<std::uint64_t>(timeout_ms) * 1'000'000u;
+    doorbell_->wait(ticket, monotonic_ns() + (retry_ ? std::min(timeout_ns, kRetryNs) : timeout_ns));
+    return drain();
+}
+
+std::size_t ShmServer::drain() noexcept
+{
+    ++stats_.scans;
+    retry_ = false;
+    std::size_t published = 0;
+    for (std::size_t w = 0; w < layout_.dirty_words(); ++w) {
+        if (dirty_[w].load(std::memory_order_relaxed) == 0)
+            continue;
+        for (std::uint64_t bits = dirty_[w].exchange(0, std::memory_order_acquire); bits; bits &= bits - 1) {
+            const std::size_t device = w * 64 + static_cast<unsigned>(std::countr_zero(bits));
+            JoystickState* out = manager_.claim(device);
+            if (!out) {
+                ++stats_.ring_full;
+                dirty_[w].fetch_or(bits & -bits, std::memory_order_relaxed); // retry on the next scan
+                retry_ = true;
+                continue;
+            }
+            if (!read(device, *out)) {
+                // Overwritten while reading: the writer sets the bit again.
+                ++stats_.torn;
+                continue;
+            }
+#if VJC_STATS
+            record_stage(Stage::Receive, monotonic_ns() - out->timestamp_ns);
+#endif
+            manager_.commit(device);
+            ++stats_.updates;
+            ++published;
+        }
+    }
+    return published;
+}
+
+bool ShmServer::read(std::size_t device, JoystickState& out) noexcept
+{
+    ShmSlot& slot = slots_[device];
+    for (unsigned attempt = 0; attempt < kReadAttempts; ++attempt) {
+        const std::uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1)
+            continue;
+        std::uint64_t words[kShmStateWords];
+        for (std::size_t i = 0; i < kShmStateWords; ++i)
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before) {
+            std::memcpy(&out, words, sizeof words);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ShmServer::start()
+{
+    if (running_.exchange(true))
+        return;
+    thread_ = std::thread([this] {
+        while (running_.load(std::memory_order_relaxed))
+            poll(50);
+    });
+}
+
+void ShmServer::stop() noexcept
+{
+    if (!running_.exchange(false))
+        return;
+    doorbell_->ring();
+    thread_.join();
+}
+
+} // namespace vjc
@@ -0,0 +1,35 @@
+#pragma once
+
+// Internal helper shared by the socket transports.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace vjc::detail {
+
+/// Parses an IPv4 or IPv6 literal. Throws std::invalid_argument.
+inline sockaddr_storage parse_socket_address(const std::string& address, std::uint16_t port, socklen_t& length)
+{
+    sockaddr_storage storage{};
+    auto* v4 = reinterpret_cast<sockaddr_in*>(&storage);
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(&storage);
+    if (::inet_pton(AF_INET, address.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(port);
+        length = sizeof(sockaddr_in);
+    } else if (::inet_pton(AF_INET6, address.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(port);
+        length = sizeof(sockaddr_in6);
+    } else {
+        throw std::invalid_argument("invalid address " + address);
+    }
+    return storage;
+}
+
+} // namespace vjc::detail
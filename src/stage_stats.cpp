@@ -0,0 +1,144 @@
+#include "vjc/stage_stats.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vjc {
+
+namespace {
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<detail::ThreadStats>> threads;
+};
+
+Registry& registry()
+{
+    static Registry* r = new Registry; // never destroyed: threads may outlive statics
+    return *r;
+}
+
+detail::ThreadStats* register_thread()
+{
+    Registry& r = registry();
+    auto stats = std::make_unique<detail::ThreadStats>();
+    detail::ThreadStats* p = stats.get();
+    std::lock_guard lock(r.mutex);
+    r.threads.push_back(std::move(stats));
+    return p;
+}
+
+void append_stage(std::string& out, const char* format, const char* name, const HistogramSnapshot& h)
+{
+    char line[256];
+    const int n = std::snprintf(line, sizeof line, format, name, static_cast<unsigned long long>(h.count), h.mean(),
+                                static_cast<unsigned long long>(h.percentile(0.5)),
+                                static_cast<unsigned long long>(h.percentile(0.99)),
+                                static_cast<unsigned long long>(h.percentile(0.999)),
+                                static_cast<unsigned long long>(h.max_ns));
+    if (n > 0)
+        out.append(line, static_cast<std::size_t>(n) < sizeof line ? static_cast<std::size_t>(n) : sizeof line - 1);
+}
+
+} // namespace
+
+const char* to_string(Stage stage) noexcept
+{
+    switch (stage) {
+    case Stage::Receive:
+        return "receive";
+    case Stage::Decode:
+        return "decode";
+    case Stage::Filter:
+        return "filter";
+    case Stage::Shape:
+        return "shape";
+    case Stage::Coalesce:
+        return "coalesce";
+    case Stage::Write:
+        return "write";
+    }
+    return "unknown";
+}
+
+std::uint64_t HistogramSnapshot::percentile(double q) const noexcept
+{
+    if (count == 0)
+        return 0;
+    const double wanted = q * static_cast<double>(count);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen != 0 && static_cast<double>(seen) >= wanted) {
+            const std::uint64_t upper = HistogramLayout::upper(i);
+            return upper < max_ns ? upper : max_ns;
+        }
+    }
+    return max_ns;
+}
+
+std::string StatsSnapshot::text() const
+{
+    std::string out;
+    for (std::size_t s = 0; s < kStageCount; ++s)
+        append_stage(out, "%-8s count=%llu mean_ns=%.1f p50_ns=%llu p99_ns=%llu p999_ns=%llu max_ns=%llu\n",
+                     to_string(static_cast<Stage>(s)), stages[s]);
+    return out;
+}
+
+std::string StatsSnapshot::json() const
+{
+    std::string out = "{";
+    for (std::size_t s = 0; s < kStageCount; ++s) {
+        if (s != 0)
+            out += ',';
+        append_stage(out,
+                     "\"%s\":{\"count\":%llu,\"mean_ns\":%.1f,\"p50_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,"
+                     "\"max_ns\":%llu}",
+                     to_string(static_cast<Stage>(s)), stages[s]);
+    }
+    out += "}\n";
+    return out;
+}
+
+namespace detail {
+
+ThreadStats& thread_stats() noexcept
+{
+    // Registration allocates once per thread; losing that allocation is
+    // treated like any other out-of-memory condition.
+    thread_local ThreadStats* stats = register_thread();
+    return *stats;
+}
+
+} // namespace detail
+
+StatsSnapshot stage_snapshot()
+{
+    StatsSnapshot snapshot;
+#if VJC_STATS
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    for (const auto& thread : r.threads) {
+        for (std::size_t s = 0; s < kStageCount; ++s) {
+            const auto& h = thread->stages[s];
+            HistogramSnapshot& out = snapshot.stages[s];
+            out.sum_ns += h.sum.load(std::memory_order_relaxed);
+            const std::uint64_t max = h.max.load(std::memory_order_relaxed);
+            if (max > out.max_ns)
+                out.max_ns = max;
+            // The count comes from the buckets so percentiles always add up.
+            for (std::size_t i = 0; i < HistogramLayout::kBuckets; ++i) {
+                const std::uint64_t n = h.buckets[i].load(std::memory_order_relaxed);
+                out.buckets[i] += n;
+                out.count += n;
+            }
+        }
+    }
+#endif
+    return snapshot;
+}
+
+} // namespace vjc
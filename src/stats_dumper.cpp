@@ -0,0 +1,104 @@
+#include "vjc/stats_dumper.hpp"
+
+#include "vjc/stage_stats.hpp"
+
+#include <sys/eventfd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace vjc {
+
+namespace {
+
+std::atomic<int> g_event_fd{-1};
+
+void on_signal(int) noexcept
+{
+    const int saved = errno;
+    const std::uint64_t one = 1;
+    const int fd = g_event_fd.load(std::memory_order_relaxed);
+    if (fd >= 0)
+        (void)::write(fd, &one, sizeof one);
+    errno = saved;
+}
+
+void write_all(int fd, const std::string& text) noexcept
+{
+    std::size_t done = 0;
+    while (done < text.size()) {
+        const ssize_t n = ::write(fd, text.data() + done, text.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+} // namespace
+
+StatsDumper::StatsDumper(int fd, DumpFormat format, int signal)
+    : fd_(fd)
+    , format_(format)
+    , signal_(signal)
+{
+    event_fd_ = ::eventfd(0, EFD_CLOEXEC);
+    if (event_fd_ < 0)
+        throw std::system_error(errno, std::system_category(), "eventfd");
+    int expected = -1;
+    if (!g_event_fd.compare_exchange_strong(expected, event_fd_)) {
+        ::close(event_fd_);
+        throw std::logic_error("StatsDumper: another dumper is active");
+    }
+
+    struct sigaction action {};
+    action.sa_handler = on_signal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (::sigaction(signal_, &action, &previous_) < 0) {
+        const int err = errno;
+        g_event_fd.store(-1);
+        ::close(event_fd_);
+        throw std::system_error(err, std::system_category(), "sigaction");
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+StatsDumper::~StatsDumper()
+{
+    ::sigaction(signal_, &previous_, nullptr);
+    g_event_fd.store(-1);
+    running_.store(false, std::memory_order_relaxed);
+    trigger();
+    thread_.join();
+    ::close(event_fd_);
+}
+
+void StatsDumper::trigger() noexcept
+{
+    const std::uint64_t one = 1;
+    (void)::write(event_fd_, &one, sizeof one);
+}
+
+void StatsDumper::run() noexcept
+{
+    for (;;) {
+        std::uint64_t pending = 0;
+        if (::read(event_fd_, &pending, sizeof pending) < 0 && errno == EINTR)
+            continue;
+        if (!running_.load(std::memory_order_relaxed))
+            return;
+        try {
+            const StatsSnapshot snapshot = stage_snapshot();
+            write_all(fd_, format_ == DumpFormat::Json ? snapshot.json() : snapshot.text());
+        } catch (...) {
+            // Out of memory while formatting: skip this dump.
+        }
+    }
+}
+
+} // namespace vjc
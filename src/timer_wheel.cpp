@@ -0,0 +1,141 @@
+#include "vjc/timer_wheel.hpp"
+
+#include <stdexcept>
+
+namespace vjc {
+
+TimerWheel::TimerWheel(std::size_t capacity, std::uint64_t tick_ns, std::uint64_t now_ns)
+    : tick_ns_(tick_ns)
+    , next_tick_(tick_ns ? now_ns / tick_ns : 0)
+    , nodes_(capacity)
+{
+    if (capacity == 0 || tick_ns == 0)
+        throw std::invalid_argument("TimerWheel: capacity and tick must be positive");
+    if (capacity >= kNil)
+        throw std::invalid_argument("TimerWheel: capacity too large");
+    heads_.fill(kNil);
+    for (std::size_t i = capacity; i-- > 0;) {
+        nodes_[i].next = free_;
+        free_ = static_cast<std::uint32_t>(i);
+    }
+}
+
+TimerId TimerWheel::schedule(std::uint64_t deadline_ns, std::uint64_t cookie) noexcept
+{
+    if (free_ == kNil)
+        return kNoTimer;
+    const std::uint32_t index = free_;
+    Node& node = nodes_[index];
+    free_ = node.next;
+    node.deadline_ns = deadline_ns;
+    node.cookie = cookie;
+    ++size_;
+    file(index);
+    return make_id(index, node.generation);
+}
+
+bool TimerWheel::cancel(TimerId id) noexcept
+{
+    const auto index = static_cast<std::uint32_t>(id);
+    if (index >= nodes_.size())
+        return false;
+    Node& node = nodes_[index];
+    if (node.generation != static_cast<std::uint32_t>(id >> 32) || node.list == kFree)
+        return false;
+    unlink(index);
+    release(index);
+    return true;
+}
+
+std::uint64_t TimerWheel::next_deadline() const noexcept
+{
+    if (size_ == 0)
+        return kNoDeadline;
+    const std::uint64_t block = next_tick_ & ~std::uint64_t{kSlots - 1};
+    const std::uint64_t block_end = block + kSlots;
+    const unsigned slot = static_cast<unsigned>(next_tick_ & (kSlots - 1));
+    std::uint64_t tick = kNoDeadline;
+    if (const std::uint64_t ahead = occupied_[0] >> slot; ahead != 0)
+        tick = next_tick_ + static_cast<unsigned>(std::countr_zero(ahead));
+    else if (occupied_[0] != 0) // slots behind the cursor belong to the next block
+        tick = block_end + static_cast<unsigned>(std::countr_zero(occupied_[0]));
+    // Coarser levels are re-filed at block boundaries; wake for the next one.
+    if (tick > block_end && (occupied_[1] | occupied_[2] | occupied_[3]) != 0)
+        tick = block_end;
+    return tick == kNoDeadline ? kNoDeadline : tick * tick_ns_;
+}
+
+void TimerWheel::file(std::uint32_t index) noexcept
+{
+    const std::uint64_t deadline = tick_of(nodes_[index].deadline_ns);
+    if (deadline < next_tick_) {
+        link(index, static_cast<unsigned>(next_tick_ & (kSlots - 1)));
+        return;
+    }
+    // Deadlines beyond the last level wait at its far end and are re-filed
+    // with their real deadline when it comes round.
+    std::uint64_t delta = deadline - next_tick_;
+    std::uint64_t tick = deadline;
+    if (delta > kHorizon) {
+        delta = kHorizon;
+        tick = next_tick_ + kHorizon;
+    }
+    unsigned level = 0;
+    while (level + 1 < kLevels && delta >= (std::uint64_t{1} << ((level + 1) * kSlotBits)))
+        ++level;
+    link(index, level * kSlots + static_cast<unsigned>((tick >> (level * kSlotBits)) & (kSlots - 1)));
+}
+
+void TimerWheel::link(std::uint32_t index, unsigned list) noexcept
+{
+    Node& node = nodes_[index];
+    node.list = static_cast<std::uint16_t>(list);
+    node.prev = kNil;
+    node.next = heads_[list];
+    if (node.next != kNil)
+        nodes_[node.next].prev = index;
+    heads_[list] = index;
+    if (list < kFiring)
+        occupied_[list / kSlots] |= std::uint64_t{1} << (list % kSlots);
+}
+
+void TimerWheel::unlink(std::uint32_t index) noexcept
+{
+    Node& node = nodes_[index];
+    const unsigned list = node.list;
+    if (node.prev != kNil)
+        nodes_[node.prev].next = node.next;
+    else
+        heads_[list] = node.next;
+    if (node.next != kNil)
+        nodes_[node.next].prev = node.prev;
+    if (list < kFiring && heads_[list] == kNil)
+        occupied_[list / kSlots] &= ~(std::uint64_t{1} << (list % kSlots));
+    node.list = kFree;
+}
+
+void TimerWheel::release(std::uint32_t index) noexcept
+{
+    Node& node = nodes_[index];
+    ++node.generation;
+    if (node.generation == 0) // keep ids distinct from kNoTimer
+        node.generation = 1;
+    node.next = free_;
+    free_ = index;
+    --size_;
+}
+
+void TimerWheel::cascade(unsigned level) noexcept
+{
+    const unsigned list = level * kSlots + static_cast<unsigned>((next_tick_ >> (level * kSlotBits)) & (kSlots - 1));
+    std::uint32_t index = heads_[list];
+    heads_[list] = kNil;
+    occupied_[level] &= ~(std::uint64_t{1} << (list % kSlots));
+    while (index != kNil) {
+        const std::uint32_t next = nodes_[index].next;
+        file(index);
+        index = next;
+    }
+}
+
+} // namespace vjc
@@ -0,0 +1,80 @@
+#include "vjc/udp_client.hpp"
+
+#include "vjc/net_protocol.hpp"
+
+#include "socket_address.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <random>
+#include <system_error>
+
+namespace vjc {
+
+UdpClient::UdpClient(const std::string& address, std::uint16_t port, unsigned keyframe_interval)
+    : keyframe_interval_(keyframe_interval ? keyframe_interval : 1)
+    , session_(std::random_device{}())
+{
+    socklen_t length = 0;
+    sockaddr_storage storage = detail::parse_socket_address(address, port, length);
+    fd_ = ::socket(storage.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+        throw std::system_error(errno, std::system_category(), "socket");
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&storage), length) < 0) {
+        const int err = errno;
+        ::close(fd_);
+        throw std::system_error(err, std::system_category(), "connect");
+    }
+}
+
+UdpClient::~UdpClient()
+{
+    ::close(fd_);
+}
+
+bool UdpClient::send(std::uint16_t device, const JoystickState& state)
+{
+    if (device >= streams_.size())
+        streams_.resize(device + 1u);
+    Stream& stream = streams_[device];
+
+    PacketHeader header;
+    header.device = device;
+    header.sequence = ++stream.sequence;
+    header.session = session_;
+    if (stream.sequence % keyframe_interval_ == 1 || keyframe_interval_ == 1) {
+        header.flags = kPacketKeyframe;
+        stream.encoder.reset();
+    }
+
+    std::byte packet[kMaxPacketSize];
+    encode_packet_header(header, packet);
+    const std::size_t size = kPacketHeaderSize + stream.encoder.encode(state, packet + kPacketHeaderSize);
+    for (;;) {
+        const ssize_t n = ::send(fd_, packet, size, 0);
+        if (n == static_cast<ssize_t>(size))
+            return true;
+        if (n < 0 && errno == EINTR)
+            continue;
+        return false;
+    }
+}
+
+bool UdpClient::receive_ff(FfPacket& packet) noexcept
+{
+    std::byte datagram[kFfPacketSize + 1]; // one spare byte catches oversized ones
+    for (;;) {
+        const ssize_t n = ::recv(fd_, datagram, sizeof datagram, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        if (decode_ff_packet(datagram, static_cast<std::size_t>(n), packet))
+            return true;
+    }
+}
+
+} // namespace vjc
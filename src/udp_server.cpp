@@ -0,0 +1,271 @@
+#include "vjc/udp_server.hpp"
+
+#include "vjc/clock.hpp"
+#include "vjc/controller_manager.hpp"
+#include "vjc/net_protocol.hpp"
+#include "vjc/stage_stats.hpp"
+
+#include "socket_address.hpp"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace vjc {
+
+namespace {
+
+/// Per-datagram slot size; larger than kMaxPacketSize so oversized
+/// datagrams are detected (MSG_TRUNC) instead of silently cut.
+constexpr std::size_t kSlotSize = 128;
+
+} // namespace
+
+UdpServer::UdpServer(ControllerManager& manager, UdpServerConfig config)
+    : manager_(manager)
+    , config_(std::move(config))
+    , devices_(manager.device_count())
+{
+    if (config_.batch == 0)
+        throw std::invalid_argument("UdpServer: batch must be positive");
+
+    socklen_t length = 0;
+    sockaddr_storage addr = detail::parse_socket_address(config_.address, config_.port, length);
+    fd_ = ::socket(addr.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+        throw std::system_error(errno, std::system_category(), "socket");
+    ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &config_.receive_buffer, sizeof config_.receive_buffer);
+    if (::bind(fd_, reinterpret_cast<sockaddr*>(&addr), length) < 0) {
+        const int err = errno;
+        ::close(fd_);
+        throw std::system_error(err, std::system_category(), "bind");
+    }
+    sockaddr_storage bound{};
+    socklen_t bound_length = sizeof bound;
+    ::getsockname(fd_, reinterpret_cast<sockaddr*>(&bound), &bound_length);
+    port_ = ntohs(bound.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port
+                                              : reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+
+    const std::size_t batch = config_.batch;
+    arena_ = Arena(batch * (kSlotSize + sizeof(mmsghdr) + sizeof(iovec) + sizeof(sockaddr_storage))
+                   + 4 * alignof(std::max_align_t));
+    buffers_ = arena_.array<std::byte>(batch * kSlotSize);
+    messages_ = arena_.array<mmsghdr>(batch);
+    iovecs_ = arena_.array<iovec>(batch);
+    addresses_ = arena_.array<sockaddr_storage>(batch);
+    for (unsigned i = 0; i < config_.batch; ++i) {
+        iovecs_[i].iov_base = buffers_.data() + i * kSlotSize;
+        iovecs_[i].iov_len = kSlotSize;
+        messages_[i].msg_hdr.msg_iov = &iovecs_[i];
+        messages_[i].msg_hdr.msg_iovlen = 1;
+        messages_[i].msg_hdr.msg_name = &addresses_[i];
+    }
+}
+
+UdpServer::~UdpServer()
+{
+    stop();
+    ::close(fd_);
+}
+
+std::size_t UdpServer::poll(int timeout_ms) noexcept
+{
+    pollfd pfd{fd_, POLLIN, 0};
+    if (::poll(&pfd, 1, timeout_ms) <= 0)
+        return 0;
+    return drain();
+}
+
+std::size_t UdpServer::drain() noexcept
+{
+    std::size_t total = 0;
+    for (;;) {
+        for (unsigned i = 0; i < config_.batch; ++i)
+            messages_[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        const std::uint64_t before = monotonic_ns();
+        const int n = ::recvmmsg(fd_, messages_.data(), config_.batch, MSG_DONTWAIT, nullptr);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR)
+                continue;
+            return total;
+        }
+        ++stats_.batches;
+        const std::uint64_t now = monotonic_ns();
+        record_stage(Stage::Receive, now - before);
+        for (int i = 0; i < n; ++i) {
+            const msghdr& hdr = messages_[i].msg_hdr;
+            if (hdr.msg_flags & MSG_TRUNC) {
+                ++stats_.invalid;
+                continue;
+            }
+            handle(buffers_.data() + i * kSlotSize, messages_[i].msg_len, addresses_[i], now);
+        }
+        total += static_cast<std::size_t>(n);
+        stats_.packets += static_cast<std::uint64_t>(n);
+        if (static_cast<unsigned>(n) < config_.batch)
+            return total;
+    }
+}
+
+void UdpServer::serve(IoLoop& loop)
+{
+    loop.spawn(receive(loop));
+}
+
+IoTask UdpServer::receive(IoLoop& loop)
+{
+    msghdr& hdr = messages_[0].msg_hdr;
+    for (;;) {
+        hdr.msg_namelen = sizeof(sockaddr_storage);
+        const std::uint64_t before = monotonic_ns();
+        const long n = co_await loop.recvmsg(fd_, &hdr);
+        if (n < 0) {
+            if (io_result_fatal(n))
+                co_return;
+            // Transient, such as a full submission ring or ENOBUFS: drain()
+            // would retry on its next poll, so retry on the loop's next turn.
+            if (n != -EINTR)
+                ++stats_.receive_errors;
+            co_await loop.yield();
+            continue;
+        }
+        const std::uint64_t now = monotonic_ns();
+        // Submission to completion, which includes the loop's turn.
+        record_stage(Stage::Receive, now - before);
+        ++stats_.batches;
+        ++stats_.packets;
+        if (hdr.msg_flags & MSG_TRUNC) {
+            ++stats_.invalid;
+            continue;
+        }
+        handle(buffers_.data(), static_cast<std::size_t>(n), addresses_[0], now);
+    }
+}
+
+void UdpServer::handle(const std::byte* data, std::size_t size, const sockaddr_storage& from,
+                       std::uint64_t now) noexcept
+{
+    StageTimer decode_timer(Stage::Decode);
+    PacketHeader header;
+    if (!decode_packet_header(data, size, header)) {
+        ++stats_.invalid;
+        return;
+    }
+    if (header.device >= devices_.size()) {
+        ++stats_.unknown_device;
+        return;
+    }
+    DeviceState& device = devices_[header.device];
+    // A restarted client has a new session and counts from 1 again; a late
+    // packet of the session it replaced is stale, as is anything not newer
+    // within a session, keyframes included.
+    bool restart = false;
+    if (device.seen && header.session != device.session) {
+        if (header.session == device.previous_session) {
+            ++stats_.stale;
+            return;
+        }
+        restart = true;
+    } else if (device.seen && !sequence_newer(header.sequence, device.sequence)) {
+        ++stats_.stale;
+        return;
+    }
+
+    // decode_fields() validates before writing, so a bad frame leaves the
+    // device state untouched.
+    if (decode_fields(data + kPacketHeaderSize, size - kPacketHeaderSize, device.state) == 0) {
+        ++stats_.invalid;
+        return;
+    }
+    if (restart) {
+        device.previous_session = device.session;
+        ++stats_.restarts;
+    } else if (device.seen && header.sequence != device.sequence + 1) {
+        ++stats_.gaps;
+    }
+    device.sequence = header.sequence;
+    device.session = header.session;
+    if (!device.seen || std::memcmp(&device.peer, &from, sizeof(sockaddr_in6)) != 0) {
+        device.peer = from;
+        std::uint64_t words[kPeerWords];
+        std::memcpy(words, &from, sizeof words);
+        const std::uint32_t sequence = device.peer_sequence.load(std::memory_order_relaxed);
+        device.peer_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < kPeerWords; ++i)
+            device.peer_words[i].store(words[i], std::memory_order_relaxed);
+        device.peer_sequence.store(sequence + 2, std::memory_order_release);
+    }
+    device.seen = true;
+    device.state.sequence = header.sequence;
+    device.state.timestamp_ns = now;
+    decode_timer.stop();
+
+    if (!manager_.publish(header.device, device.state))
+        ++stats_.ring_full;
+}
+
+void UdpServer::start()
+{
+    if (running_.exchange(true))
+        return;
+    thread_ = std::thread([this] {
+        while (running_.load(std::memory_order_relaxed))
+            poll(50);
+    });
+}
+
+void UdpServer::stop() noexcept
+{
+    if (!running_.exchange(false))
+        return;
+    thread_.join();
+}
+
+bool UdpServer::send_ff(const FfPacket& packet) noexcept
+{
+    if (packet.device >= devices_.size())
+        return false;
+    const DeviceState& device = devices_[packet.device];
+    sockaddr_storage to{};
+    for (;;) {
+        const std::uint32_t before = device.peer_sequence.load(std::memory_order_acquire);
+        if (before == 0)
+            return false;
+        if (before & 1)
+            continue;
+        std::uint64_t words[kPeerWords];
+        for (std::size_t i = 0; i < kPeerWords; ++i)
+            words[i] = device.peer_words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (device.peer_sequence.load(std::memory_order_relaxed) == before) {
+            std::memcpy(&to, words, sizeof words);
+            break;
+        }
+    }
+    const socklen_t length = to.ss_family == AF_INET6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+    std::byte datagram[kFfPacketSize];
+    encode_ff_packet(packet, datagram);
+    for (;;) {
+        const ssize_t n = ::sendto(fd_, datagram, sizeof datagram, MSG_DONTWAIT, reinterpret_cast<const sockaddr*>(&to),
+                                   length);
+        if (n == static_cast<ssize_t>(sizeof datagram))
+            return true;
+        if (n < 0 && errno == EINTR)
+            continue;
+        return false;
+    }
+}
+
+sockaddr_storage UdpServer::peer(std::size_t device) const noexcept
+{
+    if (device >= devices_.size() || !devices_[device].seen)
+        return {};
+    return devices_[device].peer;
+}
+
+} // namespace vjc
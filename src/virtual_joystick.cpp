@@ -0,0 +1,79 @@
+#include "vjc/virtual_joystick.hpp"
+
+#include "vjc/stage_stats.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace vjc {
+
+namespace {
+
+/// Checked in the mem-initializer so that an incomplete encoding is refused
+/// before the backend creates the device.
+FrameEncoding complete(FrameEncoding encoding)
+{
+    if (!encoding.encode || !encoding.encode_full)
+        throw std::invalid_argument("VirtualJoystick: incomplete encoding");
+    return encoding;
+}
+
+} // namespace
+
+VirtualJoystick::VirtualJoystick(std::unique_ptr<DeviceBackend> backend, DeviceDescriptor descriptor)
+    : backend_(std::move(backend))
+    , descriptor_(std::move(descriptor))
+    , encoder_(descriptor_)
+{
+    if (!backend_)
+        throw std::invalid_argument("VirtualJoystick: null backend");
+    backend_->create(descriptor_);
+}
+
+VirtualJoystick::VirtualJoystick(std::unique_ptr<DeviceBackend> backend, DeviceDescriptor descriptor,
+                                 FrameEncoding encoding)
+    : backend_(std::move(backend))
+    , descriptor_(std::move(descriptor))
+    , encoder_(descriptor_)
+    , encoding_(complete(encoding))
+{
+    if (!backend_)
+        throw std::invalid_argument("VirtualJoystick: null backend");
+    backend_->create(descriptor_);
+}
+
+std::unique_ptr<VirtualJoystick> VirtualJoystick::open_uinput(DeviceDescriptor descriptor, const std::string& path)
+{
+    return std::make_unique<VirtualJoystick>(std::make_unique<UinputBackend>(path), std::move(descriptor));
+}
+
+std::size_t VirtualJoystick::submit(const JoystickState& state) noexcept
+{
+    const StageTimer timer(Stage::Write);
+    const std::size_t count = encoding_.encode ? encoding_.encode(current_, state, buffer_.data())
+                                               : encoder_.encode(current_, state, buffer_.data());
+    return flush(state, count);
+}
+
+std::size_t VirtualJoystick::resync() noexcept
+{
+    const std::size_t count = encoding_.encode_full ? encoding_.encode_full(current_, buffer_.data())
+                                                    : encoder_.encode_full(current_, buffer_.data());
+    return flush(current_, count);
+}
+
+std::size_t VirtualJoystick::flush(const JoystickState& state, std::size_t count) noexcept
+{
+    if (count == 0)
+        return 0;
+    if (!backend_->write_events(buffer_.data(), count)) {
+        ++stats_.failed_frames;
+        return 0;
+    }
+    current_ = state;
+    ++stats_.frames;
+    stats_.events += count;
+    return count;
+}
+
+} // namespace vjc
@@ -0,0 +1,109 @@
+#include "vjc/wire_format.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace vjc {
+
+namespace {
+
+inline void store_u16(std::byte*& out, std::uint16_t v) noexcept
+{
+    out[0] = static_cast<std::byte>(v);
+    out[1] = static_cast<std::byte>(v >> 8);
+    out += 2;
+}
+
+inline void store_u64(std::byte*& out, std::uint64_t v) noexcept
+{
+    for (int i = 0; i < 8; ++i)
+        out[i] = static_cast<std::byte>(v >> (8 * i));
+    out += 8;
+}
+
+inline std::uint16_t load_u16(const std::byte*& in) noexcept
+{
+    const auto v = static_cast<std::uint16_t>(std::to_integer<unsigned>(in[0]) | std::to_integer<unsigned>(in[1]) << 8);
+    in += 2;
+    return v;
+}
+
+inline std::uint64_t load_u64(const std::byte*& in) noexcept
+{
+    std::uint64_t v = 0;
+    for (int i = 0; i < 8; ++i)
+        v |= std::uint64_t{std::to_integer<std::uint8_t>(in[i])} << (8 * i);
+    in += 8;
+    return v;
+}
+
+/// Payload size of the fields selected by `mask`.
+inline std::size_t payload_size(std::uint16_t mask) noexcept
+{
+    constexpr std::uint16_t kScalarFields = kFieldHats - 1; // axes and triggers
+    return 2 * static_cast<std::size_t>(std::popcount(static_cast<unsigned>(mask & kScalarFields)))
+        + ((mask & kFieldHats) ? 2 * kMaxHats : 0)
+        + ((mask & kFieldButtons) ? 8 : 0);
+}
+
+} // namespace
+
+std::uint16_t diff_fields(const JoystickState& a, const JoystickState& b) noexcept
+{
+    unsigned mask = 0;
+    for (std::size_t i = 0; i < kMaxAxes; ++i)
+        mask |= static_cast<unsigned>(a.axes[i] != b.axes[i]) << i;
+    for (std::size_t i = 0; i < kMaxTriggers; ++i)
+        mask |= static_cast<unsigned>(a.triggers[i] != b.triggers[i]) << (kMaxAxes + i);
+    if (std::memcmp(a.hats.data(), b.hats.data(), sizeof a.hats) != 0)
+        mask |= kFieldHats;
+    if (a.buttons != b.buttons)
+        mask |= kFieldButtons;
+    return static_cast<std::uint16_t>(mask);
+}
+
+std::size_t encode_fields(const JoystickState& state, std::uint16_t mask, std::byte* out) noexcept
+{
+    std::byte* const begin = out;
+    mask &= kAllFields;
+    store_u16(out, mask);
+    for (std::size_t i = 0; i < kMaxAxes; ++i)
+        if (mask & (kFieldAxis0 << i))
+            store_u16(out, static_cast<std::uint16_t>(state.axes[i]));
+    for (std::size_t i = 0; i < kMaxTriggers; ++i)
+        if (mask & (kFieldTrigger0 << i))
+            store_u16(out, state.triggers[i]);
+    if (mask & kFieldHats) {
+        std::memcpy(out, state.hats.data(), sizeof state.hats);
+        out += sizeof state.hats;
+    }
+    if (mask & kFieldButtons)
+        store_u64(out, state.buttons);
+    return static_cast<std::size_t>(out - begin);
+}
+
+std::size_t decode_fields(const std::byte* in, std::size_t size, JoystickState& state) noexcept
+{
+    const std::byte* const begin = in;
+    if (size < 2)
+        return 0;
+    const std::uint16_t mask = load_u16(in);
+    if ((mask & ~kAllFields) != 0 || size < 2 + payload_size(mask))
+        return 0;
+
+    for (std::size_t i = 0; i < kMaxAxes; ++i)
+        if (mask & (kFieldAxis0 << i))
+            state.axes[i] = static_cast<std::int16_t>(load_u16(in));
+    for (std::size_t i = 0; i < kMaxTriggers; ++i)
+        if (mask & (kFieldTrigger0 << i))
+            state.triggers[i] = load_u16(in);
+    if (mask & kFieldHats) {
+        std::memcpy(state.hats.data(), in, sizeof state.hats);
+        in += sizeof state.hats;
+    }
+    if (mask & kFieldButtons)
+        state.buttons = load_u64(in);
+    return static_cast<std::size_t>(in - begin);
+}
+
+} // namespace vjc